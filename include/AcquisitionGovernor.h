@@ -0,0 +1,78 @@
+#ifndef ACQUISITIONGOVERNOR_H
+#define ACQUISITIONGOVERNOR_H
+
+#include <Arduino.h>
+
+// HX711 read cadence, from shot-ready to parked
+enum class AcquisitionMode : uint8_t {
+    FULL,    // Every conversion (20ms gate) - BREWING, TRANSITIONING or recent activity
+    REDUCED, // STABLE for a while - slower reads, heavier averaging
+    SPARSE   // Long idle - HX711s powered down between single readings
+};
+
+/*
+ * Decides how often Scale reads the HX711s. Every processed sample reports
+ * whether the scale is active (filter not STABLE, or a change above the
+ * brewing threshold); activity snaps straight back to FULL on that same
+ * conversion, and quiet time steps down to REDUCED and then SPARSE. The
+ * governor also keeps the accounting for /api/acquisition: time per mode,
+ * HX711 power-on time and the power-up to first-conversion latency, from
+ * which the energy per hour is estimated. The acquisition task drives it
+ * (calibration reads may also call wake()); toJson() may read slightly torn
+ * statistics, which is fine for a report.
+ */
+class AcquisitionGovernor {
+public:
+    AcquisitionGovernor();
+
+    void onSample(bool active, unsigned long nowMs);
+    void wake(unsigned long nowMs); // Tare, calibration reads - back to FULL now
+    void setPinned(bool pinned, unsigned long nowMs); // Performance profile: stay at FULL
+
+    AcquisitionMode getMode() const { return mode; }
+    uint32_t readIntervalMs() const;
+    int stableAverageSamples(int configured, int maxSamples) const; // Heavier averaging when idle
+    bool shouldPowerDown() const { return mode == AcquisitionMode::SPARSE; }
+
+    // HX711 power bookkeeping (Scale does the pin work)
+    void onPowerDown(unsigned long nowMs);
+    void onPowerUp(unsigned long nowMs);
+    void onFirstConversion(unsigned long nowMs); // After onPowerUp - records the wake-up latency
+    bool isPoweredDown() const { return poweredDown; }
+    bool isWaking() const { return waking; }
+
+    void setChipCount(uint8_t chips) { chipCount = chips; }
+    String toJson() const;
+
+    static const char* modeName(AcquisitionMode mode);
+
+    static const uint32_t FULL_INTERVAL_MS = 20;
+    static const uint32_t REDUCED_INTERVAL_MS = 100;
+    static const uint32_t SPARSE_INTERVAL_MS = 1000;
+    static const unsigned long REDUCE_AFTER_MS = 30000;  // STABLE this long -> REDUCED
+    static const unsigned long SPARSE_AFTER_MS = 300000; // STABLE this long -> SPARSE
+
+private:
+    void enterMode(AcquisitionMode next, unsigned long nowMs);
+    unsigned long elapsedIn(AcquisitionMode which, unsigned long nowMs) const;
+
+    AcquisitionMode mode;
+    unsigned long modeSinceMs;
+    unsigned long lastActivityMs;
+    unsigned long modeTotalMs[3];
+    uint32_t fullResumes;     // REDUCED/SPARSE -> FULL on activity
+    bool pinned;
+
+    bool poweredDown;
+    bool waking;
+    unsigned long powerChangeMs;
+    unsigned long poweredOffTotalMs;
+    uint32_t wakeCount;
+    uint32_t lastWakeLatencyMs;
+    uint32_t maxWakeLatencyMs;
+    uint64_t totalWakeLatencyMs;
+
+    uint8_t chipCount;
+};
+
+#endif
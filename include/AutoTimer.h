@@ -0,0 +1,65 @@
+#ifndef AUTOTIMER_H
+#define AUTOTIMER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "TelemetryFrame.h"
+
+class Display;  // Forward declaration
+class FlowRate; // Forward declaration
+
+/*
+ * Flow-triggered shot timer. While enabled and the timer is at zero, a short
+ * pre-trigger ring of recent samples is kept. Once flow is sustained the timer
+ * is started back-dated to the last quiet sample before the first drip, and
+ * the ring is handed back so history, shot log and analytics can replay the
+ * samples they would otherwise have missed. When flow decays the timer is
+ * stopped, back-dated to when the flow dropped off.
+ */
+class AutoTimer {
+public:
+    AutoTimer(Display* display, FlowRate* flowRate);
+    void begin(); // Load the setting from NVS
+
+    void setEnabled(bool enabled); // Persisted to NVS
+    bool isEnabled() const { return enabled; }
+
+    // Feed every filtered sample. Returns true when this sample started the
+    // timer; replayCount()/replaySample() then give the back-dated samples.
+    bool update(const TelemetrySample& sample);
+    size_t replayCount() const { return replayLength; }
+    const TelemetrySample& replaySample(size_t index) const;
+
+    static const size_t PRETRIGGER_SAMPLES = 128; // ~3-5s, covers the flow filter lag
+
+private:
+    Display* displayPtr;
+    FlowRate* flowRatePtr;
+    Preferences preferences;
+    bool enabled;
+
+    TelemetrySample ring[PRETRIGGER_SAMPLES];
+    size_t ringHead;   // Next write position
+    size_t ringCount;
+    size_t replayStart;
+    size_t replayLength;
+
+    uint8_t startCandidates;
+    bool sawFlow;      // Flow seen since the timer started
+    bool lowFlow;
+    uint32_t lowFlowSinceUs;
+    uint32_t lastSequence;
+
+    static constexpr float START_FLOW = 0.5f;   // g/s sustained to start
+    static const uint8_t START_CONFIRM_SAMPLES = 3;
+    static constexpr float START_WEIGHT = 1.0f; // Grams above the pre-trigger minimum
+    static constexpr float DRIP_WEIGHT = 0.2f;  // Grams above the minimum that count as a drip
+    static constexpr float STOP_FLOW = 0.2f;    // g/s below which flow has decayed
+    static const uint32_t STOP_HOLD_MS = 3000;
+
+    const TelemetrySample& ringAt(size_t age) const; // 0 = newest
+    bool checkStart(const TelemetrySample& sample);
+    void checkStop(const TelemetrySample& sample);
+};
+
+#endif
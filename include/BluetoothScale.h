@@ -4,8 +4,14 @@
 #include <NimBLEServer.h>
 #include <NimBLEUtils.h>
 #include "Scale.h"
+#include "TelemetryFrame.h"
+#include "ShotAnalytics.h"
+#include "SampleBus.h"
+#include "EventBus.h"
+#include "PerformanceProfile.h"
 
 class Display; // Forward declaration
+class FlowRate; // Forward declaration
 
 enum class WeighMyBruMessageType : uint8_t {
   SYSTEM = 0x0A,
@@ -16,7 +22,8 @@ enum class BeanConquerorCommand : uint8_t {
   TARE = 0x01,
   TIMER_START = 0x02,
   TIMER_STOP = 0x03,
-  TIMER_RESET = 0x04
+  TIMER_RESET = 0x04,
+  PROFILE = 0x05      // data[3] = ProfileId (0 brew, 1 dose, 2 idle, 3 low battery)
 };
 
 class BluetoothScale : public NimBLEServerCallbacks, public NimBLECharacteristicCallbacks {
@@ -27,13 +34,16 @@ public:
     void begin(Scale* scale);
     void begin();  // Initialize without scale reference
     void setScale(Scale* scale);  // Set scale reference later
-    void setDisplay(Display* display); // Set display reference for timer control
+    void setDisplay(Display* display); // Set display reference for the timer flag in telemetry
+    void setFlowRate(FlowRate* flowRate); // Set flow rate reference for telemetry frames
+    void setShotAnalytics(ShotAnalytics* analytics); // Set analytics reference for shot events
+    void setSampleBus(SampleBus* bus); // Stream the newest bus sample instead of polling the scale
     void end();
     void update();
     bool isConnected();
-    void sendWeight(float weight);
     void handleTareCommand();
     void handleTimerCommand(BeanConquerorCommand command);
+    void applyProfile(const PerformanceProfile& profile); // Comms task - notification rate, TX power, connection interval
     int getBluetoothSignalStrength(); // Get BLE signal strength (RSSI)
     String getBluetoothConnectionInfo(); // Get detailed BLE connection information
     
@@ -43,15 +53,24 @@ public:
     
     // BLE Characteristic callbacks
     void onWrite(NimBLECharacteristic* pCharacteristic) override;
+    void onStatus(NimBLECharacteristic* pCharacteristic, Status status, int code) override;
 
 private:
     Scale* scale;
     Display* display; // Reference to display for timer control
+    FlowRate* flowRate; // Reference to flow rate for telemetry frames
+    ShotAnalytics* analytics; // Source of shot events
+    uint32_t shotEventCursor; // Last shot event sent
+    SampleBus* sampleBus; // Source of weight samples (nullptr = capture from the scale)
+    SampleCursor weightCursor; // Newest sample, at most every WEIGHT_SEND_INTERVAL
+    EventBus::SubscriberId controlSubscription; // TARED notifications
     NimBLEServer* server;
     NimBLEService* service;
     NimBLECharacteristic* weightCharacteristic;          // Bean Conqueror (simple float)
     NimBLECharacteristic* gaggiMateWeightCharacteristic; // GaggiMate (WeighMyBru protocol)
     NimBLECharacteristic* commandCharacteristic;
+    NimBLECharacteristic* telemetryCharacteristic;       // Binary telemetry frame (TelemetryFrame.h)
+    NimBLECharacteristic* shotEventCharacteristic;       // Shot analytics events
     NimBLEAdvertising* advertising;
     
     bool deviceConnected;
@@ -62,10 +81,15 @@ private:
     int8_t connectionRSSI; // Store RSSI value for connected device
     uint16_t connectionHandle; // Store connection handle for RSSI queries
     
+    // Set by the performance profile
+    uint32_t weightSendInterval;
+    uint32_t heartbeatInterval;
+    const PerformanceProfile* connProfile; // Connection parameters to request on (re)connect
+    
     // WeighMyBru protocol constants
     static const uint8_t PRODUCT_NUMBER = 0x03;
     static const size_t PROTOCOL_LENGTH = 20;
-    static const uint32_t HEARTBEAT_INTERVAL = 2000; // 2 seconds
+    static const uint32_t HEARTBEAT_INTERVAL = 2000; // 2 seconds - default until a profile is applied
     static const uint32_t WEIGHT_SEND_INTERVAL = 50; // 50ms (20 updates/sec) - faster for GaggiMate
     
     // WeighMyBru UUIDs - unique to avoid conflicts with Bookoo scales
@@ -73,6 +97,8 @@ private:
     static const char* WEIGHT_CHARACTERISTIC_UUID;        // Bean Conqueror (simple float)
     static const char* GAGGIMATE_CHARACTERISTIC_UUID;     // GaggiMate (WeighMyBru protocol)
     static const char* COMMAND_CHARACTERISTIC_UUID;
+    static const char* TELEMETRY_CHARACTERISTIC_UUID;     // Versioned binary telemetry frame
+    static const char* SHOT_EVENT_CHARACTERISTIC_UUID;    // Shot analytics events
     
     void initializeBLE();
     void startAdvertising();
@@ -82,7 +108,10 @@ private:
     void sendNotificationRequest();
     void processIncomingMessage(uint8_t* data, size_t length);
     uint8_t calculateChecksum(const uint8_t* data, size_t length);
-    void sendWeightNotification(float weight);
+    void sendWeightNotification(const TelemetrySample& sample);
     void sendBeanConquerorWeight(float weight);    // Send simple float format
     void sendGaggiMateWeight(float weight);        // Send WeighMyBru protocol format
+    void sendTelemetryFrame(const TelemetrySample& sample); // Send binary telemetry frame
+    void sendShotEvent(const ShotEvent& event);    // Send shot analytics event
+    void requestConnectionParams();
 };
@@ -0,0 +1,71 @@
+#ifndef BOOTSCHEDULER_H
+#define BOOTSCHEDULER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
+/*
+ * Brings the subsystems up concurrently. Every step runs in its own
+ * short-lived task as soon as the steps it depends on have finished, so the
+ * HX711 probe, the I2C display and LittleFS no longer wait behind the radio
+ * bring-up. Readiness is an event-group bit per step - no fixed sleeps.
+ *
+ * The timeline (start/ready per step plus milestones such as the first weight
+ * on the OLED, in microseconds since boot) is printed to Serial once every
+ * step is done and served on /api/boot.
+ */
+class BootScheduler {
+public:
+    typedef bool (*StepFunction)(); // Returns false if the subsystem failed (dependents still run)
+
+    BootScheduler();
+
+    // Register a step; returns its bit for use in dependsOn / waitFor()
+    uint32_t add(const char* name, StepFunction function, uint32_t dependsOn = 0,
+                 uint32_t stackBytes = 6144, BaseType_t core = tskNO_AFFINITY);
+    void start();
+
+    // Block until all steps in mask have finished; false on timeout
+    bool waitFor(uint32_t mask, uint32_t timeoutMs = 30000);
+    uint32_t allSteps() const { return (1u << stepCount) - 1; }
+
+    void mark(const char* milestone); // Record a one-off milestone (first call per name wins)
+    void printTimeline() const;
+    String toJson() const;
+
+    static const size_t MAX_STEPS = 10;
+    static const size_t MAX_MILESTONES = 6;
+
+private:
+    struct Step {
+        const char* name;
+        StepFunction function;
+        uint32_t dependsOn;
+        uint32_t stackBytes;
+        BaseType_t core;
+        uint32_t startUs;
+        uint32_t readyUs;
+        bool ok;
+    };
+    struct Milestone {
+        const char* name;
+        uint32_t atUs;
+    };
+
+    Step steps[MAX_STEPS];
+    size_t stepCount;
+    Milestone milestones[MAX_MILESTONES];
+    volatile size_t milestoneCount;
+    EventGroupHandle_t readyBits;
+    StaticEventGroup_t readyBitsBuffer;
+    portMUX_TYPE milestoneLock;
+
+    void runStep(size_t index);
+    static void stepTask(void* param);
+};
+
+extern BootScheduler bootScheduler;
+
+#endif
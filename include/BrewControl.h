@@ -0,0 +1,40 @@
+#ifndef BREWCONTROL_H
+#define BREWCONTROL_H
+
+#include <Arduino.h>
+#include "EventBus.h"
+
+class Scale;         // Forward declaration
+class Display;       // Forward declaration
+class FlowRate;      // Forward declaration
+class PourSegmenter; // Forward declaration
+
+/*
+ * Executes tare and timer requests from the control event bus. Touch, BLE
+ * and web only publish a request; the one implementation here runs on the
+ * acquisition task, which owns the HX711s and the shot consumers, so no
+ * request races a conversion or a shot recorder. The taring/tared messages
+ * are drawn by the UI task from the TARE/TARED events.
+ */
+class BrewControl {
+public:
+    BrewControl(Scale* scale, Display* display, FlowRate* flowRate);
+    void begin(); // Subscribe to the control bus
+    void setPourSegmenter(PourSegmenter* segmenter);
+
+    // Sleep up to timeoutMs, waking at once for control events; handles everything pending.
+    // Returns the time spent handling (not waiting), in microseconds
+    uint32_t waitForEvents(uint32_t timeoutMs);
+
+private:
+    Scale* scalePtr;
+    Display* displayPtr;
+    FlowRate* flowRatePtr;
+    PourSegmenter* pourSegmenterPtr;
+    EventBus::SubscriberId subscription;
+
+    void handle(const ControlEvent& event);
+    void tare(const ControlEvent& event);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef COEXPOLICY_H
+#define COEXPOLICY_H
+
+#include <Arduino.h>
+
+// Which radio wins contended airtime on the shared 2.4GHz front end
+enum class CoexPreference : uint8_t {
+    BALANCE = 0, // Default time slicing
+    BLE,         // Shot running with a BLE controller connected
+    WIFI,        // Asset loads and history downloads
+    COUNT
+};
+
+/*
+ * WiFi/BLE coexistence driven by what the scale is doing, through the
+ * ESP-IDF coex preference API: BLE wins while a connected controller follows
+ * a shot, WiFi wins during web-heavy transfers, balanced otherwise. update()
+ * runs on the housekeeping task; a preference is held for MIN_DWELL_MS so
+ * short bursts don't flap the arbiter.
+ *
+ * BLE weight notifications are counted per preference in effect from the
+ * NimBLE notify status: "sent" when the stack queued it, "congested" when it
+ * ran out of buffers (the controller didn't get the airtime to drain them),
+ * "failed" for any other GATT error.
+ */
+class CoexPolicy {
+public:
+    CoexPolicy();
+
+    void update(bool bleShotActive, bool webHeavy);
+    CoexPreference current() const { return preference; }
+    bool isAvailable() const { return available; }
+
+    // NimBLE onStatus, once per weight notification sent to a subscribed client
+    void recordBleNotification(bool sent, bool congested);
+
+    void reset();
+    String toJson() const;
+
+    static const char* preferenceName(CoexPreference preference);
+
+    static const unsigned long MIN_DWELL_MS = 500;
+
+private:
+    void apply(CoexPreference next);
+
+    struct PreferenceStats {
+        unsigned long totalMs;
+        uint32_t notifications;
+        uint32_t congested;
+        uint32_t failed;
+    };
+
+    CoexPreference preference;
+    bool available;
+    unsigned long sinceMs;
+    uint32_t switches;
+    PreferenceStats stats[(int)CoexPreference::COUNT];
+};
+
+extern CoexPolicy coexPolicy;
+
+#endif
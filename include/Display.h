@@ -4,12 +4,16 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "SampleBus.h"
 
 class Scale; // Forward declaration
 class FlowRate; // Forward declaration
 class BluetoothScale; // Forward declaration
 class PowerManager; // Forward declaration
 class BatteryMonitor; // Forward declaration
+class WeightHistory; // Forward declaration
+class ShotLog; // Forward declaration
+class ShotAnalytics; // Forward declaration
 
 class Display {
 public:
@@ -45,9 +49,21 @@ public:
     // WiFi manager reference for network status display  
     void setWiFiManager(class WiFiManager* wifi);
     
+    // Weight history reference so a fresh timer start begins a new shot
+    void setWeightHistory(WeightHistory* history);
+    
+    // Shot log reference so timer-bounded shots are saved to flash
+    void setShotLog(ShotLog* shotLog);
+    
+    // Shot analytics reference so timer start/stop bound the analysed shot
+    void setShotAnalytics(ShotAnalytics* analytics);
+    void setSampleBus(SampleBus* bus); // Read weight at display rate with hysteresis
+    
     // Timer management
     void startTimer();
     void stopTimer();
+    void startTimerAt(uint32_t startMicros); // Fresh start back-dated to a sample timestamp
+    void stopTimerAt(uint32_t stopMicros);   // Stop back-dated to a sample timestamp
     void resetTimer();
     bool isTimerRunning() const;
     float getTimerSeconds() const;
@@ -62,6 +78,13 @@ private:
     PowerManager* powerManagerPtr;
     BatteryMonitor* batteryPtr;
     class WiFiManager* wifiManagerPtr;
+    WeightHistory* historyPtr;
+    ShotLog* shotLogPtr;
+    ShotAnalytics* analyticsPtr;
+    SampleBus* sampleBusPtr;
+    SampleCursor displayCursor; // ~10 Hz, ignores changes below 0.05 g
+    float displayedWeight;
+    bool firstWeightShown;     // Boot timeline milestone recorded
     Adafruit_SSD1306* display;
     bool displayConnected; // Track if display is actually connected
     
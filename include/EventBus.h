@@ -0,0 +1,100 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// Control events - requests (TARE, TIMER_*, PROFILE) and notifications (TARED, CLIENT_*, SETTINGS_CHANGED)
+enum class ControlEventType : uint8_t {
+    TARE = 0,            // Request: tare the scale (arg = HX711 readings to average, 0 = default)
+    TARED = 1,           // Notification: tare finished, timer and flow averaging reset
+    TIMER_START = 2,     // Request
+    TIMER_STOP = 3,      // Request
+    TIMER_RESET = 4,     // Request
+    SETTINGS_CHANGED = 5, // Notification (arg = SettingsGroup)
+    CLIENT_CONNECTED = 6,    // Notification (arg = ClientTransport)
+    CLIENT_DISCONNECTED = 7, // Notification (arg = ClientTransport)
+    PROFILE = 8              // Request: switch performance profile (arg = ProfileId, see ProfileManager)
+};
+
+// Who asked - lets a publisher recognise the answer to its own request
+enum class EventSource : uint8_t {
+    SYSTEM = 0,
+    TOUCH = 1,
+    BLE = 2,
+    WEB = 3
+};
+
+enum SettingsGroup : uint16_t {
+    SETTINGS_FILTER = 1,
+    SETTINGS_TIMER = 2,
+    SETTINGS_BREW = 3,
+    SETTINGS_CALIBRATION = 4,
+    SETTINGS_DISPLAY = 5,
+    SETTINGS_PROFILE = 6
+};
+
+enum ClientTransport : uint16_t {
+    CLIENT_BLE = 1,
+    CLIENT_WEBSOCKET = 2
+};
+
+struct ControlEvent {
+    ControlEventType type;
+    EventSource source;
+    uint16_t arg;
+    uint32_t timeMs; // millis() when published
+};
+
+#define EVENT_MASK(type) (1UL << (uint8_t)(type))
+
+/*
+ * Publish/subscribe bus for control events. Every subscriber owns a small
+ * statically allocated FreeRTOS queue, so publishing never allocates and a
+ * subscriber can block on receive() until something happens instead of
+ * checking flags every loop. Publishing never blocks either: when a
+ * subscriber's queue is full the event is dropped for that subscriber and
+ * counted.
+ *
+ * Subscribe during setup() only; publish() and receive() are safe from any task.
+ */
+class EventBus {
+public:
+    typedef int8_t SubscriberId; // -1 = subscription failed
+
+    EventBus();
+
+    SubscriberId subscribe(uint32_t mask, const char* name);
+    bool publish(ControlEventType type, EventSource source, uint16_t arg = 0);
+    bool receive(SubscriberId id, ControlEvent& event, TickType_t wait = 0);
+
+    static const char* typeName(ControlEventType type);
+    static const char* sourceName(EventSource source);
+
+    size_t getSubscriberCount() const { return subscriberCount; }
+    uint32_t getPublished() const { return published; }
+    uint32_t getDropped() const; // Sum over all subscribers
+
+    static const size_t MAX_SUBSCRIBERS = 6;
+    static const size_t QUEUE_DEPTH = 8;
+
+private:
+    struct Subscriber {
+        uint32_t mask;
+        const char* name;
+        QueueHandle_t queue;
+        StaticQueue_t queueControl;
+        uint8_t storage[QUEUE_DEPTH * sizeof(ControlEvent)];
+        volatile uint32_t dropped;
+    };
+
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    size_t subscriberCount;
+    volatile uint32_t published;
+};
+
+// The one control bus shared by every subsystem
+extern EventBus controlEvents;
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef FIRFILTER_H
+#define FIRFILTER_H
+
+#include <Arduino.h>
+#include "VibrationFilter.h" // WMB_HAS_ESP_DSP
+
+#if WMB_HAS_ESP_DSP
+#include <esp_dsp.h>
+#endif
+
+// Result of FirFilter::benchmark()
+struct FirBenchmark {
+    size_t taps = 0;
+    size_t samples = 0;
+    float scalarCyclesPerSample = 0.0f;
+    float vectorCyclesPerSample = 0.0f; // 0 when esp-dsp is not available
+};
+
+/*
+ * Linear-phase FIR low-pass (windowed sinc, Blackman window) as an alternative
+ * to the median + average stages. On the S3 the dot product runs through the
+ * esp-dsp FIR kernel, which uses the PIE vector instructions; other builds use
+ * the scalar reference below. Group delay is (taps - 1) / 2 samples.
+ */
+class FirFilter {
+public:
+    FirFilter();
+
+    // Design the kernel; taps is rounded to a multiple of 4 (16..MAX_TAPS)
+    void design(size_t taps, float cutoffHz, float sampleRateHz);
+    bool isDesigned() const { return taps > 0; }
+
+    float process(float reading);
+    void reset(float value); // Fill the delay line - no ramp after jumps or tare
+
+    size_t getTaps() const { return taps; }
+    float getCutoff() const { return cutoffHz; }
+    float getDesignRate() const { return designRateHz; }
+    float getGroupDelayMs() const;
+
+    // Cycles per sample of the scalar reference and the esp-dsp kernel
+    static FirBenchmark benchmark(size_t taps, size_t samples);
+
+    static const size_t MAX_TAPS = 64;
+
+private:
+    size_t taps;
+    float cutoffHz;
+    float designRateHz;
+
+    alignas(16) float coeffs[MAX_TAPS];
+    // Scalar path: every sample is written twice so the window is always contiguous
+    alignas(16) float history[2 * MAX_TAPS];
+    size_t position;
+
+#if WMB_HAS_ESP_DSP
+    alignas(16) float delay[MAX_TAPS];
+    fir_f32_t fir;
+#endif
+
+    float processScalar(float reading);
+};
+
+#endif
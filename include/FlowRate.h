@@ -12,6 +12,7 @@ public:
     void startTimerAveraging();
     void stopTimerAveraging();
     void resetTimerAveraging();
+    void addTimerSample(float rate); // Back-fill samples from before the timer started
     float getTimerAverageFlowRate() const;
     bool hasTimerAverage() const;
     
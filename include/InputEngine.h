@@ -0,0 +1,111 @@
+#ifndef INPUTENGINE_H
+#define INPUTENGINE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// Touch pads handled by the engine
+enum class InputPad : uint8_t {
+    TARE = 0,
+    SLEEP,
+    COUNT
+};
+
+enum class InputGesture : uint8_t {
+    PRESS = 0,       // Debounced touch start
+    RELEASE,         // Debounced touch end - always follows PRESS
+    TAP,             // Released before the long press threshold
+    LONG_PRESS,      // Held past the long press threshold (on hold or on release, per pad)
+    VERY_LONG_PRESS  // Held past the very long press threshold
+};
+
+// Gesture thresholds for one pad
+struct InputPadConfig {
+    uint32_t longPressMs;
+    uint32_t veryLongPressMs;  // 0 - no very long press
+    bool longPressOnRelease;   // Report LONG_PRESS when released instead of once the threshold is reached
+};
+
+// Receives the gestures of the pads it attached to, on the UI task
+class InputListener {
+public:
+    virtual ~InputListener() {}
+    virtual void onInputGesture(InputPad pad, InputGesture gesture, uint32_t heldMs) = 0;
+};
+
+/*
+ * Interrupt-driven input for the touch pads. Each pad pin runs a level
+ * interrupt that the ISR flips to the opposite level on every change, so it
+ * sees both edges and the same setting doubles as the light-sleep GPIO wake
+ * source. Edges are timestamped into a queue; process() debounces them and
+ * turns them into gestures for the listeners. The UI task blocks in
+ * waitForInput() between refreshes, so a tap is handled as soon as it
+ * happens instead of on the next poll.
+ */
+class InputEngine {
+public:
+    InputEngine();
+
+    bool attach(InputPad pad, uint8_t pin, const InputPadConfig& config, InputListener* listener);
+    void process();                                  // Drain edges and run gesture timers - UI task only
+    bool waitForInput(TickType_t maxWait);           // Block until an edge arrives or maxWait passes
+    TickType_t ticksUntilDeadline() const;           // Next debounce settle or hold threshold
+    bool isPressed(InputPad pad) const;
+
+    void reset();
+    String toJson() const;
+
+    static const char* padName(InputPad pad);
+    static const char* gestureName(InputGesture gesture);
+
+    static const uint32_t DEBOUNCE_MS = 50;
+    static const size_t QUEUE_LENGTH = 32;
+
+private:
+    struct Edge {
+        uint8_t pad;
+        uint8_t level;
+        uint32_t timeMs;
+    };
+
+    struct PadState {
+        bool attached;
+        uint8_t pin;
+        InputPadConfig config;
+        InputListener* listener;
+        bool pressed;           // Debounced state
+        bool rawLevel;          // Last level seen by the ISR
+        bool settlePending;     // An edge fell inside the debounce window
+        uint32_t lastChangeMs;  // Time of the last accepted change
+        uint32_t pressStartMs;
+        bool longFired;
+        bool veryLongFired;
+        bool suppressed;        // Held when attached (the wake touch) - no gestures until released
+    };
+
+    struct Stats {
+        uint32_t edges;
+        uint32_t bounces;
+        uint32_t gestures;
+        uint32_t maxDispatchMs;  // Edge (or hold threshold) to gesture delivery
+        uint64_t totalDispatchMs;
+    };
+
+    static void IRAM_ATTR edgeIsr(void* arg);
+
+    void handleEdge(const Edge& edge);
+    void commit(InputPad pad, bool pressed, uint32_t timeMs);
+    void checkHold(InputPad pad, uint32_t now);
+    void emit(InputPad pad, InputGesture gesture, uint32_t heldMs, uint32_t edgeMs);
+
+    QueueHandle_t queue;
+    bool isrInstalled;
+    PadState pads[(size_t)InputPad::COUNT];
+    Stats stats;
+    volatile uint32_t droppedInIsr;
+};
+
+extern InputEngine inputEngine;
+
+#endif
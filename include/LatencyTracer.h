@@ -0,0 +1,52 @@
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <Arduino.h>
+
+// Points a sample passes on its way from the HX711 to a consumer
+enum LatencyStage : uint8_t {
+    LATENCY_FILTER = 0,    // Filtered weight available (Scale::getWeight returned)
+    LATENCY_FLOW,          // Flow rate updated with the sample
+    LATENCY_BLE_NOTIFY,    // GaggiMate weight notification handed to NimBLE
+    LATENCY_WS_SEND,       // Telemetry frame queued to the /ws clients
+    LATENCY_HTTP_RESPONSE, // /api/brew/* response handed to AsyncTCP
+    LATENCY_OLED_PUSH,     // Frame showing the sample pushed to the display
+    LATENCY_STAGE_COUNT
+};
+
+/*
+ * End-to-end latency from the HX711 conversion to each consumer. Samples
+ * carry their conversion time (TelemetrySample::timestampUs, the DOUT ready
+ * edge - so the read poll delay is part of every stage); every stage
+ * calls mark() with it, and the age is binned into a fixed histogram from
+ * which p50/p95/p99 are interpolated. Each stage is marked from one task only
+ * (HTTP from the AsyncTCP task), so recording needs no lock.
+ */
+class LatencyTracer {
+public:
+    LatencyTracer();
+
+    void mark(LatencyStage stage, uint32_t captureUs);
+    void reset();
+    String toJson() const;
+
+    static const char* stageName(LatencyStage stage);
+
+    static const size_t BUCKET_COUNT = 20; // 19 bounds + overflow
+
+private:
+    struct StageStats {
+        uint32_t buckets[BUCKET_COUNT];
+        uint32_t count;
+        uint64_t totalUs;
+        uint32_t maxUs;
+    };
+
+    StageStats stages[LATENCY_STAGE_COUNT];
+
+    float percentileMs(const StageStats& stats, float fraction) const;
+};
+
+extern LatencyTracer latencyTracer;
+
+#endif
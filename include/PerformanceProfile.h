@@ -0,0 +1,98 @@
+#ifndef PERFORMANCEPROFILE_H
+#define PERFORMANCEPROFILE_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_bt.h>
+#include "EventBus.h"
+
+// Named system-wide tuning presets - from lowest latency to longest runtime
+enum class ProfileId : uint8_t {
+    BREW = 0,        // Shot running: full rate everywhere, radios awake
+    DOSE = 1,        // Default: the firmware's regular settings
+    IDLE = 2,        // Nothing happening: slow BLE, deep modem sleep, lazy UI
+    LOW_BATTERY = 3, // Entered automatically when the battery runs low
+    COUNT
+};
+
+// Every knob a profile sets. Each subsystem reads the fields it owns from
+// its own task, so one pointer swap switches the whole system at once.
+struct PerformanceProfile {
+    const char* name;
+
+    // Acquisition
+    bool pinFullRate;             // Governor never steps down to REDUCED/SPARSE
+    uint8_t stableAverageSamples; // Average filter length when STABLE (0 = user setting)
+    bool holdMaxCpu;              // Keep the CPU at full clock regardless of activity
+
+    // BLE
+    uint32_t bleWeightIntervalMs;
+    uint32_t bleHeartbeatMs;
+    esp_power_level_t bleTxPower;
+    uint16_t bleConnIntervalMin;  // 1.25ms units
+    uint16_t bleConnIntervalMax;
+    uint16_t bleConnLatency;      // Connection events the peripheral may skip
+
+    // WiFi
+    wifi_ps_type_t wifiPowerSave; // Base modem sleep level
+    bool wifiLatencyBoost;        // Drop to no-sleep while clients stream/poll or a shot runs
+
+    // UI - touch polling and OLED refresh
+    uint32_t uiPeriodMs;
+};
+
+/*
+ * Owns the active performance profile. Switches are requested over the
+ * control bus (PROFILE) from the API, the BLE command and the touch gesture,
+ * and executed by BrewControl on the acquisition task, so they are
+ * serialized like tare and timer requests. Executing one swaps the profile
+ * pointer and bumps a generation counter; the acquisition, comms, UI and
+ * housekeeping tasks compare the generation each cycle and re-apply their
+ * knobs when it moves. Manual selections are persisted; LOW_BATTERY is
+ * entered and left automatically without overwriting the saved choice.
+ */
+class ProfileManager {
+public:
+    ProfileManager();
+
+    void begin(); // Restore the saved profile (DOSE when none)
+
+    const PerformanceProfile& current() const { return *active; }
+    ProfileId currentId() const { return activeId; }
+    uint32_t generation() const { return profileGeneration; }
+
+    // Any task - publishes a PROFILE request
+    bool request(ProfileId id, EventSource source);
+    void requestCycle(EventSource source); // Next manual profile (touch gesture)
+    ProfileId nextInCycle() const;         // BREW -> DOSE -> IDLE -> BREW
+    void updateBattery(bool low);          // Once per second from housekeeping
+
+    void handleRequest(const ControlEvent& event); // Acquisition task (BrewControl)
+
+    String toJson() const;
+
+    static const PerformanceProfile& get(ProfileId id);
+    static const char* name(ProfileId id);
+    static bool fromName(const String& name, ProfileId& id);
+
+    // PROFILE event argument: profile id, or CYCLE, plus AUTO for battery switches
+    static const uint16_t ARG_CYCLE = 0xFF;
+    static const uint16_t ARG_AUTO = 0x100;
+
+private:
+    void select(ProfileId id, EventSource source, bool automatic);
+    void apply(ProfileId id, EventSource source);
+
+    const PerformanceProfile* volatile active;
+    volatile ProfileId activeId;
+    volatile uint32_t profileGeneration;
+    ProfileId selectedId;        // Last manual choice - restored when the battery recovers
+    volatile bool batteryOverride; // LOW_BATTERY entered automatically
+    unsigned long lowSinceMs;
+    unsigned long okSinceMs;
+    uint32_t switches;
+};
+
+extern ProfileManager profileManager;
+
+#endif
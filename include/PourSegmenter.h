@@ -0,0 +1,94 @@
+#ifndef POURSEGMENTER_H
+#define POURSEGMENTER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "TelemetryFrame.h"
+
+class Scale;         // Forward declaration
+class ShotAnalytics; // Forward declaration
+
+enum class PourPhase : uint8_t {
+    IDLE,     // Nothing poured yet in this session
+    POURING,
+    PAUSE     // Bloom or between pours
+};
+
+// One detected pour of a pour-over session
+struct PourSegment {
+    uint32_t startMs;      // Session time the pour started
+    uint32_t durationMs;
+    uint32_t pauseBeforeMs; // Pause since the previous pour (bloom time for pour 2)
+    float startWeight;
+    float volume;          // Grams added during the pour
+    float flowRate;        // Mean pour rate, g/s
+};
+
+/*
+ * Pour-over mode: splits the weight stream online into pours and pauses.
+ * Pours are detected from the slope of the unfiltered weight over a short
+ * window, so detection does not wait for the smoothing filter. While pouring
+ * the scale uses its fast median filter; in pauses it switches to heavy
+ * averaging because nothing changes and a steady number matters more.
+ */
+class PourSegmenter {
+public:
+    PourSegmenter(Scale* scale);
+    void begin(); // Load the setting from NVS
+
+    void setEnabled(bool enabled); // Persisted to NVS
+    bool isEnabled() const { return enabled; }
+
+    void update(const TelemetrySample& sample, float unfilteredWeight);
+    void reset(); // Start a new session (tare / timer reset)
+
+    PourPhase getPhase() const { return phase; }
+    static const char* phaseName(PourPhase phase);
+    size_t getPourCount() const { return pourCount; }
+    const PourSegment& getPour(size_t index) const { return pours[index]; }
+    float getTotalVolume() const;
+
+    void setShotAnalytics(ShotAnalytics* analytics); // Publishes pour events
+
+    static const size_t MAX_POURS = 8;
+
+private:
+    Scale* scalePtr;
+    ShotAnalytics* analyticsPtr;
+    Preferences preferences;
+    bool enabled;
+
+    PourPhase phase;
+    PourSegment pours[MAX_POURS];
+    size_t pourCount;
+    bool sessionStarted;
+    uint32_t sessionStartUs;
+    uint32_t lastPourEndMs;
+
+    // Short window of unfiltered weights for the slope estimate
+    static const size_t SLOPE_WINDOW = 6;
+    float windowWeight[SLOPE_WINDOW];
+    uint32_t windowTimeUs[SLOPE_WINDOW];
+    size_t windowHead;
+    size_t windowCount;
+
+    uint8_t riseSamples;
+    bool slowing;
+    uint32_t slowSinceMs;
+    uint32_t nearZeroSinceMs;
+    uint32_t lastSequence;
+
+    static constexpr float POUR_START_RATE = 1.0f;  // g/s that counts as pouring
+    static const uint8_t POUR_CONFIRM_SAMPLES = 2;
+    static constexpr float POUR_END_RATE = 0.3f;    // g/s below which the pour is over
+    static const uint32_t PAUSE_HOLD_MS = 800;
+    static constexpr float EMPTY_WEIGHT = 1.0f;     // Below this (after tare) the session resets
+    static const uint32_t EMPTY_HOLD_MS = 1000;
+
+    float slope() const;
+    void startPour(uint32_t nowMs, float weight);
+    void endPour(uint32_t nowMs, float weight);
+    void applyFilter();
+};
+
+#endif
@@ -3,18 +3,22 @@
 
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include "InputEngine.h"
 
 class Display; // Forward declaration
+class Scale;
 
-class PowerManager {
+class PowerManager : public InputListener {
 public:
     PowerManager(uint8_t sleepTouchPin, Display* display = nullptr);
     void begin();
-    void update();
+    void update(); // Sleep countdown - gestures arrive from the input engine
+    void onInputGesture(InputPad pad, InputGesture gesture, uint32_t heldMs) override;
     void enterDeepSleep();
     void setSleepTouchThreshold(uint16_t threshold);
     bool isSleepTouchPressed();
     void setDisplay(Display* display);
+    void setScale(Scale* scale); // State retained in RTC memory for fast wake
     
     // Timer control for TIME mode
     void handleTimerControl();
@@ -23,16 +27,14 @@ public:
 private:
     uint8_t sleepTouchPin;
     Display* displayPtr;
+    Scale* scalePtr = nullptr;
     uint16_t sleepTouchThreshold;
-    bool lastSleepTouchState;
-    unsigned long lastSleepTouchTime;
-    unsigned long touchStartTime;
-    unsigned long debounceDelay;
     unsigned long sleepCountdownStart;
     bool sleepCountdownActive;
-    bool longPressDetected;
-    bool cancelledRecently;
-    unsigned long cancelTime;
+    int sleepCountdownShown;  // Digit on screen - redrawn when the remaining seconds change
+    bool ignoreUntilRelease; // The touch that cancelled the countdown - no timer or sleep action
+    
+    static const unsigned long SLEEP_PRESS_DURATION = 1000; // Hold to start the sleep countdown
     
     // Timer control state
     enum class TimerState {
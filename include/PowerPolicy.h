@@ -0,0 +1,59 @@
+#ifndef POWERPOLICY_H
+#define POWERPOLICY_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+
+// Subsystems that pin the CPU at full clock while they are active
+enum PowerLock : uint8_t {
+    POWER_LOCK_ACQUIRE = 0, // Scale BREWING/TRANSITIONING (+ a short tail)
+    POWER_LOCK_BLE,         // BLE client connected
+    POWER_LOCK_HTTP,        // /ws clients or an HTTP request in the last few seconds
+    POWER_LOCK_PROFILE,     // Performance profile asks for full clock (brew)
+    POWER_LOCK_COUNT
+};
+
+/*
+ * Dynamic frequency scaling and automatic light sleep via esp_pm. The CPU
+ * idles at MIN_CPU_MHZ and drops into light sleep between ticks when nothing
+ * holds a lock; each subsystem holds its own CPU_FREQ_MAX lock only while it
+ * is active. setActive() is edge-triggered and called from the one task
+ * that owns the subsystem, so it is cheap enough to call every cycle.
+ */
+class PowerPolicy {
+public:
+    PowerPolicy();
+
+    bool begin(); // Configure esp_pm and create the locks - false when PM is unavailable
+    void setActive(PowerLock lock, bool active);
+    bool isActive(PowerLock lock) const { return locks[lock].active; }
+    bool isIdle() const; // No subsystem holds a lock - tasks may stretch their periods
+
+    bool isEnabled() const { return enabled; }
+    bool isLightSleepEnabled() const { return lightSleep; }
+    String toJson() const;
+
+    static const char* lockName(PowerLock lock);
+
+    static const int MAX_CPU_MHZ = 240;
+    static const int MIN_CPU_MHZ = 80; // Keeps APB at 80MHz - UART, I2C and HX711 timing unchanged
+
+private:
+    struct LockState {
+        esp_pm_lock_handle_t cpuLock;
+        esp_pm_lock_handle_t sleepLock; // Acquisition only - light sleep wake-up jitters the sample clock
+        volatile bool active;
+        unsigned long activeSinceMs;
+        unsigned long totalActiveMs;
+        uint32_t acquisitions;
+    };
+
+    LockState locks[POWER_LOCK_COUNT];
+    bool enabled;
+    bool lightSleep;
+    unsigned long startMs;
+};
+
+extern PowerPolicy powerPolicy;
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+/*
+ * Cycle-counter profiling of the subsystem updates, compiled in only with
+ * -DWMB_PROFILING (see the *-profiling environments in platformio.ini).
+ * Production builds get empty macros and no Profiler symbols at all.
+ *
+ *   PROFILE_SCOPE(PROFILE_SCALE_READ);   // times the rest of the block
+ *
+ * Each point keeps a fixed-bucket latency histogram plus the maximum since
+ * boot and within the last window. Per-core idle time comes from idle hooks;
+ * in profiling builds the hooks keep the idle task spinning (no WFI) so every
+ * idle microsecond is seen - expect higher current draw while profiling.
+ */
+
+enum ProfilePoint {
+    PROFILE_SCALE_READ = 0,   // scale.getWeight()
+    PROFILE_FLOW_UPDATE,      // flowRate.update()
+    PROFILE_BLE_UPDATE,       // bluetoothScale.update()
+    PROFILE_WIFI_MAINTAIN,    // maintainWiFi()
+    PROFILE_TOUCH_UPDATE,     // inputEngine.process() + touchSensor.update()
+    PROFILE_BATTERY_UPDATE,   // batteryMonitor.update()
+    PROFILE_DISPLAY_UPDATE,   // oledDisplay.update()
+    PROFILE_POINT_COUNT
+};
+
+#ifdef WMB_PROFILING
+
+class Profiler {
+public:
+    static void begin();  // Register the idle hooks
+    static void sample(); // Once per second - closes the idle and window-max window
+    static void reset();  // Clear histograms and maxima
+
+    // Each point is recorded from a single task, so no locking is needed
+    static void record(ProfilePoint point, uint32_t cycles);
+
+    static String toJson();
+
+    static const size_t BUCKET_COUNT = 13; // 12 bounds + overflow
+    static const uint32_t BUCKET_BOUNDS_US[BUCKET_COUNT - 1];
+};
+
+// Times the enclosing scope with the CPU cycle counter (tasks are pinned)
+class ScopedProfile {
+public:
+    explicit ScopedProfile(ProfilePoint point) : point(point), start(ESP.getCycleCount()) {}
+    ~ScopedProfile() { Profiler::record(point, ESP.getCycleCount() - start); }
+
+private:
+    ProfilePoint point;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(point) ScopedProfile PROFILE_CONCAT(profileScope, __LINE__)(point)
+#define PROFILER_BEGIN() Profiler::begin()
+#define PROFILER_SAMPLE() Profiler::sample()
+
+#else
+
+#define PROFILE_SCOPE(point) do {} while (0)
+#define PROFILER_BEGIN() do {} while (0)
+#define PROFILER_SAMPLE() do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef RETAINEDSTATE_H
+#define RETAINEDSTATE_H
+
+#include <Arduino.h>
+#include "WiFiManager.h" // WiFiAssociation
+
+class Scale; // Forward declaration
+
+// Scale state needed to produce a weight without probing, NVS or a new tare
+struct RetainedScaleState {
+    bool dualHX711;
+    int32_t offset1;            // HX711 tare offsets - the user's tare survives sleep
+    int32_t offset2;
+    float calibrationFactor;
+    float calibrationFactor1;
+    float calibrationFactor2;
+    float brewingThreshold;
+    uint32_t stabilityTimeout;
+    int32_t medianSamples;
+    int32_t averageSamples;
+    bool notchEnabled;
+    bool firEnabled;
+    int32_t firTaps;
+    float firCutoffHz;
+};
+
+/*
+ * State kept in RTC slow memory across deep sleep. save() runs right before
+ * esp_deep_sleep_start(); after a deep-sleep wake the boot path resumes from
+ * it instead of re-probing the HX711s, re-taring and reading NVS. The block
+ * carries a magic, a layout version and a CRC32, and is only trusted when the
+ * reset reason is a deep-sleep wake - any other reset takes the full path.
+ */
+class RetainedState {
+public:
+    static bool isValid(); // Checked once, on first call
+    static const RetainedScaleState& scale();
+    static bool wifiAssociation(WiFiAssociation& association); // False when none was retained
+
+    static void save(const Scale& scale);
+    static void invalidate();
+
+private:
+    static uint32_t checksum();
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SAMPLEBUS_H
+#define SAMPLEBUS_H
+
+#include <Arduino.h>
+#include "TelemetryFrame.h"
+
+// How a consumer walks the bus
+enum class SamplePolicy : uint8_t {
+    EVERY,  // Every sample in order (skips ahead only if it fell a whole ring behind)
+    LATEST  // Only the newest sample, rate-limited by minIntervalUs / deadband
+};
+
+// Per-consumer read position and output policy
+struct SampleCursor {
+    SamplePolicy policy = SamplePolicy::LATEST;
+    uint32_t minIntervalUs = 0; // LATEST: minimum spacing between delivered samples
+    float deadband = 0.0f;      // LATEST: deliver only when weight moved at least this far (g)
+
+    uint32_t position = 0;      // Samples consumed (bus publish count)
+    uint32_t delivered = 0;
+    uint32_t skipped = 0;       // Newer samples superseded them or the policy held them back
+    uint32_t overruns = 0;      // EVERY: samples lost because the ring wrapped
+
+    bool hasDelivered = false;
+    uint32_t lastDeliveredUs = 0;
+    float lastDeliveredWeight = 0.0f;
+
+    SampleCursor() {}
+    SampleCursor(SamplePolicy policy, uint32_t minIntervalUs = 0, float deadband = 0.0f)
+        : policy(policy), minIntervalUs(minIntervalUs), deadband(deadband) {}
+};
+
+/*
+ * Single-producer broadcast ring of filtered samples. The acquisition loop
+ * publishes one TelemetrySample per conversion; every consumer owns a cursor
+ * and reads at its own pace, so a slow reader never holds back the others and
+ * nothing is copied per consumer until it actually reads.
+ *
+ * Readers on other tasks are safe: a slot is copied and then validated
+ * against the publish count, so a copy torn by the writer is detected.
+ */
+class SampleBus {
+public:
+    SampleBus();
+
+    void publish(const TelemetrySample& sample); // Producer (acquisition task) only
+
+    // Next sample for this cursor according to its policy; false when nothing is due
+    bool read(SampleCursor& cursor, TelemetrySample& sample);
+    bool latest(TelemetrySample& sample) const; // Newest sample, ignoring cursors
+
+    // Start a cursor at the current head, so it only sees new samples
+    void attach(SampleCursor& cursor) const { cursor.position = published; }
+
+    uint32_t getPublished() const { return published; }
+    uint32_t latestSequence() const { return lastSequence; } // Scale sequence of the newest sample
+
+    static const size_t CAPACITY = 64; // ~0.8s at 80 SPS
+
+private:
+    TelemetrySample ring[CAPACITY];
+    volatile uint32_t published;
+    uint32_t lastSequence;
+
+    bool copy(uint32_t index, TelemetrySample& sample) const;
+};
+
+#endif
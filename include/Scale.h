@@ -3,6 +3,11 @@
 
 #include <HX711.h>
 #include <Preferences.h>
+#include "VibrationFilter.h"
+#include "FirFilter.h"
+#include "AcquisitionGovernor.h"
+
+struct RetainedScaleState; // RetainedState.h
 
 class Scale {
 public:
@@ -13,6 +18,8 @@ public:
     Scale(uint8_t dataPin1, uint8_t dataPin2, uint8_t clockPin, float calibrationFactor);
     
     bool begin();  // Returns true if successful, false if HX711 fails
+    bool resume(const RetainedScaleState& state); // Deep-sleep wake: no probe, no tare, no NVS
+    void exportRetained(RetainedScaleState& state) const;
     void tare(uint8_t times = 20);
     void set_scale(float factor);
     float getWeight();
@@ -48,13 +55,45 @@ public:
     void saveFilterSettings();
     void loadFilterSettings();
     
-    // FlowRate integration for tare operations
-    void setFlowRatePtr(class FlowRate* flowRatePtr);
-
+    // Filter override for pour-over mode - AUTO keeps the brewing detection above
+    enum FilterOverride {
+        FILTER_AUTO,    // Median while brewing, average when stable
+        FILTER_FAST,    // Always the median filter (pouring)
+        FILTER_SMOOTH   // Average over the whole buffer (pause between pours)
+    };
+    void setFilterOverride(FilterOverride mode) { filterOverride = mode; }
+    FilterOverride getFilterOverride() const { return filterOverride; }
+    
+    // Adaptive notch for pump vibration, applied before the median/average stages
+    void setNotchEnabled(bool enabled);
+    bool isNotchEnabled() const { return vibrationFilter.isEnabled(); }
+    const VibrationFilter& getVibrationFilter() const { return vibrationFilter; }
+    
+    // FIR low-pass instead of median/average (linear phase, (taps-1)/2 samples delay)
+    void setFirSettings(bool enabled, int taps, float cutoffHz);
+    bool isFirEnabled() const { return firEnabled; }
+    int getFirTaps() const { return firTaps; }
+    float getFirCutoff() const { return firCutoffHz; }
+    const FirFilter& getFirFilter() const { return firFilter; }
+    
     // Dual HX711 status methods
     bool isDualHX711() const { return dualHX711; }
     String getHX711Status() const; // Get HX711 connection status as string
     
+    // Sample metadata for telemetry streams
+    uint32_t getSampleSequence() const { return sampleSequence; } // Increments per filtered sample
+    uint32_t getSampleTimestampUs() const { return sampleTimestampUs; } // micros() of the underlying conversion
+    long getLastRaw1() const { return lastRaw1; } // Raw ADC of cell 1 from the last conversion
+    long getLastRaw2() const { return lastRaw2; } // Raw ADC of cell 2 from the last conversion
+    bool isBrewingActive() const { return currentFilterState != STABLE; }
+    
+    // Adaptive read cadence - FULL while brewing, slower and powered down when idle
+    const AcquisitionGovernor& getGovernor() const { return governor; }
+    uint32_t getReadIntervalMs() const { return governor.readIntervalMs(); }
+    void wakeAcquisition(); // Power the HX711s up and return to FULL (tare, calibration)
+    void setAcquisitionProfile(bool pinFullRate, uint8_t stableAverageSamples); // Performance profile
+    float getUnfilteredWeight() const { return lastUnfilteredWeight; } // Last reading before filtering
+    
 private:
     HX711 hx7111;           // Erster HX711
     HX711 hx7112;           // Zweiter HX711 (optional)
@@ -71,7 +110,6 @@ private:
     float currentWeight;
     bool isConnected = false;  // Track HX711 connection status
     bool dualHX711 = false;    // Zwei HX711 Module aktiv
-    class FlowRate* flowRatePtr = nullptr; // For pausing flow rate during tare
     
     // Smart filtering variables - reduced buffer for faster response
     static const int MAX_SAMPLES = 10;  // Reduced from 50 to 10 for faster response
@@ -80,6 +118,15 @@ private:
     bool samplesInitialized = false;
     float previousFilteredWeight = 0;
     
+    // Telemetry sample tracking
+    uint32_t sampleSequence = 0;
+    uint32_t sampleTimestampUs = 0;
+    uint32_t lastConversionMicros = 0;
+    volatile uint32_t doutReadyMicros = 0; // Last DOUT falling edge - conversion ready
+    long lastRaw1 = 0;
+    long lastRaw2 = 0;
+    float lastUnfilteredWeight = 0.0f;
+    
     // Status-Tracking für stabile Erkennung
     mutable unsigned long lastSuccessfulRead = 0; // Zeitpunkt des letzten erfolgreichen Reads
     
@@ -98,8 +145,23 @@ private:
     unsigned long stabilityTimeout = 2000;  // Keep for API compatibility
     int medianSamples = 3;  // Keep for API compatibility
     int averageSamples = 2;  // Samples for average filter - reduced for faster response
+    FilterOverride filterOverride = FILTER_AUTO; // Not persisted - set by the pour segmenter
+    VibrationFilter vibrationFilter;
+    FirFilter firFilter;
+    AcquisitionGovernor governor;
+    uint8_t profileAverageSamples = 0; // Performance profile override, 0 = averageSamples
+    bool firEnabled = false;
+    int firTaps = 32;
+    float firCutoffHz = 5.0f;
+    volatile bool firRedesignPending = false; // Settings changed from the web task - acquisition redesigns
     
     // Private methods
+    void powerDownHX711();
+    void attachReadyInterrupt();
+    uint32_t takeConversionTime(); // DOUT ready edge of the conversion about to be read
+    static void IRAM_ATTR doutReadyIsr(void* arg);
+    void powerUpHX711();
+    bool hx711Ready();
     bool initializeSingleHX711();
     bool initializeDualHX711();
     float readSingleHX711();
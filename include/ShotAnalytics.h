@@ -0,0 +1,120 @@
+#ifndef SHOTANALYTICS_H
+#define SHOTANALYTICS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "TelemetryFrame.h"
+
+class ShotLog; // Forward declaration
+
+enum class ShotEventType : uint8_t {
+    SHOT_STARTED = 1,   // Timer started from zero
+    FIRST_DROP = 2,     // First drips reached the cup (value = ms after shot start)
+    SHOT_ENDED = 3,     // Flow stopped or timer stopped (value = mean flow g/s)
+    YIELD_SETTLED = 4,  // Drip tail settled (weight = final yield)
+    POUR_STARTED = 5,   // Pour-over: a pour began (value = pour number, time = session time)
+    POUR_ENDED = 6      // Pour-over: a pour ended (value = grams poured, time = session time)
+};
+
+enum class ShotPhase : uint8_t {
+    IDLE,
+    WAITING_FOR_DROP,
+    FLOWING,
+    SETTLING
+};
+
+// One analytics event, as published to BLE, the dashboard and the shot log
+struct ShotEvent {
+    uint32_t sequence = 0;  // Increments per event, used as consumer cursor
+    ShotEventType type = ShotEventType::SHOT_STARTED;
+    uint32_t shotTimeMs = 0; // Time since shot start
+    float weight = 0.0f;
+    float value = 0.0f;      // Event specific, see ShotEventType
+};
+
+// Running figures of the current (or last) shot
+struct ShotSummary {
+    ShotPhase phase = ShotPhase::IDLE;
+    bool hasFirstDrop = false;
+    bool settled = false;
+    uint32_t firstDropMs = 0;  // Time to first drop
+    uint32_t flowingMs = 0;    // First drop until end of flow
+    float peakFlowRate = 0.0f;
+    float meanFlowRate = 0.0f;
+    float flowStdDev = 0.0f;   // Flow stability - lower is steadier
+    float yieldWeight = 0.0f;  // Final weight once the drip tail settled
+};
+
+/*
+ * Incremental shot analysis over the filtered sample stream. Every sample is
+ * processed in constant time: flow statistics use Welford's running mean and
+ * variance, and all detectors are small state machines with timers.
+ *
+ * A shot is bounded by the timer; the first drips are detected from the
+ * weight within it. With the flow-triggered AutoTimer enabled the timer - and
+ * so the shot - starts on the weight as well. Events are written on the
+ * acquisition task and read from the comms and web tasks under eventLock.
+ */
+class ShotAnalytics {
+public:
+    ShotAnalytics();
+
+    void beginShot(uint32_t startUs); // Timer started from zero (micros() timestamp)
+    void endShot();     // Timer stopped
+    void reset();       // Timer reset - forget the shot
+    void update(const TelemetrySample& sample);
+
+    const ShotSummary& getSummary() const { return summary; }
+    ShotPhase getPhase() const { return summary.phase; }
+    static const char* phaseName(ShotPhase phase);
+    static const char* eventName(ShotEventType type);
+
+    // Fetch the next event after cursor; returns false when caught up
+    bool nextEvent(uint32_t& cursor, ShotEvent& event) const;
+    uint32_t getEventSequence() const { return eventSequence; } // Cursor that skips old events
+
+    void setShotLog(ShotLog* shotLog);
+
+    // Queue an event from another detector (pour segmenter) for the same consumers
+    void publish(ShotEventType type, uint32_t shotTimeMs, float weight, float value);
+
+private:
+    static const size_t EVENT_QUEUE_SIZE = 8;
+    static constexpr float DROP_WEIGHT = 0.3f;       // Grams above the start weight
+    static constexpr float DROP_FLOW = 0.2f;         // g/s confirming it is not noise
+    static const uint8_t DROP_CONFIRM_SAMPLES = 3;
+    static constexpr float END_FLOW = 0.3f;          // g/s below which the shot has stopped
+    static const uint32_t END_HOLD_MS = 4000;
+    static constexpr float SETTLE_BAND = 0.1f;       // Grams of drift allowed while settling
+    static const uint32_t SETTLE_HOLD_MS = 2000;
+    static const uint32_t SETTLE_TIMEOUT_MS = 20000;
+
+    ShotSummary summary;
+    ShotLog* shotLogPtr;
+
+    bool startPending;
+    uint32_t startUs;
+    float startWeight;
+    uint8_t dropCandidates;
+    uint32_t lastSequence;
+    float lastWeight;
+
+    // Welford running statistics for flow while FLOWING
+    uint32_t flowSamples;
+    float flowMean;
+    float flowM2;
+
+    uint32_t lowFlowSinceMs;
+    bool lowFlow;
+    uint32_t endMs;
+    float settleReference;
+    uint32_t settleSinceMs;
+
+    ShotEvent events[EVENT_QUEUE_SIZE];
+    volatile uint32_t eventSequence;
+    mutable portMUX_TYPE eventLock;
+
+    void finishFlowing(uint32_t nowMs, float weight);
+};
+
+#endif
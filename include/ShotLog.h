@@ -0,0 +1,141 @@
+#ifndef SHOTLOG_H
+#define SHOTLOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "TelemetryFrame.h"
+
+struct ShotSummary; // ShotAnalytics.h
+
+// One fixed-size record in /shots/index.bin (oldest first)
+struct ShotIndexEntry {
+    uint32_t id;
+    uint32_t durationMs;
+    uint32_t points;
+    uint32_t bytes;        // Size of the curve file
+    float finalWeight;     // Grams at the end of the shot
+    float avgFlowRate;     // Timer average flow rate, g/s
+    float peakFlowRate;    // Highest flow rate seen, g/s
+    uint32_t firstDropMs;  // Time to first drop (0 = not detected)
+    float flowStdDev;      // Flow stability while flowing, g/s
+    float yieldWeight;     // Weight after the drip tail settled (0 = not settled)
+};
+
+// One decoded curve point
+struct ShotPoint {
+    uint32_t timeMs;
+    float weight;
+    float flowRate;
+};
+
+/*
+ * Curve file /shots/<id>.bin:
+ *   16 byte header: "WMBS", version u8, reserved u8, header size u16, shot id u32, reserved u32
+ *   then per point: varint dt_ms, zigzag varint d_weight (0.01 g), zigzag varint d_flow (0.01 g/s)
+ * A steady pour costs 3-4 bytes per point instead of 12 for raw floats.
+ */
+class ShotCurveDecoder {
+public:
+    explicit ShotCurveDecoder(Stream& input);
+    bool readHeader(uint32_t& shotId);
+    bool next(ShotPoint& point); // False at end of file
+
+private:
+    Stream& input;
+    uint32_t timeMs;
+    int32_t weightCg;
+    int32_t flowCg;
+    bool readVarint(uint32_t& value);
+};
+
+/*
+ * Persists every timer-bounded shot to LittleFS. Samples are compressed in the
+ * loop and handed to a low-priority writer task in small chunks, so flash
+ * erase/write time never blocks acquisition. Oldest shots are pruned when the
+ * log grows past MAX_SHOTS or the partition runs low.
+ */
+class ShotLog {
+public:
+    ShotLog();
+    bool begin();
+
+    void beginShot(uint32_t startUs);  // Timer started from zero (micros() timestamp)
+    void record(const TelemetrySample& sample);
+    void endShot(float avgFlowRate);   // Timer stopped
+    void annotateShot(const ShotSummary& analytics); // Add analytics once the yield settled (or at endShot)
+    bool isRecording() const { return recording; }
+
+    // Newest-first page of the index; returns entries written to out
+    size_t listShots(size_t offset, size_t limit, ShotIndexEntry* out, size_t& total);
+    static String curvePath(uint32_t id);
+
+    uint32_t getDroppedChunks() const { return droppedChunks; }
+    bool isReady() const { return queue != nullptr; }
+
+    static const char* INDEX_PATH;
+    static const char* INDEX_TMP_PATH; // Rewrite target while pruning
+    static const size_t MAX_SHOTS = 300;
+    static const size_t MIN_FREE_BYTES = 64 * 1024;
+    static const uint32_t MIN_SHOT_MS = 3000;     // Shorter timer runs are not logged
+
+private:
+    static const size_t CHUNK_SIZE = 240;
+    static const size_t MAX_POINT_BYTES = 15;     // Three 5-byte varints
+    static const size_t QUEUE_DEPTH = 8;
+
+    enum MessageType : uint8_t { MSG_OPEN, MSG_CHUNK, MSG_FINALIZE, MSG_ANNOTATE };
+
+    struct Message {
+        MessageType type;
+        bool damaged;              // A chunk of this shot was dropped
+        uint16_t length;
+        uint32_t shotId;
+        union {
+            uint8_t data[CHUNK_SIZE];
+            ShotIndexEntry summary;
+        };
+    };
+
+    QueueHandle_t queue;
+    TaskHandle_t writerTask;
+
+    // Encoder state (acquisition task only)
+    bool recording;
+    bool damaged;
+    uint32_t shotId;
+    uint32_t nextShotId;
+    uint32_t startUs;
+    uint32_t lastSequence;
+    uint32_t lastTimeMs;
+    int32_t lastWeightCg;
+    int32_t lastFlowCg;
+    uint32_t pointCount;
+    uint32_t encodedBytes;
+    float lastWeight;
+    float peakFlowRate;
+    bool annotationPending;         // Yield settled before the timer stopped - written by endShot()
+    uint32_t pendingFirstDropMs;
+    float pendingFlowStdDev;
+    float pendingYieldWeight;
+    uint8_t chunk[CHUNK_SIZE];
+    size_t chunkLength;
+    volatile uint32_t droppedChunks;
+
+    void putVarint(uint32_t value);
+    void putSigned(int32_t value);
+    void flushChunk();
+    bool send(Message& message);
+
+    // Writer task side
+    static void writerTaskFunc(void* param);
+    void handleMessage(const Message& message, File& file);
+    void appendIndex(const ShotIndexEntry& entry);
+    void updateLastEntry(const ShotIndexEntry& analytics);
+    bool pruneOldest(); // False when the index could not be rewritten
+    uint32_t readLastShotId();
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TASKMONITOR_H
+#define TASKMONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/*
+ * Registry of the firmware's own tasks with stack watermarks and CPU share.
+ * Each task reports how long its work took per cycle (blocked time is not
+ * counted), and sample() turns that into a busy percentage once per second.
+ * When FreeRTOS run-time stats are compiled in, /api/tasks additionally lists
+ * every task in the system (WiFi, BLE host, idle...).
+ */
+class TaskMonitor {
+public:
+    TaskMonitor();
+
+    // Create a pinned task and register it; returns the monitor id (-1 on failure)
+    int start(TaskFunction_t function, const char* name, uint32_t stackBytes,
+              UBaseType_t priority, BaseType_t core);
+
+    void addBusy(int id, uint32_t busyUs); // Called by the task after each work cycle
+    void sample();                         // Once per second - closes the CPU share window
+
+    String toJson() const;
+
+    static const size_t MAX_TASKS = 6;
+
+private:
+    struct Entry {
+        const char* name;
+        TaskHandle_t handle;
+        uint32_t stackBytes;
+        UBaseType_t priority;
+        BaseType_t core;
+        volatile uint32_t busyUs;   // Accumulated in the current window
+        volatile uint32_t cycles;
+        float cpuPercent;           // Share of one core over the last window
+        uint32_t cyclesPerSecond;
+        uint32_t maxCycleUs;        // Longest single work cycle since boot
+    };
+
+    Entry entries[MAX_TASKS];
+    size_t count;
+    uint32_t windowStartUs;
+};
+
+#endif
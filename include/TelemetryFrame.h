@@ -0,0 +1,74 @@
+#ifndef TELEMETRYFRAME_H
+#define TELEMETRYFRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Scale;    // Forward declaration
+class FlowRate; // Forward declaration
+class Display;  // Forward declaration
+
+// Flag bits carried in every telemetry frame
+enum TelemetryFlags : uint8_t {
+    TELEMETRY_FLAG_RAW           = 0x01, // Per-cell raw ADC values appended
+    TELEMETRY_FLAG_BREWING       = 0x02, // Scale filter is in BREWING/TRANSITIONING state
+    TELEMETRY_FLAG_TIMER_RUNNING = 0x04, // Shot timer is running
+    TELEMETRY_FLAG_SCALE_OK      = 0x08, // HX711 connected and delivering readings
+    TELEMETRY_FLAG_DUAL_HX711    = 0x10  // Weight is the sum of two load cells
+};
+
+// One filtered scale sample, as shared by every streaming transport
+struct TelemetrySample {
+    uint32_t sequence = 0;     // Increments once per filtered sample
+    uint32_t timestampUs = 0;  // Capture time in micros() (wraps every ~71 minutes)
+    float weight = 0.0f;       // Grams
+    float flowRate = 0.0f;     // Grams per second
+    uint8_t flags = 0;         // TelemetryFlags
+    int32_t raw1 = 0;          // Raw ADC value cell 1 (valid with TELEMETRY_FLAG_RAW)
+    int32_t raw2 = 0;          // Raw ADC value cell 2 (valid with TELEMETRY_FLAG_RAW)
+};
+
+/*
+ * Versioned, fixed-layout binary telemetry frame. All fields little-endian,
+ * so on the ESP32 and most controllers decoding is a plain memcpy.
+ *
+ * Offset Size Field
+ *   0     1   version (currently 1)
+ *   1     1   flags (TelemetryFlags)
+ *   2     2   frame length in bytes (20, or 28 with TELEMETRY_FLAG_RAW)
+ *   4     4   sequence number
+ *   8     4   capture timestamp, microseconds since boot
+ *  12     4   weight, float32 grams
+ *  16     4   flow rate, float32 g/s
+ *  20     4   raw cell 1, int32       (only with TELEMETRY_FLAG_RAW)
+ *  24     4   raw cell 2, int32       (only with TELEMETRY_FLAG_RAW)
+ *
+ * The base frame fits a single BLE notification at the default ATT MTU.
+ * Decoders must use the length field to skip fields added by later versions.
+ */
+class TelemetryFrame {
+public:
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t BASE_SIZE = 20;
+    static constexpr size_t RAW_SIZE = 28;
+    static constexpr size_t MAX_SIZE = RAW_SIZE;
+
+    // Returns the number of bytes written, 0 if the buffer is too small
+    static size_t encode(const TelemetrySample& sample, uint8_t* buffer, size_t capacity);
+
+    // Returns false for truncated frames or unknown versions
+    static bool decode(const uint8_t* buffer, size_t length, TelemetrySample& sample);
+
+    // Snapshot the latest filtered sample from the running subsystems
+    static TelemetrySample capture(Scale& scale, FlowRate* flowRate, Display* display, bool includeRaw);
+
+private:
+    static void putU16(uint8_t* p, uint16_t v);
+    static void putU32(uint8_t* p, uint32_t v);
+    static void putFloat(uint8_t* p, float v);
+    static uint16_t getU16(const uint8_t* p);
+    static uint32_t getU32(const uint8_t* p);
+    static float getFloat(const uint8_t* p);
+};
+
+#endif
@@ -2,46 +2,41 @@
 #define TOUCHSENSOR_H
 
 #include <Arduino.h>
+#include "InputEngine.h"
 
-class Scale; // Forward declaration
 class Display; // Forward declaration
-class FlowRate; // Forward declaration
 
-class TouchSensor {
+class TouchSensor : public InputListener {
 public:
-    TouchSensor(uint8_t touchPin, Scale* scale);
+    TouchSensor(uint8_t touchPin);
     void begin();
-    void update();
+    void update(); // Delayed tare - gestures arrive from the input engine
+    void onInputGesture(InputPad pad, InputGesture gesture, uint32_t heldMs) override;
     void setTouchThreshold(uint16_t threshold);
     uint16_t getTouchValue();
     bool isTouched();
     void setDisplay(Display* display); // Set display reference
-    void setFlowRate(FlowRate* flowRate); // Set flow rate reference
     
 private:
     uint8_t touchPin;
-    Scale* scalePtr;
     Display* displayPtr;
-    FlowRate* flowRatePtr;
     uint16_t touchThreshold;
-    bool lastTouchState;
-    unsigned long lastTouchTime;
-    unsigned long touchStartTime;
-    unsigned long debounceDelay;
-    bool longPressDetected;
     
     // Delayed tare functionality for mounted touch sensors
     bool delayedTarePending;
     unsigned long delayedTareTime;
     static const unsigned long TARE_DELAY = 1500; // 1.5 seconds delay after touch release
+    static const unsigned long STATUS_PAGE_DURATION = 500; // Medium press - status page toggle
     static const unsigned long WIFI_TOGGLE_DURATION = 5000; // 5 seconds for WiFi toggle (longer than status page)
+    static const unsigned long DOUBLE_TAP_WINDOW = 600; // Second short tap within this - profile switch instead of tare
+    unsigned long lastTapTime;
     
     void handleTouch();
     void scheduleDelayedTare();
     void checkDelayedTare();
-    void handleLongPress();
     void handleStatusPageToggle(); // Handle status page toggle on medium press
     void handleWiFiToggle(); // Handle WiFi toggle on long press (5 seconds)
+    void handleProfileCycle(); // Double tap - next performance profile
 };
 
 #endif
@@ -0,0 +1,46 @@
+#ifndef ULPWAKE_H
+#define ULPWAKE_H
+
+#include <Arduino.h>
+
+class Scale; // Forward declaration
+
+/*
+ * Weight-change wake from deep sleep. Before sleeping, the ULP RISC-V
+ * program (ulp/main.c) is loaded and started on the ULP timer. It powers
+ * the HX711s up once per check period, compares the reading against a
+ * baseline it takes itself, and wakes the main cores when a cup lands on (or
+ * leaves) the scale. EXT0 on the sleep pad stays armed next to it.
+ *
+ * Needs the ULP binary, which only the ESP-IDF ULP toolchain builds, so it
+ * is compiled in with -DWMB_ULP_WAKE only - the esp32s3-supermini-ulp
+ * environment (arduino + espidf, ulp_embed_binary in src/CMakeLists.txt).
+ * Otherwise arm() returns false and sleep wakes on the pad alone.
+ *
+ * Each check keeps the HX711s and their bridges powered for the first
+ * conversion after power-up (~400ms at 10SPS), so the check period sets the
+ * sleep current: 40% duty at 1s, ~13% at the 3s default. It is stored in
+ * NVS and set through POST /api/acquisition; a cup is noticed within
+ * CONFIRM_READS periods.
+ */
+class UlpWake {
+public:
+    static void setPins(uint8_t dataPin1, uint8_t dataPin2, uint8_t clockPin);
+    static bool arm(const Scale& scale); // Right before esp_deep_sleep_start()
+    static bool wokeOnWeight();          // This boot was the ULP's wake request
+    static void releasePins();           // Stop the ULP and hand the HX711 pins back - before the scale starts
+    static bool isAvailable();           // Built with the ULP program
+
+    static uint32_t getCheckPeriodMs();
+    static bool setCheckPeriodMs(uint32_t periodMs); // Persisted - false when out of range
+
+    static constexpr float WAKE_THRESHOLD_G = 20.0f; // Well below a cup, well above drift
+    static const uint32_t DEFAULT_CHECK_PERIOD_MS = 3000;
+    static const uint32_t MIN_CHECK_PERIOD_MS = 1000;
+    static const uint32_t MAX_CHECK_PERIOD_MS = 30000;
+    static const uint32_t CONFIRM_READS = 2;         // A knock is a single reading
+    static const uint32_t DRIFT_SHIFT = 4;
+    static const uint32_t READY_TIMEOUT_MS = 600;    // HX711 settles in ~400ms at 10SPS after power-up
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef ULPWAKELOGIC_H
+#define ULPWAKELOGIC_H
+
+/*
+ * HX711 bit-bang and weight-change decision shared by the ULP RISC-V wake
+ * program (ulp/main.c) and the main firmware. Plain C with no SDK
+ * dependencies: the pins are reached through UlpHx711Io, so the same code
+ * runs against the ULP GPIO driver or a simulated HX711 on the host.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pin access for one shared clock and up to two data lines
+typedef struct {
+    void (*setClock)(void* ctx, int level);
+    int (*readData)(void* ctx, int channel); // channel 0 or 1
+    void (*delayUs)(void* ctx, uint32_t us);
+    void* ctx;
+} UlpHx711Io;
+
+// Written by the main CPU before deep sleep, read-only for the ULP
+typedef struct {
+    int32_t thresholdCounts; // Change from the baseline that counts as a cup (grams * counts per gram)
+    uint32_t confirmReads;   // Consecutive readings past the threshold before waking
+    uint32_t driftShift;     // Baseline follows slow drift by 1/2^n of the difference per reading
+    uint32_t readyTimeoutMs; // Power-up settling allowance before a reading is given up
+    uint32_t dual;           // Sum both data lines
+} UlpWakeConfig;
+
+// Owned by the ULP between runs (RTC slow memory)
+typedef struct {
+    int32_t baseline;
+    uint32_t haveBaseline;
+    uint32_t confirmCount;
+    int32_t lastReading;
+    uint32_t checks;
+    uint32_t timeouts;
+} UlpWakeState;
+
+#define ULP_HX711_CLOCK_HIGH_US 1
+#define ULP_HX711_POWER_DOWN_US 80 // > 60us clock high powers the HX711 down
+
+static inline void ulp_hx711_power_down(const UlpHx711Io* io) {
+    io->setClock(io->ctx, 1);
+    io->delayUs(io->ctx, ULP_HX711_POWER_DOWN_US);
+}
+
+// Clock low powers the HX711 up; DOUT goes low once the first conversion is ready
+static inline int ulp_hx711_wait_ready(const UlpHx711Io* io, int dual, uint32_t timeoutMs) {
+    io->setClock(io->ctx, 0);
+    for (uint32_t waitedMs = 0; waitedMs <= timeoutMs; waitedMs++) {
+        int ready = io->readData(io->ctx, 0) == 0;
+        if (dual) {
+            ready = ready && io->readData(io->ctx, 1) == 0;
+        }
+        if (ready) {
+            return 1;
+        }
+        io->delayUs(io->ctx, 1000);
+    }
+    return 0;
+}
+
+// 24 data bits MSB first on both lines, then one more pulse selects channel A gain 128
+static inline void ulp_hx711_read(const UlpHx711Io* io, int dual, int32_t out[2]) {
+    uint32_t raw0 = 0;
+    uint32_t raw1 = 0;
+    for (int bit = 0; bit < 24; bit++) {
+        io->setClock(io->ctx, 1);
+        io->delayUs(io->ctx, ULP_HX711_CLOCK_HIGH_US);
+        raw0 = (raw0 << 1) | (io->readData(io->ctx, 0) ? 1u : 0u);
+        if (dual) {
+            raw1 = (raw1 << 1) | (io->readData(io->ctx, 1) ? 1u : 0u);
+        }
+        io->setClock(io->ctx, 0);
+        io->delayUs(io->ctx, ULP_HX711_CLOCK_HIGH_US);
+    }
+    io->setClock(io->ctx, 1);
+    io->delayUs(io->ctx, ULP_HX711_CLOCK_HIGH_US);
+    io->setClock(io->ctx, 0);
+
+    // Sign-extend the 24-bit two's complement values
+    out[0] = (int32_t)(raw0 << 8) >> 8;
+    out[1] = dual ? (int32_t)(raw1 << 8) >> 8 : 0;
+}
+
+// One check: power up, read, power down. Returns 0 (and sets *reading) or -1 on a timeout
+static inline int ulp_hx711_sample(const UlpHx711Io* io, const UlpWakeConfig* config, int32_t* reading) {
+    int32_t raw[2];
+    if (!ulp_hx711_wait_ready(io, (int)config->dual, config->readyTimeoutMs)) {
+        ulp_hx711_power_down(io);
+        return -1;
+    }
+    ulp_hx711_read(io, (int)config->dual, raw);
+    ulp_hx711_power_down(io);
+    *reading = raw[0] + raw[1];
+    return 0;
+}
+
+// Returns 1 when the reading is a meaningful change from the baseline. The
+// first reading after sleep becomes the baseline, and small differences are
+// folded in so temperature drift never adds up to a wake
+static inline int ulp_wake_check(UlpWakeState* state, const UlpWakeConfig* config, int32_t reading) {
+    state->checks++;
+    state->lastReading = reading;
+
+    if (!state->haveBaseline) {
+        state->baseline = reading;
+        state->haveBaseline = 1;
+        state->confirmCount = 0;
+        return 0;
+    }
+
+    int32_t delta = reading - state->baseline;
+    int32_t magnitude = delta < 0 ? -delta : delta;
+    if (magnitude >= config->thresholdCounts) {
+        state->confirmCount++;
+        if (state->confirmCount >= config->confirmReads) {
+            state->confirmCount = 0;
+            return 1;
+        }
+        return 0;
+    }
+
+    state->confirmCount = 0;
+    state->baseline += delta / (int32_t)(1u << config->driftShift);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef VIBRATIONFILTER_H
+#define VIBRATIONFILTER_H
+
+#include <Arduino.h>
+
+// esp-dsp ships with the ESP32-S3 Arduino core; other builds use the portable FFT
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && __has_include(<esp_dsp.h>)
+#define WMB_HAS_ESP_DSP 1
+#else
+#define WMB_HAS_ESP_DSP 0
+#endif
+
+/*
+ * Removes pump vibration from the raw weight before the median/average stages.
+ *
+ * Vibratory pumps shake the load cells at 50/60 Hz and harmonics, which the
+ * HX711 sample rate aliases down to a fixed tone somewhere below Nyquist.
+ * While brewing, a 128 point FFT over the latest raw samples looks for a
+ * dominant tone; when one stands clearly above the rest of the spectrum a
+ * biquad notch is centred on it. The notch has unity gain at DC, so the
+ * weight itself passes unchanged.
+ */
+class VibrationFilter {
+public:
+    VibrationFilter();
+    bool begin(); // Allocate the sample window (PSRAM when available)
+
+    // Filter one raw reading; track=true while brewing to track the tone
+    float process(float reading, uint32_t timestampUs, bool track);
+    void reset(float value); // Settle the notch on value (after jumps or tare)
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    bool isLocked() const { return locked; }
+    float getNotchFrequency() const { return notchHz; }  // Hz, 0 when not locked
+    float getSampleRate() const { return sampleRateHz; } // Estimated HX711 rate
+    float getPeakRatio() const { return peakRatio; }     // Tone power / mean power of the last analysis
+    uint32_t getAnalysisMicros() const { return analysisMicros; } // Cost of the last FFT pass
+
+    static const size_t FFT_SIZE = 128;
+    static const size_t HOP_SIZE = 64;  // Analyse every 64 new samples (50% overlap)
+
+private:
+    bool enabled;
+    float* window;         // Ring of raw readings, FFT_SIZE long
+    size_t windowHead;
+    size_t windowCount;
+    size_t samplesSinceAnalysis;
+    uint32_t lastTimestampUs;
+    float sampleRateHz;
+
+    // Notch (transposed direct form II, coefficients normalised by a0)
+    bool locked;
+    float notchHz;
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+    uint8_t missedAnalyses;
+    float peakRatio;
+    uint32_t analysisMicros;
+
+    static constexpr float MIN_TONE_HZ = 2.0f;     // Below this it is the pour, not the pump
+    static constexpr float LOCK_RATIO = 8.0f;      // Tone power vs mean spectral power
+    static constexpr float NOTCH_Q = 4.0f;         // Wide enough to follow aliasing drift
+    static const uint8_t UNLOCK_AFTER_MISSES = 3;
+
+    void analyse();
+    void setNotch(float frequencyHz);
+    void settle(float value);
+    static void fft(float* data, size_t n); // Interleaved complex, in place
+};
+
+#endif
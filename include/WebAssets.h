@@ -0,0 +1,21 @@
+#ifndef WEBASSETS_H
+#define WEBASSETS_H
+
+#include <Arduino.h>
+
+// Web UI file compiled into the firmware image (EMBED_WEB_ASSETS builds).
+// The data pointer refers to gzip-compressed bytes in memory-mapped flash.
+struct EmbeddedAsset {
+    const char* path;         // URL path, e.g. "/index.html"
+    const char* contentType;  // MIME type of the uncompressed file
+    const char* etag;         // Quoted content hash for conditional requests
+    const uint8_t* data;      // Gzip-compressed content
+    size_t length;            // Compressed length in bytes
+};
+
+bool webAssetsEmbedded();                              // True when the UI is part of the firmware
+const EmbeddedAsset* findEmbeddedAsset(const String& path); // nullptr if not embedded / not found
+size_t getEmbeddedAssetCount();
+size_t getEmbeddedAssetBytes();
+
+#endif
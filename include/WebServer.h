@@ -7,10 +7,28 @@
 #include "Display.h"
 #include "BatteryMonitor.h"
 
+class WeightHistory; // Forward declaration
+class ShotLog; // Forward declaration
+class ShotAnalytics; // Forward declaration
+class AutoTimer; // Forward declaration
+class PourSegmenter; // Forward declaration
+class SampleBus; // Forward declaration
+class TaskMonitor; // Forward declaration
+
 extern float calibrationFactor;
 
+void setWeightHistory(WeightHistory* history); // Call before setupWebServer for /api/history
+void setShotLog(ShotLog* shotLog); // Call before setupWebServer for /api/shots
+void setShotAnalytics(ShotAnalytics* analytics); // Call before setupWebServer for shot events
+void setAutoTimer(AutoTimer* autoTimer); // Call before setupWebServer for /api/auto-timer
+void setPourSegmenter(PourSegmenter* segmenter); // Call before setupWebServer for /api/pour-over
+void setSampleBus(SampleBus* bus); // Source of /ws telemetry frames
+void setTaskMonitor(TaskMonitor* monitor); // Call before setupWebServer for /api/tasks
 void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery);
 void startWebServer();
 void stopWebServer();
+void updateWebTelemetry(); // Push new telemetry frames to WebSocket clients
+bool isWebServerActive(); // /ws clients connected or an HTTP request in the last few seconds
+bool isWebHeavy(); // Page assets or history/shot downloads streaming, or finished in the last few seconds
 
 #endif
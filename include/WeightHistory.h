@@ -0,0 +1,83 @@
+#ifndef WEIGHTHISTORY_H
+#define WEIGHTHISTORY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "TelemetryFrame.h"
+
+// One stored history point (16 bytes)
+struct HistoryPoint {
+    uint32_t sequence;  // Scale sample sequence number
+    uint32_t timeMs;    // Milliseconds since the shot (buffer) started
+    float weight;       // Filtered weight in grams
+    float flowRate;     // Flow rate in g/s
+};
+
+// Summary returned alongside a history query
+struct HistoryQueryInfo {
+    uint32_t shotId = 0;       // 0 = samples recorded before the first shot
+    uint32_t latestSequence = 0; // Cursor for the next ?since= request
+    size_t available = 0;      // Points newer than the cursor
+    size_t returned = 0;       // Points written to the output
+    size_t buffered = 0;       // Points held for this shot
+    bool downsampled = false;  // True when LTTB reduced the point count
+};
+
+/*
+ * Full-rate history of filtered weight and flow for the current and the
+ * previous shot. A new shot starts whenever the timer is started from zero;
+ * the running shot then becomes the previous one.
+ *
+ * Both buffers are rings, so a shot that outlasts the capacity keeps its most
+ * recent part. Buffers live in PSRAM when the board has it.
+ */
+class WeightHistory {
+public:
+    WeightHistory();
+    bool begin();
+
+    // Store a sample; duplicate sequence numbers are ignored
+    void record(const TelemetrySample& sample);
+
+    // Rotate current -> previous and start recording a new shot at startUs (micros())
+    void beginShot(uint32_t startUs);
+
+    // Copy points with sequence > since into out (at most maxPoints).
+    // Larger ranges are reduced with largest-triangle-three-buckets.
+    size_t query(bool previousShot, uint32_t since, size_t maxPoints,
+                 HistoryPoint* out, HistoryQueryInfo& info);
+
+    size_t getCapacity() const { return capacity; }
+    bool isInPSRAM() const { return usingPSRAM; }
+    bool isReady() const { return buffers[0].points != nullptr; }
+
+    static const size_t PSRAM_CAPACITY = 8192; // ~160s at 50Hz per shot
+    static const size_t HEAP_CAPACITY = 1536;  // ~30s at 50Hz per shot
+
+private:
+    struct ShotBuffer {
+        HistoryPoint* points;
+        size_t head;       // Index of the oldest point
+        size_t count;
+        uint32_t shotId;
+        uint32_t startUs;
+        bool started;      // startUs valid
+    };
+
+    ShotBuffer buffers[2];
+    ShotBuffer* current;
+    ShotBuffer* previous;
+    size_t capacity;
+    bool usingPSRAM;
+    uint32_t nextShotId;
+    uint32_t lastSequence;
+    SemaphoreHandle_t mutex;
+
+    const HistoryPoint& at(const ShotBuffer& buffer, size_t index) const;
+    size_t firstAfter(const ShotBuffer& buffer, uint32_t since) const;
+    size_t downsampleLTTB(const ShotBuffer& buffer, size_t first, size_t count,
+                          HistoryPoint* out, size_t maxPoints) const;
+};
+
+#endif
@@ -9,7 +9,30 @@
 // Set to true to enable maximum power mode for boards with poor antenna design
 #define ENABLE_SUPERMINI_ANTENNA_FIX true
 
-void setupWiFi();
+// Connection state machine (advanced by maintainWiFi(), never blocks)
+enum class WiFiState : uint8_t {
+    OFF,               // Disabled for battery saving
+    STA_CONNECTING,    // Associating with stored credentials (boot, new credentials, enable)
+    STA_CONNECTED,     // Got an IP on the home network
+    STA_RECONNECTING,  // Connection lost - short retry before falling back to AP
+    AP_ACTIVE          // Configuration access point 'WeighMyBru-AP'
+};
+
+// Last successful association, kept in NVS for directed (scan-free) reconnects
+struct WiFiAssociation {
+    char ssid[33];
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool valid;
+    uint32_t ip;       // DHCP lease, reused on a directed attempt after deep sleep until its renewal time
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint32_t leaseObtainedS; // time() when DHCP handed out the address (runs on through deep sleep)
+    uint32_t leaseRenewS;    // DHCP renewal time (T1) - the address is not reused past it
+};
+
+void setupWiFi(); // Starts the first connection attempt and returns at once
 void saveWiFiCredentials(const char* ssid, const char* password);
 void clearWiFiCredentials(); // Clear stored WiFi credentials
 void loadWiFiCredentials(char* ssid, char* password, size_t maxLen);
@@ -18,9 +41,17 @@ String getStoredSSID();
 String getStoredPassword();
 void setupmDNS(); // Setup mDNS for weighmybru.local hostname
 void printWiFiStatus(); // Print detailed WiFi status for debugging
-void maintainWiFi(); // Periodic WiFi maintenance to ensure AP stability
-bool attemptSTAConnection(const char* ssid, const char* password); // Attempt STA connection and switch from AP mode
-void switchToAPMode(); // Switch back to AP mode if STA connection fails
+void maintainWiFi(); // Runs the state machine and pending requests - call every ~100ms from one task
+bool attemptSTAConnection(const char* ssid, const char* password); // Request STA connection (non-blocking, falls back to AP)
+void switchToAPMode(); // Request a switch back to AP mode
+WiFiState getWiFiState();
+bool getWiFiAssociation(WiFiAssociation& association); // Returns false when nothing is cached
+void invalidateWiFiAssociation(); // Next connect does a full scan + DHCP
+bool getStaticIPConfig(IPAddress& ip, IPAddress& gateway, IPAddress& subnet, IPAddress& dns); // Returns enabled
+void saveStaticIPConfig(bool enabled, IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns);
+uint32_t getLastConnectTimeMs(); // Start of the attempt to GOT_IP, 0 before the first connect
+const char* getLastConnectMethod(); // "cached", "scan" (+"+static"), "none"
+const char* getWiFiStateName(); // "off", "connecting", "connected", "reconnecting", "ap"
 void applySuperMiniAntennaFix(); // Apply maximum power settings for problematic SuperMini boards
 int getWiFiSignalStrength(); // Get current WiFi signal strength in dBm
 String getWiFiSignalQuality(); // Get WiFi signal quality description
@@ -28,10 +59,16 @@ String getWiFiConnectionInfo(); // Get detailed WiFi connection information
 
 // WiFi Power Management
 bool isWiFiEnabled(); // Check if WiFi is currently enabled
-void enableWiFi(); // Enable WiFi and restore previous mode
-void disableWiFi(); // Disable WiFi completely to save battery
+void enableWiFi(); // Enable WiFi and restore previous mode (executed by maintainWiFi())
+void disableWiFi(); // Disable WiFi completely to save battery (executed by maintainWiFi())
 void toggleWiFi(); // Toggle WiFi on/off
 bool loadWiFiEnabledState(); // Load WiFi enabled state from preferences
 void saveWiFiEnabledState(bool enabled); // Save WiFi enabled state to preferences
+void setWiFiPowerSave(wifi_ps_type_t type, bool latencyBoost); // Base modem sleep level from the performance profile (applied by maintainWiFi())
+void setWiFiLatencyDemand(bool clients, bool shot); // Streaming/polling clients or a running shot - lifts modem sleep while set
+wifi_ps_type_t getWiFiPowerSave(); // Level in effect - NONE is refused while BLE runs
+void recordWiFiRoundTrip(uint32_t rttMs, wifi_ps_type_t sentLevel); // WebSocket ping round trip, binned by level (dropped if it changed in flight)
+String getWiFiPowerSaveJson(); // Levels, time per level and round-trip statistics for /api/wifi-power
+void resetWiFiRoundTrips();
 
 #endif
@@ -0,0 +1,111 @@
+# PlatformIO pre-build script: embed the web UI (data/) into the firmware image
+#
+# Only active when the environment defines EMBED_WEB_ASSETS. Every non-empty file
+# below data/ is gzip-compressed and emitted as a const byte array into
+# $BUILD_DIR/generated/WebAssetsData.h. Const arrays end up in .rodata, which the
+# ESP32 maps straight from flash, so the web server can stream them without a
+# filesystem mount or a RAM copy.
+
+import gzip
+import hashlib
+import os
+
+Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".woff": "font/woff",
+    ".woff2": "font/woff2",
+}
+
+
+def embed_enabled(environment):
+    # build_flags are not merged into CPPDEFINES yet when pre: scripts run
+    flags = environment.ParseFlags(environment.get("BUILD_FLAGS", []))
+    for define in flags.get("CPPDEFINES", []):
+        name = define[0] if isinstance(define, (list, tuple)) else define
+        if name == "EMBED_WEB_ASSETS":
+            return True
+    return False
+
+
+def collect_assets(data_dir):
+    assets = []
+    for root, _dirs, files in os.walk(data_dir):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            if os.path.getsize(path) == 0:
+                continue  # Placeholder files (e.g. empty tailwind.config.js)
+            url = "/" + os.path.relpath(path, data_dir).replace(os.sep, "/")
+            assets.append((url, path))
+    return sorted(assets)
+
+
+def generate_header(assets, header_path):
+    lines = [
+        "// Generated by scripts/embed_web_assets.py - do not edit",
+        "#pragma once",
+        "",
+        "#include \"WebAssets.h\"",
+        "",
+    ]
+    table = []
+    total_raw = 0
+    total_gz = 0
+
+    for index, (url, path) in enumerate(assets):
+        with open(path, "rb") as f:
+            raw = f.read()
+        # mtime=0 keeps the output byte-identical between builds
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+        mime = MIME_TYPES.get(os.path.splitext(path)[1].lower(), "application/octet-stream")
+        total_raw += len(raw)
+        total_gz += len(packed)
+
+        symbol = "WEB_ASSET_%d" % index
+        lines.append("// %s (%d -> %d bytes)" % (url, len(raw), len(packed)))
+        lines.append("static const uint8_t %s[] = {" % symbol)
+        for offset in range(0, len(packed), 20):
+            chunk = packed[offset:offset + 20]
+            lines.append("  " + ",".join("0x%02x" % b for b in chunk) + ",")
+        lines.append("};")
+        lines.append("")
+        table.append('  {"%s", "%s", "\\"%s\\"", %s, sizeof(%s)},' % (url, mime, etag, symbol, symbol))
+
+    lines.append("static const EmbeddedAsset EMBEDDED_WEB_ASSETS[] = {")
+    lines.extend(table)
+    lines.append("};")
+    lines.append("")
+    lines.append("static const size_t EMBEDDED_WEB_ASSET_COUNT = %d;" % len(assets))
+    lines.append("static const size_t EMBEDDED_WEB_ASSET_BYTES = %d;" % total_gz)
+    lines.append("")
+
+    content = "\n".join(lines)
+    # Only rewrite when the content changed so incremental builds stay incremental
+    if os.path.exists(header_path):
+        with open(header_path, "r") as f:
+            if f.read() == content:
+                return total_raw, total_gz
+    with open(header_path, "w") as f:
+        f.write(content)
+    return total_raw, total_gz
+
+
+if embed_enabled(env):  # noqa: F821
+    data_dir = os.path.join(env.subst("$PROJECT_DIR"), "data")  # noqa: F821
+    gen_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")  # noqa: F821
+    os.makedirs(gen_dir, exist_ok=True)
+
+    assets = collect_assets(data_dir)
+    raw_size, gz_size = generate_header(assets, os.path.join(gen_dir, "WebAssetsData.h"))
+    print("Embedded web assets: %d files, %d bytes -> %d bytes gzip" % (len(assets), raw_size, gz_size))
+
+    env.Append(CPPPATH=[gen_dir])  # noqa: F821
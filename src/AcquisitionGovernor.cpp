@@ -0,0 +1,166 @@
+#include "AcquisitionGovernor.h"
+#include "UlpWake.h"
+
+// Energy model per HX711 channel while powered: the chip itself plus the
+// excitation of a 1k bridge from its ~4.3V AVDD regulator. Power-down cuts both.
+static const float HX711_ACTIVE_MA = 1.5f;
+static const float BRIDGE_EXCITATION_MA = 4.3f;
+static const float HX711_POWER_DOWN_MA = 0.001f;
+static const uint32_t HX711_SETTLE_MS = 400; // Power-up to first conversion at 10SPS, until measured
+
+AcquisitionGovernor::AcquisitionGovernor()
+    : mode(AcquisitionMode::FULL), modeSinceMs(0), lastActivityMs(0), fullResumes(0), pinned(false),
+      poweredDown(false), waking(false), powerChangeMs(0), poweredOffTotalMs(0),
+      wakeCount(0), lastWakeLatencyMs(0), maxWakeLatencyMs(0), totalWakeLatencyMs(0),
+      chipCount(1) {
+    for (int i = 0; i < 3; i++) {
+        modeTotalMs[i] = 0;
+    }
+}
+
+void AcquisitionGovernor::onSample(bool active, unsigned long nowMs) {
+    if (pinned) {
+        lastActivityMs = nowMs;
+        return;
+    }
+    if (active) {
+        lastActivityMs = nowMs;
+        if (mode != AcquisitionMode::FULL) {
+            fullResumes++;
+            enterMode(AcquisitionMode::FULL, nowMs);
+        }
+        return;
+    }
+
+    unsigned long quietMs = nowMs - lastActivityMs;
+    if (mode == AcquisitionMode::FULL && quietMs >= REDUCE_AFTER_MS) {
+        enterMode(AcquisitionMode::REDUCED, nowMs);
+    } else if (mode == AcquisitionMode::REDUCED && quietMs >= SPARSE_AFTER_MS) {
+        enterMode(AcquisitionMode::SPARSE, nowMs);
+    }
+}
+
+void AcquisitionGovernor::wake(unsigned long nowMs) {
+    lastActivityMs = nowMs;
+    if (mode != AcquisitionMode::FULL) {
+        enterMode(AcquisitionMode::FULL, nowMs);
+    }
+}
+
+void AcquisitionGovernor::setPinned(bool pin, unsigned long nowMs) {
+    pinned = pin;
+    if (pinned) {
+        wake(nowMs);
+    }
+}
+
+void AcquisitionGovernor::enterMode(AcquisitionMode next, unsigned long nowMs) {
+    modeTotalMs[(int)mode] += nowMs - modeSinceMs;
+    Serial.printf("Acquisition: %s -> %s\n", modeName(mode), modeName(next));
+    mode = next;
+    modeSinceMs = nowMs;
+}
+
+uint32_t AcquisitionGovernor::readIntervalMs() const {
+    if (waking) {
+        return FULL_INTERVAL_MS; // Poll for the first conversion after power-up
+    }
+    switch (mode) {
+        case AcquisitionMode::REDUCED: return REDUCED_INTERVAL_MS;
+        case AcquisitionMode::SPARSE: return SPARSE_INTERVAL_MS;
+        default: return FULL_INTERVAL_MS;
+    }
+}
+
+int AcquisitionGovernor::stableAverageSamples(int configured, int maxSamples) const {
+    if (mode == AcquisitionMode::FULL) {
+        return configured;
+    }
+    // Fewer, slower samples - average over more of them for the same noise floor
+    int samples = configured * 3;
+    return samples > maxSamples ? maxSamples : samples;
+}
+
+void AcquisitionGovernor::onPowerDown(unsigned long nowMs) {
+    if (poweredDown) return;
+    poweredDown = true;
+    waking = false;
+    powerChangeMs = nowMs;
+}
+
+void AcquisitionGovernor::onPowerUp(unsigned long nowMs) {
+    if (!poweredDown) return;
+    poweredOffTotalMs += nowMs - powerChangeMs;
+    poweredDown = false;
+    waking = true;
+    powerChangeMs = nowMs;
+}
+
+void AcquisitionGovernor::onFirstConversion(unsigned long nowMs) {
+    if (!waking) return;
+    waking = false;
+    lastWakeLatencyMs = nowMs - powerChangeMs;
+    if (lastWakeLatencyMs > maxWakeLatencyMs) {
+        maxWakeLatencyMs = lastWakeLatencyMs;
+    }
+    totalWakeLatencyMs += lastWakeLatencyMs;
+    wakeCount++;
+}
+
+unsigned long AcquisitionGovernor::elapsedIn(AcquisitionMode which, unsigned long nowMs) const {
+    unsigned long total = modeTotalMs[(int)which];
+    if (which == mode) {
+        total += nowMs - modeSinceMs;
+    }
+    return total;
+}
+
+const char* AcquisitionGovernor::modeName(AcquisitionMode mode) {
+    switch (mode) {
+        case AcquisitionMode::FULL: return "FULL";
+        case AcquisitionMode::REDUCED: return "REDUCED";
+        case AcquisitionMode::SPARSE: return "SPARSE";
+        default: return "UNKNOWN";
+    }
+}
+
+String AcquisitionGovernor::toJson() const {
+    unsigned long now = millis();
+    unsigned long offMs = poweredOffTotalMs + (poweredDown ? now - powerChangeMs : 0);
+    unsigned long uptimeMs = now > 0 ? now : 1;
+    float onFraction = 1.0f - (float)offMs / (float)uptimeMs;
+    // Average draw scaled by the powered fraction = mAh per hour of operation
+    float alwaysOnMa = (HX711_ACTIVE_MA + BRIDGE_EXCITATION_MA) * chipCount;
+    float mahPerHour = alwaysOnMa * onFraction;
+
+    // Deep sleep: with the ULP weight wake the HX711s are powered for one
+    // power-up latency per check, otherwise they stay powered down
+    float sleepMa = HX711_POWER_DOWN_MA * chipCount;
+    uint32_t checkPeriodMs = UlpWake::getCheckPeriodMs();
+    if (UlpWake::isAvailable()) {
+        uint32_t onMs = wakeCount ? (uint32_t)(totalWakeLatencyMs / wakeCount) : HX711_SETTLE_MS;
+        float duty = onMs < checkPeriodMs ? (float)onMs / checkPeriodMs : 1.0f;
+        sleepMa += alwaysOnMa * duty;
+    }
+
+    String json = "{\"mode\":\"" + String(modeName(mode)) + "\"";
+    json += ",\"interval_ms\":" + String(readIntervalMs());
+    json += ",\"pinned\":" + String(pinned ? "true" : "false");
+    json += ",\"powered_down\":" + String(poweredDown ? "true" : "false");
+    json += ",\"full_ms\":" + String(elapsedIn(AcquisitionMode::FULL, now));
+    json += ",\"reduced_ms\":" + String(elapsedIn(AcquisitionMode::REDUCED, now));
+    json += ",\"sparse_ms\":" + String(elapsedIn(AcquisitionMode::SPARSE, now));
+    json += ",\"full_resumes\":" + String(fullResumes);
+    json += ",\"wakes\":" + String(wakeCount);
+    json += ",\"wake_latency_ms\":{\"last\":" + String(lastWakeLatencyMs);
+    json += ",\"avg\":" + String(wakeCount ? (uint32_t)(totalWakeLatencyMs / wakeCount) : 0);
+    json += ",\"max\":" + String(maxWakeLatencyMs) + "}";
+    json += ",\"hx711_on_fraction\":" + String(onFraction, 3);
+    json += ",\"hx711_mah_per_hour\":" + String(mahPerHour, 2);
+    json += ",\"hx711_mah_per_hour_always_on\":" + String(alwaysOnMa, 2);
+    json += ",\"sleep\":{\"weight_wake\":" + String(UlpWake::isAvailable() ? "true" : "false");
+    json += ",\"check_period_ms\":" + String(checkPeriodMs);
+    json += ",\"hx711_ma\":" + String(sleepMa, 3) + "}";
+    json += "}";
+    return json;
+}
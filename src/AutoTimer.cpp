@@ -0,0 +1,142 @@
+#include "AutoTimer.h"
+#include "Display.h"
+#include "FlowRate.h"
+
+AutoTimer::AutoTimer(Display* display, FlowRate* flowRate)
+    : displayPtr(display), flowRatePtr(flowRate), enabled(false), ringHead(0), ringCount(0),
+      replayStart(0), replayLength(0), startCandidates(0), sawFlow(false), lowFlow(false),
+      lowFlowSinceUs(0), lastSequence(0) {}
+
+void AutoTimer::begin() {
+    preferences.begin("timer", true);
+    enabled = preferences.getBool("auto", false);
+    preferences.end();
+    Serial.printf("AutoTimer: %s\n", enabled ? "enabled" : "disabled");
+}
+
+void AutoTimer::setEnabled(bool value) {
+    enabled = value;
+    startCandidates = 0;
+    sawFlow = false;
+    lowFlow = false;
+
+    preferences.begin("timer", false);
+    preferences.putBool("auto", enabled);
+    preferences.end();
+    Serial.printf("AutoTimer: %s\n", enabled ? "enabled" : "disabled");
+}
+
+bool AutoTimer::update(const TelemetrySample& sample) {
+    replayLength = 0;
+    if (displayPtr == nullptr || sample.sequence == lastSequence) {
+        return false;
+    }
+    lastSequence = sample.sequence;
+
+    // Always keep the ring warm so enabling mid-session works immediately
+    ring[ringHead] = sample;
+    ringHead = (ringHead + 1) % PRETRIGGER_SAMPLES;
+    if (ringCount < PRETRIGGER_SAMPLES) ringCount++;
+
+    if (!enabled) {
+        return false;
+    }
+
+    bool running = displayPtr->isTimerRunning();
+    bool atZero = !running && displayPtr->getElapsedTime() == 0;
+
+    if (atZero) {
+        sawFlow = false;
+        lowFlow = false;
+        return checkStart(sample);
+    }
+
+    startCandidates = 0;
+    if (running) {
+        checkStop(sample);
+    }
+    return false;
+}
+
+bool AutoTimer::checkStart(const TelemetrySample& sample) {
+    if (sample.flowRate > START_FLOW) {
+        startCandidates++;
+    } else {
+        startCandidates = 0;
+    }
+    if (startCandidates < START_CONFIRM_SAMPLES) {
+        return false;
+    }
+    startCandidates = 0;
+
+    // Baseline = lowest weight in the pre-trigger window (cup on the scale, no coffee yet)
+    float baseline = sample.weight;
+    for (size_t age = 0; age < ringCount; age++) {
+        baseline = min(baseline, ringAt(age).weight);
+    }
+    if (sample.weight - baseline < START_WEIGHT) {
+        return false; // Flow estimate without real weight gain - noise or a bump
+    }
+
+    // Walk back to the last quiet sample before the first drip
+    size_t quietAge = ringCount - 1;
+    for (size_t age = 0; age < ringCount; age++) {
+        if (ringAt(age).weight <= baseline + DRIP_WEIGHT) {
+            quietAge = age;
+            break;
+        }
+    }
+
+    const TelemetrySample& quiet = ringAt(quietAge);
+    replayStart = quietAge;
+    replayLength = quietAge + 1;
+
+    Serial.printf("AutoTimer: flow detected, starting timer back-dated by %u ms\n",
+                  (unsigned)((micros() - quiet.timestampUs) / 1000));
+    displayPtr->startTimerAt(quiet.timestampUs);
+
+    // Credit the pre-trigger flow to the timer average the barista would have missed
+    if (flowRatePtr != nullptr) {
+        for (size_t i = 0; i < replayLength; i++) {
+            flowRatePtr->addTimerSample(replaySample(i).flowRate);
+        }
+    }
+
+    sawFlow = true;
+    lowFlow = false;
+    return true;
+}
+
+void AutoTimer::checkStop(const TelemetrySample& sample) {
+    if (sample.flowRate > START_FLOW) {
+        sawFlow = true;
+    }
+    if (!sawFlow) {
+        return; // Manually started and nothing has flowed yet
+    }
+
+    if (sample.flowRate >= STOP_FLOW) {
+        lowFlow = false;
+        return;
+    }
+    if (!lowFlow) {
+        lowFlow = true;
+        lowFlowSinceUs = sample.timestampUs;
+        return;
+    }
+    if (sample.timestampUs - lowFlowSinceUs >= STOP_HOLD_MS * 1000UL) {
+        Serial.println("AutoTimer: flow decayed, stopping timer");
+        displayPtr->stopTimerAt(lowFlowSinceUs);
+        sawFlow = false;
+        lowFlow = false;
+    }
+}
+
+const TelemetrySample& AutoTimer::ringAt(size_t age) const {
+    return ring[(ringHead + PRETRIGGER_SAMPLES - 1 - age) % PRETRIGGER_SAMPLES];
+}
+
+const TelemetrySample& AutoTimer::replaySample(size_t index) const {
+    // Oldest (the quiet sample) first
+    return ringAt(replayStart - index);
+}
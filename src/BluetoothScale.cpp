@@ -1,5 +1,7 @@
 #include "BluetoothScale.h"
 #include "Display.h"
+#include "LatencyTracer.h"
+#include "CoexPolicy.h"
 #include <Arduino.h>
 #include <stdexcept>
 #include <esp_bt.h>
@@ -9,13 +11,17 @@ const char* BluetoothScale::SERVICE_UUID = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E
 const char* BluetoothScale::WEIGHT_CHARACTERISTIC_UUID = "6E400004-B5A3-F393-E0A9-E50E24DCCA9E";  // Bean Conqueror (new UUID)
 const char* BluetoothScale::GAGGIMATE_CHARACTERISTIC_UUID = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E";  // GaggiMate (original UUID)
 const char* BluetoothScale::COMMAND_CHARACTERISTIC_UUID = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E";
+const char* BluetoothScale::TELEMETRY_CHARACTERISTIC_UUID = "6E400005-B5A3-F393-E0A9-E50E24DCCA9E";  // Binary telemetry frame
+const char* BluetoothScale::SHOT_EVENT_CHARACTERISTIC_UUID = "6E400006-B5A3-F393-E0A9-E50E24DCCA9E";  // Shot analytics events
 
 BluetoothScale::BluetoothScale() 
-    : scale(nullptr), display(nullptr), server(nullptr), service(nullptr), 
+    : scale(nullptr), display(nullptr), flowRate(nullptr), analytics(nullptr), shotEventCursor(0),
+      sampleBus(nullptr), weightCursor(SamplePolicy::LATEST, WEIGHT_SEND_INTERVAL * 1000), controlSubscription(-1), server(nullptr), service(nullptr), 
       weightCharacteristic(nullptr), gaggiMateWeightCharacteristic(nullptr), 
-      commandCharacteristic(nullptr), advertising(nullptr), deviceConnected(false), 
+      commandCharacteristic(nullptr), telemetryCharacteristic(nullptr), shotEventCharacteristic(nullptr), advertising(nullptr), deviceConnected(false), 
       oldDeviceConnected(false), lastHeartbeat(0), lastWeightSent(0), lastWeight(0.0f),
-      connectionRSSI(-100), connectionHandle(0) {
+      connectionRSSI(-100), connectionHandle(0), weightSendInterval(WEIGHT_SEND_INTERVAL),
+      heartbeatInterval(HEARTBEAT_INTERVAL), connProfile(nullptr) {
 }
 
 BluetoothScale::~BluetoothScale() {
@@ -25,6 +31,11 @@ BluetoothScale::~BluetoothScale() {
 void BluetoothScale::begin(Scale* scaleInstance) {
     scale = scaleInstance;
     
+    // Tare confirmations are sent once brew control has finished the tare
+    if (controlSubscription < 0) {
+        controlSubscription = controlEvents.subscribe(EVENT_MASK(ControlEventType::TARED), "ble");
+    }
+    
     Serial.println("BluetoothScale: Starting BLE initialization...");
     
     // Check available memory before BLE initialization
@@ -54,10 +65,6 @@ void BluetoothScale::begin(Scale* scaleInstance) {
         // Skip btStart() and go directly to BLE initialization
         // This avoids the problematic Bluetooth controller initialization
         initializeBLE();
-        
-        // Small delay before starting advertising
-        delay(200);
-        
         startAdvertising();
         
         Serial.println("BluetoothScale: Successfully started advertising as WeighMyBru");
@@ -88,7 +95,10 @@ void BluetoothScale::end() {
         server = nullptr;
         service = nullptr;
         weightCharacteristic = nullptr;
+        gaggiMateWeightCharacteristic = nullptr;
         commandCharacteristic = nullptr;
+        telemetryCharacteristic = nullptr;
+        shotEventCharacteristic = nullptr;
         advertising = nullptr;
     }
 }
@@ -107,9 +117,6 @@ void BluetoothScale::initializeBLE() {
     // Set moderate power to reduce current draw during boot while maintaining connectivity
     NimBLEDevice::setPower(ESP_PWR_LVL_N0);  // Moderate BLE power reduction (0dBm)
     
-    // Small delay to let power settle
-    delay(100);
-    
     Serial.printf("BluetoothScale: Free heap after NimBLEDevice::init: %u bytes\n", ESP.getFreeHeap());
     
     Serial.println("BluetoothScale: Creating BLE server...");
@@ -143,6 +150,7 @@ void BluetoothScale::initializeBLE() {
         Serial.println("BluetoothScale: ERROR - Failed to create GaggiMate weight characteristic");
         throw std::runtime_error("Failed to create GaggiMate weight characteristic");
     }
+    gaggiMateWeightCharacteristic->setCallbacks(this); // Notify status for the coexistence counters
     
     Serial.println("BluetoothScale: GaggiMate characteristic created successfully");
     
@@ -160,11 +168,38 @@ void BluetoothScale::initializeBLE() {
         Serial.println("BluetoothScale: ERROR - Failed to create Bean Conqueror weight characteristic");
         throw std::runtime_error("Failed to create Bean Conqueror weight characteristic");
     }
+    weightCharacteristic->setCallbacks(this);
     
     Serial.println("BluetoothScale: Bean Conqueror characteristic created successfully");
     
     // Note: NimBLE automatically creates 0x2902 descriptors for characteristics with NOTIFY/INDICATE properties
     
+    // Create Telemetry Characteristic (versioned binary frame shared with HTTP/WebSocket)
+    telemetryCharacteristic = service->createCharacteristic(
+        TELEMETRY_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::READ |
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    
+    if (!telemetryCharacteristic) {
+        throw std::runtime_error("Failed to create telemetry characteristic");
+    }
+    
+    Serial.println("BluetoothScale: Telemetry characteristic created successfully");
+    
+    // Create Shot Event Characteristic (first drop, end of shot, final yield)
+    shotEventCharacteristic = service->createCharacteristic(
+        SHOT_EVENT_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::READ |
+        NIMBLE_PROPERTY::NOTIFY
+    );
+    
+    if (!shotEventCharacteristic) {
+        throw std::runtime_error("Failed to create shot event characteristic");
+    }
+    
+    Serial.println("BluetoothScale: Shot event characteristic created successfully");
+    
     // Create Command Characteristic (for receiving commands)
     commandCharacteristic = service->createCharacteristic(
         COMMAND_CHARACTERISTIC_UUID,
@@ -217,6 +252,16 @@ void BluetoothScale::stopAdvertising() {
 }
 
 void BluetoothScale::update() {
+    // Confirm tares this client asked for (drained even when not connected)
+    ControlEvent controlEvent;
+    while (controlEvents.receive(controlSubscription, controlEvent, 0)) {
+        if (deviceConnected && controlEvent.type == ControlEventType::TARED &&
+            controlEvent.source == EventSource::BLE) {
+            uint8_t payload[] = {0x03, 0x0a, 0x01, 0x00, 0x00};
+            sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
+        }
+    }
+    
     // Return early if initialization failed
     if (scale == nullptr) {
         return;
@@ -237,43 +282,134 @@ void BluetoothScale::update() {
         oldDeviceConnected = deviceConnected;
         lastHeartbeat = now;
         
+        // Only events from now on are interesting to a new client
+        if (analytics) {
+            shotEventCursor = analytics->getEventSequence();
+        }
+        if (sampleBus) {
+            sampleBus->attach(weightCursor);
+            weightCursor.hasDelivered = false;
+        }
+        
         // Send initialization response for WeighMyBru client
         delay(100); // Give time for connection to stabilize
         sendNotificationRequest();
+        requestConnectionParams();
     }
     
     if (deviceConnected) {
         // Send weight updates - faster for GaggiMate brewing applications
-        if (scale && (now - lastWeightSent >= WEIGHT_SEND_INTERVAL)) {
-            float currentWeight = scale->getCurrentWeight();
+        TelemetrySample busSample;
+        if (sampleBus) {
+            // The bus hands out the freshest filtered sample, rate-limited per this cursor
+            if (sampleBus->read(weightCursor, busSample)) {
+                sendWeightNotification(busSample);
+                lastWeight = busSample.weight;
+                lastWeightSent = now;
+            }
+        } else if (scale && (now - lastWeightSent >= weightSendInterval)) {
+            // One snapshot feeds every BLE format so they always agree
+            TelemetrySample sample = TelemetryFrame::capture(*scale, flowRate, display, false);
             // Send all weight updates for real-time brewing feedback
-            sendWeightNotification(currentWeight);
-            lastWeight = currentWeight;
+            sendWeightNotification(sample);
+            lastWeight = sample.weight;
             lastWeightSent = now;
         }
         
+        // Forward shot analytics events as they happen
+        if (analytics) {
+            ShotEvent event;
+            while (analytics->nextEvent(shotEventCursor, event)) {
+                sendShotEvent(event);
+            }
+        }
+        
         // Send heartbeat
-        if (now - lastHeartbeat >= HEARTBEAT_INTERVAL) {
+        if (now - lastHeartbeat >= heartbeatInterval) {
             sendHeartbeat();
             lastHeartbeat = now;
         }
     }
 }
 
+void BluetoothScale::applyProfile(const PerformanceProfile& profile) {
+    weightSendInterval = profile.bleWeightIntervalMs;
+    heartbeatInterval = profile.bleHeartbeatMs;
+    weightCursor.minIntervalUs = profile.bleWeightIntervalMs * 1000;
+    connProfile = &profile;
+    
+    if (server == nullptr) {
+        return; // BLE not initialized - applied to the settings only
+    }
+    NimBLEDevice::setPower(profile.bleTxPower);
+    if (deviceConnected) {
+        requestConnectionParams();
+    }
+    Serial.printf("BluetoothScale: profile %s - weight every %ums, heartbeat %ums\n",
+                  profile.name, (unsigned)weightSendInterval, (unsigned)heartbeatInterval);
+}
+
+void BluetoothScale::requestConnectionParams() {
+    if (connProfile == nullptr || server == nullptr || server->getConnectedCount() == 0) {
+        return;
+    }
+    // The central decides - this is a request. Supervision timeout 4s (units of 10ms)
+    connectionHandle = server->getPeerInfo(0).getConnHandle();
+    server->updateConnParams(connectionHandle, connProfile->bleConnIntervalMin,
+                             connProfile->bleConnIntervalMax, connProfile->bleConnLatency, 400);
+}
+
 bool BluetoothScale::isConnected() {
     return deviceConnected;
 }
 
-void BluetoothScale::sendWeightNotification(float weight) {
+void BluetoothScale::sendWeightNotification(const TelemetrySample& sample) {
     if (!deviceConnected) {
         return;
     }
     
     // Send to GaggiMate first (WeighMyBru protocol format) - critical for backward compatibility
-    sendGaggiMateWeight(weight);
+    sendGaggiMateWeight(sample.weight);
+    latencyTracer.mark(LATENCY_BLE_NOTIFY, sample.timestampUs);
     
     // Send to Bean Conqueror (simple float format)  
-    sendBeanConquerorWeight(weight);
+    sendBeanConquerorWeight(sample.weight);
+    
+    // Send binary telemetry frame for clients that understand it
+    sendTelemetryFrame(sample);
+}
+
+void BluetoothScale::sendTelemetryFrame(const TelemetrySample& sample) {
+    if (!telemetryCharacteristic) {
+        return;
+    }
+    
+    // Base frame (no raw cells) fits one notification at the default MTU
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    size_t length = TelemetryFrame::encode(sample, frame, sizeof(frame));
+    if (length == 0) {
+        return;
+    }
+    
+    telemetryCharacteristic->setValue(frame, length);
+    telemetryCharacteristic->notify();
+}
+
+void BluetoothScale::sendShotEvent(const ShotEvent& event) {
+    if (!shotEventCharacteristic) {
+        return;
+    }
+    
+    // 16 bytes little-endian: version, type, reserved[2], shot time ms, weight, value
+    uint8_t payload[16] = {0};
+    payload[0] = 1;
+    payload[1] = (uint8_t)event.type;
+    memcpy(payload + 4, &event.shotTimeMs, 4);
+    memcpy(payload + 8, &event.weight, 4);
+    memcpy(payload + 12, &event.value, 4);
+    
+    shotEventCharacteristic->setValue(payload, sizeof(payload));
+    shotEventCharacteristic->notify();
 }
 
 void BluetoothScale::sendBeanConquerorWeight(float weight) {
@@ -393,26 +529,16 @@ uint8_t BluetoothScale::calculateChecksum(const uint8_t* data, size_t length) {
 }
 
 void BluetoothScale::handleTareCommand() {
-    if (scale) {
-        Serial.println("BluetoothScale: Executing tare command");
-        scale->tare(10);
-        
-        // Send tare confirmation
-        uint8_t payload[] = {0x03, 0x0a, 0x01, 0x00, 0x00};
-        sendMessage(WeighMyBruMessageType::SYSTEM, payload, sizeof(payload));
-    }
+    Serial.println("BluetoothScale: Requesting tare");
+    // Confirmation goes out when brew control reports TARED (see update())
+    controlEvents.publish(ControlEventType::TARE, EventSource::BLE, 10);
 }
 
 void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
-    if (!display) {
-        Serial.println("BluetoothScale: Display not available for timer command");
-        return;
-    }
-    
     switch (command) {
         case BeanConquerorCommand::TIMER_START:
             Serial.println("BluetoothScale: Starting timer");
-            display->startTimer();
+            controlEvents.publish(ControlEventType::TIMER_START, EventSource::BLE);
             // Send timer start confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x02, 0x01, 0x00};
@@ -422,7 +548,7 @@ void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
             
         case BeanConquerorCommand::TIMER_STOP:
             Serial.println("BluetoothScale: Stopping timer");
-            display->stopTimer();
+            controlEvents.publish(ControlEventType::TIMER_STOP, EventSource::BLE);
             // Send timer stop confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x03, 0x01, 0x00};
@@ -432,7 +558,7 @@ void BluetoothScale::handleTimerCommand(BeanConquerorCommand command) {
             
         case BeanConquerorCommand::TIMER_RESET:
             Serial.println("BluetoothScale: Resetting timer");
-            display->resetTimer();
+            controlEvents.publish(ControlEventType::TIMER_RESET, EventSource::BLE);
             // Send timer reset confirmation
             {
                 uint8_t payload[] = {0x03, 0x0a, 0x04, 0x01, 0x00};
@@ -489,6 +615,13 @@ void BluetoothScale::processIncomingMessage(uint8_t* data, size_t length) {
                 }
                 break;
                 
+            case BeanConquerorCommand::PROFILE:
+                // Executed on the acquisition task like tare and timer requests
+                if (!profileManager.request((ProfileId)data[3], EventSource::BLE)) {
+                    Serial.printf("BluetoothScale: Unknown profile: 0x%02X\n", data[3]);
+                }
+                break;
+                
             default:
                 Serial.printf("BluetoothScale: Unknown command: 0x%02X\n", static_cast<uint8_t>(command));
                 break;
@@ -501,11 +634,13 @@ void BluetoothScale::onConnect(NimBLEServer* pServer) {
     deviceConnected = true;
     NimBLEDevice::stopAdvertising();
     Serial.println("BluetoothScale: Device connected");
+    controlEvents.publish(ControlEventType::CLIENT_CONNECTED, EventSource::BLE, CLIENT_BLE);
 }
 
 void BluetoothScale::onDisconnect(NimBLEServer* pServer) {
     deviceConnected = false;
     Serial.println("BluetoothScale: Device disconnected");
+    controlEvents.publish(ControlEventType::CLIENT_DISCONNECTED, EventSource::BLE, CLIENT_BLE);
 }
 
 // BLE Characteristic Callbacks
@@ -521,6 +656,20 @@ void BluetoothScale::onWrite(NimBLECharacteristic* pCharacteristic) {
     }
 }
 
+// Weight notification outcome, binned by the coexistence preference. Out of
+// buffers means the controller didn't get the airtime to drain earlier ones
+void BluetoothScale::onStatus(NimBLECharacteristic* pCharacteristic, Status status, int code) {
+    if (pCharacteristic != gaggiMateWeightCharacteristic && pCharacteristic != weightCharacteristic) {
+        return;
+    }
+    if (status == Status::SUCCESS_NOTIFY) {
+        coexPolicy.recordBleNotification(true, false);
+    } else if (status == Status::ERROR_GATT) {
+        coexPolicy.recordBleNotification(false, code == BLE_HS_ENOMEM || code == BLE_HS_EBUSY);
+    }
+    // Not subscribed or no client - nothing went over the air
+}
+
 // Overloaded begin method for early initialization
 void BluetoothScale::begin() {
     begin(nullptr);  // Initialize without scale reference
@@ -536,6 +685,21 @@ void BluetoothScale::setDisplay(Display* displayInstance) {
     Serial.println("BluetoothScale: Display reference set");
 }
 
+void BluetoothScale::setFlowRate(FlowRate* flowRateInstance) {
+    flowRate = flowRateInstance;
+    Serial.println("BluetoothScale: Flow rate reference set");
+}
+
+void BluetoothScale::setShotAnalytics(ShotAnalytics* analyticsInstance) {
+    analytics = analyticsInstance;
+    Serial.println("BluetoothScale: Shot analytics reference set");
+}
+
+void BluetoothScale::setSampleBus(SampleBus* bus) {
+    sampleBus = bus;
+    Serial.println("BluetoothScale: Sample bus reference set");
+}
+
 // Get BLE signal strength (RSSI)
 int BluetoothScale::getBluetoothSignalStrength() {
     if (!deviceConnected || !server) {
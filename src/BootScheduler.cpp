@@ -0,0 +1,137 @@
+#include "BootScheduler.h"
+
+BootScheduler bootScheduler;
+
+struct StepContext {
+    BootScheduler* scheduler;
+    size_t index;
+};
+
+static StepContext stepContexts[BootScheduler::MAX_STEPS];
+
+BootScheduler::BootScheduler()
+    : stepCount(0), milestoneCount(0), readyBits(nullptr), milestoneLock(portMUX_INITIALIZER_UNLOCKED) {}
+
+uint32_t BootScheduler::add(const char* name, StepFunction function, uint32_t dependsOn,
+                            uint32_t stackBytes, BaseType_t core) {
+    if (stepCount >= MAX_STEPS) {
+        Serial.printf("BootScheduler: no slot for step %s\n", name);
+        return 0;
+    }
+    Step& step = steps[stepCount];
+    step.name = name;
+    step.function = function;
+    step.dependsOn = dependsOn;
+    step.stackBytes = stackBytes;
+    step.core = core;
+    step.startUs = 0;
+    step.readyUs = 0;
+    step.ok = false;
+    return 1u << stepCount++;
+}
+
+void BootScheduler::start() {
+    if (readyBits == nullptr) {
+        readyBits = xEventGroupCreateStatic(&readyBitsBuffer);
+    }
+    for (size_t i = 0; i < stepCount; i++) {
+        stepContexts[i].scheduler = this;
+        stepContexts[i].index = i;
+        // Above the loop task, so a step starts the moment its dependencies are met
+        if (xTaskCreatePinnedToCore(stepTask, steps[i].name, steps[i].stackBytes, &stepContexts[i],
+                                    2, nullptr, steps[i].core) != pdPASS) {
+            // Run it inline rather than leave its dependents waiting forever
+            Serial.printf("BootScheduler: could not start task for %s - running inline\n", steps[i].name);
+            runStep(i);
+        }
+    }
+}
+
+void BootScheduler::stepTask(void* param) {
+    StepContext* context = (StepContext*)param;
+    context->scheduler->runStep(context->index);
+    vTaskDelete(NULL);
+}
+
+void BootScheduler::runStep(size_t index) {
+    Step& step = steps[index];
+    if (step.dependsOn != 0) {
+        xEventGroupWaitBits(readyBits, step.dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    step.startUs = micros();
+    step.ok = step.function();
+    step.readyUs = micros();
+    Serial.printf("BootScheduler: %s %s in %.1f ms\n", step.name, step.ok ? "ready" : "FAILED",
+                  (step.readyUs - step.startUs) / 1000.0f);
+    // A failed step still completes - dependents check their own preconditions
+    xEventGroupSetBits(readyBits, 1u << index);
+}
+
+bool BootScheduler::waitFor(uint32_t mask, uint32_t timeoutMs) {
+    if (readyBits == nullptr) {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(readyBits, mask, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeoutMs));
+    return (bits & mask) == mask;
+}
+
+void BootScheduler::mark(const char* milestone) {
+    uint32_t now = micros();
+    portENTER_CRITICAL(&milestoneLock);
+    bool known = false;
+    for (size_t i = 0; i < milestoneCount; i++) {
+        if (strcmp(milestones[i].name, milestone) == 0) {
+            known = true;
+            break;
+        }
+    }
+    if (!known && milestoneCount < MAX_MILESTONES) {
+        milestones[milestoneCount].name = milestone;
+        milestones[milestoneCount].atUs = now;
+        milestoneCount = milestoneCount + 1;
+    }
+    portEXIT_CRITICAL(&milestoneLock);
+}
+
+void BootScheduler::printTimeline() const {
+    Serial.println("=== Boot timeline (ms since boot) ===");
+    for (size_t i = 0; i < stepCount; i++) {
+        const Step& step = steps[i];
+        Serial.printf("  %-10s start %7.1f  ready %7.1f  (%6.1f ms) %s\n", step.name,
+                      step.startUs / 1000.0f, step.readyUs / 1000.0f,
+                      (step.readyUs - step.startUs) / 1000.0f, step.ok ? "OK" : "FAILED");
+    }
+    for (size_t i = 0; i < milestoneCount; i++) {
+        Serial.printf("  %-10s at    %7.1f\n", milestones[i].name, milestones[i].atUs / 1000.0f);
+    }
+    Serial.println("=====================================");
+}
+
+String BootScheduler::toJson() const {
+    String json = "{\"steps\":[";
+    for (size_t i = 0; i < stepCount; i++) {
+        const Step& step = steps[i];
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + String(step.name) + "\"";
+        json += ",\"start_us\":" + String(step.startUs);
+        json += ",\"ready_us\":" + String(step.readyUs);
+        json += ",\"ok\":" + String(step.ok ? "true" : "false");
+        json += ",\"depends\":[";
+        bool first = true;
+        for (size_t d = 0; d < stepCount; d++) {
+            if (step.dependsOn & (1u << d)) {
+                if (!first) json += ",";
+                json += "\"" + String(steps[d].name) + "\"";
+                first = false;
+            }
+        }
+        json += "]}";
+    }
+    json += "],\"milestones\":{";
+    for (size_t i = 0; i < milestoneCount; i++) {
+        if (i > 0) json += ",";
+        json += "\"" + String(milestones[i].name) + "\":" + String(milestones[i].atUs);
+    }
+    json += "}}";
+    return json;
+}
@@ -0,0 +1,94 @@
+#include "BrewControl.h"
+#include "Scale.h"
+#include "Display.h"
+#include "FlowRate.h"
+#include "PourSegmenter.h"
+#include "PerformanceProfile.h"
+
+BrewControl::BrewControl(Scale* scale, Display* display, FlowRate* flowRate)
+    : scalePtr(scale), displayPtr(display), flowRatePtr(flowRate), pourSegmenterPtr(nullptr),
+      subscription(-1) {}
+
+void BrewControl::begin() {
+    subscription = controlEvents.subscribe(
+        EVENT_MASK(ControlEventType::TARE) |
+        EVENT_MASK(ControlEventType::TIMER_START) |
+        EVENT_MASK(ControlEventType::TIMER_STOP) |
+        EVENT_MASK(ControlEventType::TIMER_RESET) |
+        EVENT_MASK(ControlEventType::PROFILE) |
+        EVENT_MASK(ControlEventType::CLIENT_CONNECTED) |
+        EVENT_MASK(ControlEventType::CLIENT_DISCONNECTED) |
+        EVENT_MASK(ControlEventType::SETTINGS_CHANGED),
+        "brew-control");
+}
+
+void BrewControl::setPourSegmenter(PourSegmenter* segmenter) {
+    pourSegmenterPtr = segmenter;
+}
+
+uint32_t BrewControl::waitForEvents(uint32_t timeoutMs) {
+    ControlEvent event;
+    // Block on the queue - a request wakes the task immediately instead of after the period
+    if (!controlEvents.receive(subscription, event, pdMS_TO_TICKS(timeoutMs))) {
+        return 0;
+    }
+    uint32_t startUs = micros();
+    handle(event);
+    while (controlEvents.receive(subscription, event, 0)) {
+        handle(event);
+    }
+    return micros() - startUs;
+}
+
+void BrewControl::handle(const ControlEvent& event) {
+    Serial.printf("BrewControl: %s from %s\n", EventBus::typeName(event.type),
+                  EventBus::sourceName(event.source));
+
+    switch (event.type) {
+        case ControlEventType::TARE:
+            tare(event);
+            break;
+        case ControlEventType::TIMER_START:
+            if (displayPtr) displayPtr->startTimer();
+            break;
+        case ControlEventType::TIMER_STOP:
+            if (displayPtr) displayPtr->stopTimer();
+            break;
+        case ControlEventType::TIMER_RESET:
+            if (displayPtr) displayPtr->resetTimer();
+            break;
+        case ControlEventType::PROFILE:
+            profileManager.handleRequest(event);
+            break;
+        default:
+            // Connect/disconnect and settings changes are only logged here
+            break;
+    }
+}
+
+void BrewControl::tare(const ControlEvent& event) {
+    if (scalePtr == nullptr) {
+        Serial.println("Error: Scale pointer is null");
+        return;
+    }
+
+    // Pause flow rate calculation so the tare step does not show up as flow
+    if (flowRatePtr) {
+        flowRatePtr->pauseCalculation();
+    }
+    scalePtr->tare(event.arg > 0 ? event.arg : 20);
+    if (flowRatePtr) {
+        delay(100); // Short delay to let scale stabilize
+        flowRatePtr->resumeCalculation();
+    }
+
+    // A tare prepares a fresh brew: timer and flow averaging start over
+    if (displayPtr) {
+        displayPtr->resetTimer();
+    }
+    if (pourSegmenterPtr) {
+        pourSegmenterPtr->reset();
+    }
+
+    controlEvents.publish(ControlEventType::TARED, event.source);
+}
@@ -0,0 +1,100 @@
+#include "CoexPolicy.h"
+#include <sdkconfig.h>
+
+#if CONFIG_SW_COEXIST_ENABLE || CONFIG_ESP32_WIFI_SW_COEXIST_ENABLE
+#include <esp_coexist.h>
+#define WMB_HAS_COEX 1
+#else
+#define WMB_HAS_COEX 0
+#endif
+
+CoexPolicy coexPolicy;
+
+CoexPolicy::CoexPolicy()
+    : preference(CoexPreference::BALANCE), available(WMB_HAS_COEX), sinceMs(0), switches(0) {
+    memset(stats, 0, sizeof(stats));
+}
+
+void CoexPolicy::update(bool bleShotActive, bool webHeavy) {
+    // A shot on a BLE controller outranks a page load
+    CoexPreference next = CoexPreference::BALANCE;
+    if (bleShotActive) {
+        next = CoexPreference::BLE;
+    } else if (webHeavy) {
+        next = CoexPreference::WIFI;
+    }
+    if (next == preference || millis() - sinceMs < MIN_DWELL_MS) {
+        return;
+    }
+    apply(next);
+}
+
+void CoexPolicy::apply(CoexPreference next) {
+#if WMB_HAS_COEX
+    esp_coex_prefer_t prefer = ESP_COEX_PREFER_BALANCE;
+    if (next == CoexPreference::BLE) {
+        prefer = ESP_COEX_PREFER_BT;
+    } else if (next == CoexPreference::WIFI) {
+        prefer = ESP_COEX_PREFER_WIFI;
+    }
+    if (esp_coex_preference_set(prefer) != ESP_OK) {
+        Serial.println("Coex: preference rejected - keeping " + String(preferenceName(preference)));
+        sinceMs = millis(); // Don't retry every cycle
+        return;
+    }
+#endif
+    unsigned long now = millis();
+    stats[(int)preference].totalMs += now - sinceMs;
+    Serial.printf("Coex: %s -> %s\n", preferenceName(preference), preferenceName(next));
+    preference = next;
+    sinceMs = now;
+    switches++;
+}
+
+void CoexPolicy::recordBleNotification(bool sent, bool congested) {
+    PreferenceStats& s = stats[(int)preference];
+    if (sent) {
+        s.notifications++;
+    } else if (congested) {
+        s.congested++;
+    } else {
+        s.failed++;
+    }
+}
+
+void CoexPolicy::reset() {
+    for (int i = 0; i < (int)CoexPreference::COUNT; i++) {
+        stats[i].notifications = 0;
+        stats[i].congested = 0;
+        stats[i].failed = 0;
+    }
+}
+
+const char* CoexPolicy::preferenceName(CoexPreference preference) {
+    switch (preference) {
+        case CoexPreference::BALANCE: return "balance";
+        case CoexPreference::BLE: return "ble";
+        case CoexPreference::WIFI: return "wifi";
+        default: return "unknown";
+    }
+}
+
+String CoexPolicy::toJson() const {
+    unsigned long now = millis();
+    String json = "{\"available\":" + String(available ? "true" : "false");
+    json += ",\"preference\":\"" + String(preferenceName(preference)) + "\"";
+    json += ",\"switches\":" + String(switches);
+    json += ",\"preferences\":[";
+    for (int i = 0; i < (int)CoexPreference::COUNT; i++) {
+        const PreferenceStats& s = stats[i];
+        unsigned long totalMs = s.totalMs + (i == (int)preference ? now - sinceMs : 0);
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + String(preferenceName((CoexPreference)i)) + "\"";
+        json += ",\"time_ms\":" + String(totalMs);
+        json += ",\"ble_notifications\":" + String(s.notifications);
+        json += ",\"ble_congested\":" + String(s.congested);
+        json += ",\"ble_failed\":" + String(s.failed) + "}";
+    }
+    json += "]}";
+    return json;
+}
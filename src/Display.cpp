@@ -6,9 +6,15 @@
 #include "BatteryMonitor.h"
 #include <WiFi.h>
 #include "WiFiManager.h"
+#include "WeightHistory.h"
+#include "ShotLog.h"
+#include "ShotAnalytics.h"
+#include "LatencyTracer.h"
+#include "BootScheduler.h"
 
 Display::Display(uint8_t sdaPin, uint8_t sclPin, Scale* scale, FlowRate* flowRate)
-    : sdaPin(sdaPin), sclPin(sclPin), scalePtr(scale), flowRatePtr(flowRate), bluetoothPtr(nullptr), powerManagerPtr(nullptr), batteryPtr(nullptr), wifiManagerPtr(nullptr),
+    : sdaPin(sdaPin), sclPin(sclPin), scalePtr(scale), flowRatePtr(flowRate), bluetoothPtr(nullptr), powerManagerPtr(nullptr), batteryPtr(nullptr), wifiManagerPtr(nullptr), historyPtr(nullptr), shotLogPtr(nullptr), analyticsPtr(nullptr),
+      sampleBusPtr(nullptr), displayCursor(SamplePolicy::LATEST, 100000, 0.05f), displayedWeight(0.0f), firstWeightShown(false),
       messageStartTime(0), messageDuration(2000), showingMessage(false), 
       timerStartTime(0), timerPausedTime(0), timerRunning(false), timerPaused(false),
       lastFlowRate(0.0), showingStatusPage(false), statusPageStartTime(0) {
@@ -24,7 +30,7 @@ bool Display::begin() {
     // Test I2C connection first with timeout
     Serial.println("Testing I2C connection to display...");
     unsigned long startTime = millis();
-    const unsigned long I2C_TIMEOUT = 3000; // 3 second timeout
+    const unsigned long I2C_TIMEOUT = 500; // SSD1306 answers within ~100ms of power-up
     
     bool i2cResponding = false;
     Wire.beginTransmission(SCREEN_ADDRESS);
@@ -36,7 +42,7 @@ bool Display::begin() {
             Serial.println("I2C device found at display address");
             break;
         }
-        delay(100);
+        delay(20);
         Wire.beginTransmission(SCREEN_ADDRESS);
     }
     
@@ -131,6 +137,8 @@ void Display::update() {
         // Use shorter duration for tared message
         if (currentMessage == "Tared message") {
             effectiveDuration = 1000; // Half of default duration for quick feedback
+        } else if (currentMessage == "Ready message") {
+            effectiveDuration = 500; // Boot greeting - get to the weight quickly
         }
         
         if (millis() - messageStartTime > effectiveDuration) {
@@ -145,8 +153,23 @@ void Display::update() {
     }
     // Show normal weight display when not showing message or status page
     else if (!showingMessage && scalePtr != nullptr) {
-        float weight = scalePtr->getCurrentWeight();
-        showWeightWithFlowAndTimer(weight);
+        // Take the weight from the sample bus at display rate; small jitter keeps the old number
+        TelemetrySample sample;
+        bool newSample = false;
+        if (sampleBusPtr == nullptr) {
+            displayedWeight = scalePtr->getCurrentWeight();
+        } else if (sampleBusPtr->read(displayCursor, sample)) {
+            displayedWeight = sample.weight;
+            newSample = true;
+        }
+        showWeightWithFlowAndTimer(displayedWeight);
+        if (newSample) {
+            latencyTracer.mark(LATENCY_OLED_PUSH, sample.timestampUs);
+            if (!firstWeightShown) {
+                firstWeightShown = true;
+                bootScheduler.mark("first_weight"); // Boot timeline target: < 1 s
+            }
+        }
     }
 }
 
@@ -532,7 +555,7 @@ void Display::showIPAddresses() {
         return;
     }
     
-    // Show the WeighMyBru Ready message for 3 seconds
+    // Show the WeighMyBru Ready message (cleared by update() after 500ms)
     display->clearDisplay();
     display->setTextSize(2);
     display->setTextColor(SSD1306_WHITE);
@@ -565,7 +588,11 @@ void Display::showIPAddresses() {
     display->print(line2);
     
     display->display();
-    delay(1000); // Show ready message for 1 second, then continue to normal display
+    
+    // Shown until update() clears it - no blocking wait during boot
+    currentMessage = "Ready message";
+    messageStartTime = millis();
+    showingMessage = true;
 }
 
 void Display::clear() {
@@ -605,6 +632,26 @@ void Display::setWiFiManager(WiFiManager* wifi) {
     wifiManagerPtr = wifi;
 }
 
+void Display::setWeightHistory(WeightHistory* history) {
+    historyPtr = history;
+}
+
+void Display::setShotLog(ShotLog* shotLog) {
+    shotLogPtr = shotLog;
+}
+
+void Display::setShotAnalytics(ShotAnalytics* analytics) {
+    analyticsPtr = analytics;
+}
+
+void Display::setSampleBus(SampleBus* bus) {
+    sampleBusPtr = bus;
+    if (bus != nullptr) {
+        displayedWeight = scalePtr != nullptr ? scalePtr->getCurrentWeight() : 0.0f;
+        bus->attach(displayCursor);
+    }
+}
+
 void Display::drawBluetoothStatus() {
     // Return early if display is not connected
     if (!displayConnected) {
@@ -926,9 +973,14 @@ void Display::showWeightWithFlowAndTimer(float weight) {
 
 // Timer management methods
 void Display::startTimer() {
+    startTimerAt(micros());
+}
+
+void Display::startTimerAt(uint32_t startMicros) {
     if (!timerRunning) {
-        // Fresh start
-        timerStartTime = millis();
+        // Fresh start - optionally back-dated (auto-timer pre-trigger)
+        uint32_t backdateMs = (micros() - startMicros) / 1000;
+        timerStartTime = millis() - backdateMs;
         timerRunning = true;
         timerPaused = false;
         
@@ -936,6 +988,17 @@ void Display::startTimer() {
         if (flowRatePtr != nullptr) {
             flowRatePtr->startTimerAveraging();
         }
+        
+        // A fresh start is a new shot for the weight history
+        if (historyPtr != nullptr) {
+            historyPtr->beginShot(startMicros);
+        }
+        if (shotLogPtr != nullptr) {
+            shotLogPtr->beginShot(startMicros);
+        }
+        if (analyticsPtr != nullptr) {
+            analyticsPtr->beginShot(startMicros);
+        }
     } else if (timerPaused) {
         // Resume from paused state
         timerStartTime = millis() - timerPausedTime;
@@ -950,18 +1013,42 @@ void Display::startTimer() {
 }
 
 void Display::stopTimer() {
+    stopTimerAt(micros());
+}
+
+void Display::stopTimerAt(uint32_t stopMicros) {
     if (timerRunning && !timerPaused) {
-        timerPausedTime = millis() - timerStartTime;
+        // Back-dated stops (auto-timer flow decay) still never go below zero
+        unsigned long stopTime = millis() - (micros() - stopMicros) / 1000;
+        timerPausedTime = stopTime > timerStartTime ? stopTime - timerStartTime : 0;
         timerPaused = true;
         
         // Stop flow rate averaging when timer stops
         if (flowRatePtr != nullptr) {
             flowRatePtr->stopTimerAveraging();
         }
+        
+        // Stopping the timer ends the shot - persist it with its average flow
+        if (shotLogPtr != nullptr) {
+            float avgFlow = (flowRatePtr != nullptr && flowRatePtr->hasTimerAverage())
+                ? flowRatePtr->getTimerAverageFlowRate() : 0.0f;
+            shotLogPtr->endShot(avgFlow);
+        }
+        if (analyticsPtr != nullptr) {
+            analyticsPtr->endShot();
+        }
     }
 }
 
 void Display::resetTimer() {
+    // Resetting a running timer also ends the shot (no-op if already saved)
+    if (shotLogPtr != nullptr) {
+        shotLogPtr->endShot(0.0f);
+    }
+    if (analyticsPtr != nullptr) {
+        analyticsPtr->reset();
+    }
+    
     timerStartTime = 0;
     timerPausedTime = 0;
     timerRunning = false;
@@ -0,0 +1,92 @@
+#include "EventBus.h"
+#include <freertos/task.h>
+
+EventBus controlEvents;
+
+EventBus::EventBus() : subscriberCount(0), published(0) {}
+
+EventBus::SubscriberId EventBus::subscribe(uint32_t mask, const char* name) {
+    if (subscriberCount >= MAX_SUBSCRIBERS) {
+        Serial.printf("EventBus: no free subscriber slot for %s\n", name);
+        return -1;
+    }
+
+    Subscriber& subscriber = subscribers[subscriberCount];
+    subscriber.queue = xQueueCreateStatic(QUEUE_DEPTH, sizeof(ControlEvent),
+                                          subscriber.storage, &subscriber.queueControl);
+    if (subscriber.queue == nullptr) {
+        Serial.printf("EventBus: queue creation failed for %s\n", name);
+        return -1;
+    }
+    subscriber.mask = mask;
+    subscriber.name = name;
+    subscriber.dropped = 0;
+
+    Serial.printf("EventBus: %s subscribed (mask 0x%02X)\n", name, (unsigned)mask);
+    return (SubscriberId)subscriberCount++;
+}
+
+bool EventBus::publish(ControlEventType type, EventSource source, uint16_t arg) {
+    ControlEvent event;
+    event.type = type;
+    event.source = source;
+    event.arg = arg;
+    event.timeMs = millis();
+    published = published + 1;
+
+    bool deliveredAll = true;
+    for (size_t i = 0; i < subscriberCount; i++) {
+        Subscriber& subscriber = subscribers[i];
+        if ((subscriber.mask & EVENT_MASK(type)) == 0) {
+            continue;
+        }
+        if (xQueueSend(subscriber.queue, &event, 0) != pdTRUE) {
+            subscriber.dropped = subscriber.dropped + 1;
+            deliveredAll = false;
+            Serial.printf("EventBus: %s dropped for %s (queue full)\n", typeName(type), subscriber.name);
+        }
+    }
+    return deliveredAll;
+}
+
+bool EventBus::receive(SubscriberId id, ControlEvent& event, TickType_t wait) {
+    if (id < 0 || (size_t)id >= subscriberCount) {
+        if (wait > 0) {
+            vTaskDelay(wait); // Keep the caller's pacing even without a subscription
+        }
+        return false;
+    }
+    return xQueueReceive(subscribers[id].queue, &event, wait) == pdTRUE;
+}
+
+uint32_t EventBus::getDropped() const {
+    uint32_t total = 0;
+    for (size_t i = 0; i < subscriberCount; i++) {
+        total += subscribers[i].dropped;
+    }
+    return total;
+}
+
+const char* EventBus::typeName(ControlEventType type) {
+    switch (type) {
+        case ControlEventType::TARE: return "tare";
+        case ControlEventType::TARED: return "tared";
+        case ControlEventType::TIMER_START: return "timer_start";
+        case ControlEventType::TIMER_STOP: return "timer_stop";
+        case ControlEventType::TIMER_RESET: return "timer_reset";
+        case ControlEventType::SETTINGS_CHANGED: return "settings_changed";
+        case ControlEventType::CLIENT_CONNECTED: return "client_connected";
+        case ControlEventType::CLIENT_DISCONNECTED: return "client_disconnected";
+        case ControlEventType::PROFILE: return "profile";
+        default: return "unknown";
+    }
+}
+
+const char* EventBus::sourceName(EventSource source) {
+    switch (source) {
+        case EventSource::TOUCH: return "touch";
+        case EventSource::BLE: return "ble";
+        case EventSource::WEB: return "web";
+        default: return "system";
+    }
+}
@@ -0,0 +1,127 @@
+#include "FirFilter.h"
+
+FirFilter::FirFilter() : taps(0), cutoffHz(0.0f), designRateHz(0.0f), position(0) {
+    for (size_t i = 0; i < MAX_TAPS; i++) {
+        coeffs[i] = 0.0f;
+    }
+}
+
+void FirFilter::design(size_t requestedTaps, float cutoff, float sampleRateHz) {
+    if (sampleRateHz <= 0.0f || cutoff <= 0.0f) {
+        return;
+    }
+    // Multiple of 4 keeps the vector kernel on its fast path
+    size_t n = (requestedTaps + 3) & ~(size_t)3;
+    if (n < 16) n = 16;
+    if (n > MAX_TAPS) n = MAX_TAPS;
+    if (cutoff > sampleRateHz * 0.45f) cutoff = sampleRateHz * 0.45f;
+
+    // Windowed sinc, normalised to unity gain at DC so grams stay grams
+    float fc = cutoff / sampleRateHz;
+    float middle = (n - 1) / 2.0f;
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float x = i - middle;
+        float sinc = x == 0.0f ? 2.0f * fc : sinf(2.0f * PI * fc * x) / (PI * x);
+        float blackman = 0.42f - 0.5f * cosf(2.0f * PI * i / (n - 1)) + 0.08f * cosf(4.0f * PI * i / (n - 1));
+        coeffs[i] = sinc * blackman;
+        sum += coeffs[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        coeffs[i] /= sum;
+    }
+
+    float current = taps > 0 ? history[position + taps - 1] : 0.0f;
+    taps = n;
+    cutoffHz = cutoff;
+    designRateHz = sampleRateHz;
+#if WMB_HAS_ESP_DSP
+    dsps_fir_init_f32(&fir, coeffs, delay, (int)taps);
+#endif
+    reset(current);
+}
+
+void FirFilter::reset(float value) {
+    for (size_t i = 0; i < 2 * MAX_TAPS; i++) {
+        history[i] = value;
+    }
+    position = 0;
+#if WMB_HAS_ESP_DSP
+    for (size_t i = 0; i < MAX_TAPS; i++) {
+        delay[i] = value;
+    }
+    fir.pos = 0;
+#endif
+}
+
+float FirFilter::process(float reading) {
+    if (taps == 0) {
+        return reading;
+    }
+#if WMB_HAS_ESP_DSP
+    float output;
+    dsps_fir_f32(&fir, &reading, &output, 1);
+    // Keep the scalar history current for reset()/redesign continuity
+    history[position] = reading;
+    history[position + taps] = reading;
+    position = (position + 1) % taps;
+    return output;
+#else
+    return processScalar(reading);
+#endif
+}
+
+float FirFilter::processScalar(float reading) {
+    history[position] = reading;
+    history[position + taps] = reading;
+    position = (position + 1) % taps;
+
+    // history[position .. position + taps - 1] is oldest..newest; the kernel is
+    // symmetric, so coefficient order does not matter
+    const float* window = &history[position];
+    float acc = 0.0f;
+    for (size_t i = 0; i < taps; i++) {
+        acc += coeffs[i] * window[i];
+    }
+    return acc;
+}
+
+float FirFilter::getGroupDelayMs() const {
+    if (taps == 0 || designRateHz <= 0.0f) {
+        return 0.0f;
+    }
+    return (taps - 1) / 2.0f * 1000.0f / designRateHz;
+}
+
+FirBenchmark FirFilter::benchmark(size_t taps, size_t samples) {
+    FirBenchmark result;
+    // Heap, not stack - the filter is about 1 KB and this runs on the web task
+    FirFilter* filter = new FirFilter();
+    filter->design(taps, 5.0f, 80.0f);
+    result.taps = filter->getTaps();
+    result.samples = samples;
+
+    // Deterministic test signal - a ramp with a wobble
+    volatile float sink = 0.0f;
+    uint32_t start = ESP.getCycleCount();
+    for (size_t i = 0; i < samples; i++) {
+        sink = filter->processScalar(i * 0.01f + ((i & 7) - 3.5f) * 0.05f);
+    }
+    result.scalarCyclesPerSample = (float)(ESP.getCycleCount() - start) / samples;
+
+#if WMB_HAS_ESP_DSP
+    filter->reset(0.0f);
+    start = ESP.getCycleCount();
+    for (size_t i = 0; i < samples; i++) {
+        float input = i * 0.01f + ((i & 7) - 3.5f) * 0.05f;
+        float output;
+        dsps_fir_f32(&filter->fir, &input, &output, 1);
+        sink = output;
+    }
+    result.vectorCyclesPerSample = (float)(ESP.getCycleCount() - start) / samples;
+#endif
+
+    (void)sink;
+    delete filter;
+    return result;
+}
@@ -137,6 +137,14 @@ void FlowRate::startTimerAveraging() {
     Serial.println("Started timer-based flow rate averaging");
 }
 
+void FlowRate::addTimerSample(float rate) {
+    // Same rule as live samples - only meaningful positive flow counts
+    if (timerAveragingActive && rate > 0.1f) {
+        timerFlowRateSum += rate;
+        timerFlowRateSamples++;
+    }
+}
+
 void FlowRate::stopTimerAveraging() {
     if (timerAveragingActive && timerFlowRateSamples > 0) {
         timerAverageFlowRate = timerFlowRateSum / timerFlowRateSamples;
@@ -0,0 +1,280 @@
+#include "InputEngine.h"
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <freertos/task.h>
+#include <esp_sleep.h>
+
+InputEngine inputEngine;
+
+InputEngine::InputEngine() : queue(nullptr), isrInstalled(false), droppedInIsr(0) {
+    memset(pads, 0, sizeof(pads));
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool InputEngine::attach(InputPad pad, uint8_t pin, const InputPadConfig& config, InputListener* listener) {
+    if (queue == nullptr) {
+        queue = xQueueCreate(QUEUE_LENGTH, sizeof(Edge));
+        if (queue == nullptr) {
+            Serial.println("InputEngine: failed to create edge queue");
+            return false;
+        }
+    }
+    if (!isrInstalled) {
+        // The Arduino core may already have installed the shared GPIO ISR service
+        esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            Serial.printf("InputEngine: GPIO ISR service failed (%s)\n", esp_err_to_name(err));
+            return false;
+        }
+        // Pad pins wake the CPU from automatic light sleep
+        esp_sleep_enable_gpio_wakeup();
+        isrInstalled = true;
+    }
+
+    PadState& state = pads[(size_t)pad];
+    gpio_num_t gpio = (gpio_num_t)pin;
+    bool level = gpio_get_level(gpio) != 0;
+    state.pin = pin;
+    state.config = config;
+    state.listener = listener;
+    state.pressed = level;
+    state.rawLevel = level;
+    state.settlePending = false;
+    state.lastChangeMs = millis();
+    state.pressStartMs = state.lastChangeMs;
+    state.longFired = false;
+    state.veryLongFired = false;
+    state.suppressed = level;
+    state.attached = true;
+
+    // Level interrupt armed for the opposite level - the ISR flips it on every change
+    gpio_wakeup_enable(gpio, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    if (gpio_isr_handler_add(gpio, edgeIsr, (void*)(intptr_t)pad) != ESP_OK) {
+        Serial.println("InputEngine: failed to attach ISR on GPIO" + String(pin));
+        state.attached = false;
+        return false;
+    }
+    gpio_intr_enable(gpio);
+
+    Serial.printf("InputEngine: %s pad on GPIO%d (long %lums%s, very long %lums)%s\n",
+                  padName(pad), pin, (unsigned long)config.longPressMs,
+                  config.longPressOnRelease ? " on release" : "",
+                  (unsigned long)config.veryLongPressMs, level ? " - held at start" : "");
+    return true;
+}
+
+void IRAM_ATTR InputEngine::edgeIsr(void* arg) {
+    uint8_t index = (uint8_t)(intptr_t)arg;
+    gpio_num_t gpio = (gpio_num_t)inputEngine.pads[index].pin;
+    int level = gpio_ll_get_level(&GPIO, gpio);
+
+    // Re-arm for the opposite level so the next change interrupts (and wakes) again
+    gpio_ll_wakeup_enable(&GPIO, gpio, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+
+    Edge edge = { index, (uint8_t)level, (uint32_t)millis() };
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(inputEngine.queue, &edge, &woken) != pdTRUE) {
+        inputEngine.droppedInIsr++;
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void InputEngine::process() {
+    if (queue == nullptr) {
+        return;
+    }
+
+    Edge edge;
+    while (xQueueReceive(queue, &edge, 0) == pdTRUE) {
+        handleEdge(edge);
+    }
+
+    uint32_t now = millis();
+    for (size_t i = 0; i < (size_t)InputPad::COUNT; i++) {
+        PadState& state = pads[i];
+        if (!state.attached) continue;
+
+        // An edge fell inside the debounce window - settle on the pin level once it has passed.
+        // The level is read back because bounce edges may have overflowed the queue
+        if (state.settlePending && now - state.lastChangeMs >= DEBOUNCE_MS) {
+            state.settlePending = false;
+            state.rawLevel = gpio_get_level((gpio_num_t)state.pin) != 0;
+            if (state.rawLevel != state.pressed) {
+                commit((InputPad)i, state.rawLevel, now);
+            }
+        }
+        if (state.pressed) {
+            checkHold((InputPad)i, now);
+        }
+    }
+}
+
+void InputEngine::handleEdge(const Edge& edge) {
+    if (edge.pad >= (uint8_t)InputPad::COUNT) return;
+    PadState& state = pads[edge.pad];
+    if (!state.attached) return;
+
+    stats.edges++;
+    state.rawLevel = edge.level != 0;
+
+    // Changes right after an accepted one are contact bounce - settled in process()
+    if (edge.timeMs - state.lastChangeMs < DEBOUNCE_MS) {
+        stats.bounces++;
+        state.settlePending = true;
+        return;
+    }
+    if (state.rawLevel == state.pressed) {
+        return;
+    }
+    commit((InputPad)edge.pad, state.rawLevel, edge.timeMs);
+}
+
+void InputEngine::commit(InputPad pad, bool pressed, uint32_t timeMs) {
+    PadState& state = pads[(size_t)pad];
+    state.pressed = pressed;
+    state.lastChangeMs = timeMs;
+
+    if (pressed) {
+        state.pressStartMs = timeMs;
+        state.longFired = false;
+        state.veryLongFired = false;
+        emit(pad, InputGesture::PRESS, 0, timeMs);
+        return;
+    }
+
+    uint32_t heldMs = timeMs - state.pressStartMs;
+    const InputPadConfig& config = state.config;
+    if (heldMs < config.longPressMs) {
+        emit(pad, InputGesture::TAP, heldMs, timeMs);
+    } else if (config.longPressOnRelease && !state.veryLongFired) {
+        bool veryLong = config.veryLongPressMs > 0 && heldMs >= config.veryLongPressMs;
+        emit(pad, veryLong ? InputGesture::VERY_LONG_PRESS : InputGesture::LONG_PRESS, heldMs, timeMs);
+    }
+    emit(pad, InputGesture::RELEASE, heldMs, timeMs);
+    state.suppressed = false;
+}
+
+void InputEngine::checkHold(InputPad pad, uint32_t now) {
+    PadState& state = pads[(size_t)pad];
+    const InputPadConfig& config = state.config;
+    uint32_t heldMs = now - state.pressStartMs;
+
+    if (!config.longPressOnRelease && !state.longFired && heldMs >= config.longPressMs) {
+        state.longFired = true;
+        emit(pad, InputGesture::LONG_PRESS, heldMs, state.pressStartMs + config.longPressMs);
+    }
+    if (config.veryLongPressMs > 0 && !state.veryLongFired && heldMs >= config.veryLongPressMs) {
+        state.veryLongFired = true;
+        emit(pad, InputGesture::VERY_LONG_PRESS, heldMs, state.pressStartMs + config.veryLongPressMs);
+    }
+}
+
+void InputEngine::emit(InputPad pad, InputGesture gesture, uint32_t heldMs, uint32_t edgeMs) {
+    PadState& state = pads[(size_t)pad];
+    if (state.suppressed || state.listener == nullptr) {
+        return;
+    }
+
+    // How long the gesture waited between the edge (or threshold) and delivery
+    uint32_t dispatchMs = millis() - edgeMs;
+    stats.gestures++;
+    stats.totalDispatchMs += dispatchMs;
+    if (dispatchMs > stats.maxDispatchMs) {
+        stats.maxDispatchMs = dispatchMs;
+    }
+
+    state.listener->onInputGesture(pad, gesture, heldMs);
+}
+
+bool InputEngine::waitForInput(TickType_t maxWait) {
+    if (queue == nullptr) {
+        vTaskDelay(maxWait);
+        return false;
+    }
+    Edge edge;
+    return xQueuePeek(queue, &edge, maxWait) == pdTRUE;
+}
+
+TickType_t InputEngine::ticksUntilDeadline() const {
+    uint32_t now = millis();
+    uint32_t nextMs = UINT32_MAX;
+
+    for (size_t i = 0; i < (size_t)InputPad::COUNT; i++) {
+        const PadState& state = pads[i];
+        if (!state.attached) continue;
+
+        uint32_t deadline = UINT32_MAX;
+        if (state.settlePending) {
+            deadline = state.lastChangeMs + DEBOUNCE_MS;
+        } else if (state.pressed && !state.suppressed) {
+            const InputPadConfig& config = state.config;
+            if (!config.longPressOnRelease && !state.longFired) {
+                deadline = state.pressStartMs + config.longPressMs;
+            } else if (config.veryLongPressMs > 0 && !state.veryLongFired) {
+                deadline = state.pressStartMs + config.veryLongPressMs;
+            }
+        }
+        if (deadline == UINT32_MAX) continue;
+
+        uint32_t remaining = (int32_t)(deadline - now) > 0 ? deadline - now : 0;
+        if (remaining < nextMs) {
+            nextMs = remaining;
+        }
+    }
+
+    return nextMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(nextMs);
+}
+
+bool InputEngine::isPressed(InputPad pad) const {
+    return pads[(size_t)pad].pressed;
+}
+
+void InputEngine::reset() {
+    memset(&stats, 0, sizeof(stats));
+    droppedInIsr = 0;
+}
+
+const char* InputEngine::padName(InputPad pad) {
+    switch (pad) {
+        case InputPad::TARE: return "tare";
+        case InputPad::SLEEP: return "sleep";
+        default: return "unknown";
+    }
+}
+
+const char* InputEngine::gestureName(InputGesture gesture) {
+    switch (gesture) {
+        case InputGesture::PRESS: return "press";
+        case InputGesture::RELEASE: return "release";
+        case InputGesture::TAP: return "tap";
+        case InputGesture::LONG_PRESS: return "long_press";
+        case InputGesture::VERY_LONG_PRESS: return "very_long_press";
+        default: return "unknown";
+    }
+}
+
+String InputEngine::toJson() const {
+    String json = "{\"edges\":" + String(stats.edges);
+    json += ",\"bounces\":" + String(stats.bounces);
+    json += ",\"dropped\":" + String(droppedInIsr);
+    json += ",\"gestures\":" + String(stats.gestures);
+    float meanMs = stats.gestures > 0 ? (float)stats.totalDispatchMs / stats.gestures : 0.0f;
+    json += ",\"dispatch_mean_ms\":" + String(meanMs, 1);
+    json += ",\"dispatch_max_ms\":" + String(stats.maxDispatchMs);
+    json += ",\"debounce_ms\":" + String(DEBOUNCE_MS);
+    json += ",\"pads\":[";
+    bool first = true;
+    for (size_t i = 0; i < (size_t)InputPad::COUNT; i++) {
+        const PadState& state = pads[i];
+        if (!state.attached) continue;
+        if (!first) json += ",";
+        first = false;
+        json += "{\"name\":\"" + String(padName((InputPad)i)) + "\"";
+        json += ",\"gpio\":" + String(state.pin);
+        json += ",\"pressed\":" + String(state.pressed ? "true" : "false") + "}";
+    }
+    json += "]}";
+    return json;
+}
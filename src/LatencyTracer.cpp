@@ -0,0 +1,102 @@
+#include "LatencyTracer.h"
+
+LatencyTracer latencyTracer;
+
+// Upper bucket bounds in microseconds - fine below 10 ms (filter/flow), coarse above
+static const uint32_t BUCKET_BOUNDS_US[LatencyTracer::BUCKET_COUNT - 1] = {
+    500, 1000, 2000, 3000, 5000, 7500, 10000, 15000, 20000, 30000,
+    40000, 50000, 75000, 100000, 150000, 200000, 300000, 500000, 1000000
+};
+
+// A capture older than this is a stale sample (e.g. HTTP while the scale is idle), not a latency
+static const uint32_t MAX_TRACKED_AGE_US = 10000000;
+
+LatencyTracer::LatencyTracer() {
+    reset();
+}
+
+void LatencyTracer::reset() {
+    memset(stages, 0, sizeof(stages));
+}
+
+void LatencyTracer::mark(LatencyStage stage, uint32_t captureUs) {
+    if (stage >= LATENCY_STAGE_COUNT || captureUs == 0) {
+        return;
+    }
+    uint32_t ageUs = micros() - captureUs; // Wrap-safe
+    if (ageUs > MAX_TRACKED_AGE_US) {
+        return;
+    }
+
+    StageStats& stats = stages[stage];
+    size_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && ageUs > BUCKET_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+    stats.buckets[bucket]++;
+    stats.count++;
+    stats.totalUs += ageUs;
+    if (ageUs > stats.maxUs) {
+        stats.maxUs = ageUs;
+    }
+}
+
+float LatencyTracer::percentileMs(const StageStats& stats, float fraction) const {
+    if (stats.count == 0) {
+        return 0.0f;
+    }
+    float target = fraction * stats.count;
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        uint32_t inBucket = stats.buckets[b];
+        if (inBucket > 0 && cumulative + inBucket >= target) {
+            // Interpolate linearly inside the bucket; the overflow bucket ends at the max
+            float lower = b == 0 ? 0.0f : BUCKET_BOUNDS_US[b - 1];
+            float upper = b < BUCKET_COUNT - 1 ? BUCKET_BOUNDS_US[b] : stats.maxUs;
+            float position = (target - cumulative) / inBucket;
+            return min(lower + (upper - lower) * position, (float)stats.maxUs) / 1000.0f;
+        }
+        cumulative += inBucket;
+    }
+    return stats.maxUs / 1000.0f;
+}
+
+const char* LatencyTracer::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LATENCY_FILTER: return "filter";
+        case LATENCY_FLOW: return "flow";
+        case LATENCY_BLE_NOTIFY: return "ble_notify";
+        case LATENCY_WS_SEND: return "ws_send";
+        case LATENCY_HTTP_RESPONSE: return "http_response";
+        case LATENCY_OLED_PUSH: return "oled_push";
+        default: return "unknown";
+    }
+}
+
+String LatencyTracer::toJson() const {
+    String json = "{\"stages\":{";
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        const StageStats& stats = stages[i];
+        if (i > 0) json += ",";
+        json += "\"" + String(stageName((LatencyStage)i)) + "\":{";
+        json += "\"count\":" + String(stats.count);
+        json += ",\"mean_ms\":" + String(stats.count > 0 ? stats.totalUs / 1000.0f / stats.count : 0.0f, 2);
+        json += ",\"p50_ms\":" + String(percentileMs(stats, 0.50f), 2);
+        json += ",\"p95_ms\":" + String(percentileMs(stats, 0.95f), 2);
+        json += ",\"p99_ms\":" + String(percentileMs(stats, 0.99f), 2);
+        json += ",\"max_ms\":" + String(stats.maxUs / 1000.0f, 2);
+        json += ",\"buckets\":[";
+        for (size_t b = 0; b < BUCKET_COUNT; b++) {
+            if (b > 0) json += ",";
+            json += String(stats.buckets[b]);
+        }
+        json += "]}";
+    }
+    json += "},\"bucket_bounds_us\":[";
+    for (size_t b = 0; b < BUCKET_COUNT - 1; b++) {
+        if (b > 0) json += ",";
+        json += String(BUCKET_BOUNDS_US[b]);
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,168 @@
+#include "PerformanceProfile.h"
+#include <Preferences.h>
+
+ProfileManager profileManager;
+
+// Battery level has to hold for a while before the profile follows it -
+// voltage sags under load and recovers when the load drops
+static const unsigned long LOW_BATTERY_ENTER_MS = 10000;
+static const unsigned long LOW_BATTERY_LEAVE_MS = 60000;
+
+static const PerformanceProfile PROFILES[(int)ProfileId::COUNT] = {
+    // name, pinFullRate, stableAverageSamples, holdMaxCpu,
+    // bleWeightIntervalMs, bleHeartbeatMs, bleTxPower, connMin, connMax, connLatency,
+    // wifiPowerSave, wifiLatencyBoost, uiPeriodMs
+    { "brew",        true,  0,  true,   50, 1000, ESP_PWR_LVL_P3,  6,  12, 0, WIFI_PS_NONE,      true,   25 },
+    { "dose",        false, 0,  false,  50, 2000, ESP_PWR_LVL_N0, 12,  24, 0, WIFI_PS_MAX_MODEM, true,   25 },
+    { "idle",        false, 6,  false, 200, 2000, ESP_PWR_LVL_N0, 24,  48, 4, WIFI_PS_MAX_MODEM, true,  100 },
+    { "low_battery", false, 10, false, 250, 2000, ESP_PWR_LVL_N6, 48,  96, 4, WIFI_PS_MAX_MODEM, false, 150 },
+};
+
+ProfileManager::ProfileManager()
+    : active(&PROFILES[(int)ProfileId::DOSE]), activeId(ProfileId::DOSE), profileGeneration(0),
+      selectedId(ProfileId::DOSE), batteryOverride(false), lowSinceMs(0), okSinceMs(0), switches(0) {
+}
+
+void ProfileManager::begin() {
+    Preferences prefs;
+    uint8_t saved = (uint8_t)ProfileId::DOSE;
+    if (prefs.begin("profile", true)) {
+        saved = prefs.getUChar("active", saved);
+        prefs.end();
+    }
+    if (saved >= (uint8_t)ProfileId::LOW_BATTERY) {
+        saved = (uint8_t)ProfileId::DOSE; // LOW_BATTERY is never a manual choice
+    }
+    selectedId = (ProfileId)saved;
+    apply(selectedId, EventSource::SYSTEM);
+    Serial.printf("Performance profile: %s\n", name(selectedId));
+}
+
+const PerformanceProfile& ProfileManager::get(ProfileId id) {
+    if ((uint8_t)id >= (uint8_t)ProfileId::COUNT) {
+        id = ProfileId::DOSE;
+    }
+    return PROFILES[(int)id];
+}
+
+const char* ProfileManager::name(ProfileId id) {
+    return get(id).name;
+}
+
+bool ProfileManager::fromName(const String& profileName, ProfileId& id) {
+    for (int i = 0; i < (int)ProfileId::COUNT; i++) {
+        if (profileName.equalsIgnoreCase(PROFILES[i].name)) {
+            id = (ProfileId)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProfileManager::apply(ProfileId id, EventSource source) {
+    // Pointer first, then the generation - a task that sees the new
+    // generation is guaranteed to read the new profile
+    active = &PROFILES[(int)id];
+    activeId = id;
+    profileGeneration = profileGeneration + 1;
+    switches++;
+    Serial.printf("Performance profile -> %s (%s)\n", PROFILES[(int)id].name, EventBus::sourceName(source));
+    controlEvents.publish(ControlEventType::SETTINGS_CHANGED, source, SETTINGS_PROFILE);
+}
+
+bool ProfileManager::request(ProfileId id, EventSource source) {
+    if ((uint8_t)id >= (uint8_t)ProfileId::COUNT) {
+        return false;
+    }
+    return controlEvents.publish(ControlEventType::PROFILE, source, (uint16_t)id);
+}
+
+void ProfileManager::requestCycle(EventSource source) {
+    controlEvents.publish(ControlEventType::PROFILE, source, ARG_CYCLE);
+}
+
+ProfileId ProfileManager::nextInCycle() const {
+    // LOW_BATTERY is left out of the rotation
+    return (ProfileId)(((uint8_t)selectedId + 1) % (uint8_t)ProfileId::LOW_BATTERY);
+}
+
+void ProfileManager::handleRequest(const ControlEvent& event) {
+    uint16_t arg = event.arg & ~ARG_AUTO;
+    bool automatic = (event.arg & ARG_AUTO) != 0;
+    if (arg == ARG_CYCLE) {
+        arg = (uint16_t)nextInCycle();
+    }
+    if (arg >= (uint16_t)ProfileId::COUNT) {
+        return;
+    }
+    select((ProfileId)arg, event.source, automatic);
+}
+
+void ProfileManager::select(ProfileId id, EventSource source, bool automatic) {
+    if (automatic) {
+        // Battery switches: into LOW_BATTERY, or back to the saved choice
+        batteryOverride = id == ProfileId::LOW_BATTERY;
+    } else {
+        if (id != ProfileId::LOW_BATTERY && id != selectedId) {
+            Preferences prefs;
+            if (prefs.begin("profile", false)) {
+                prefs.putUChar("active", (uint8_t)id);
+                prefs.end();
+            }
+            selectedId = id;
+        }
+        // A manual choice overrides the automatic low-battery switch until the battery recovers
+        batteryOverride = false;
+    }
+    if (id != activeId) {
+        apply(id, source);
+    }
+}
+
+void ProfileManager::updateBattery(bool low) {
+    unsigned long now = millis();
+    if (low) {
+        okSinceMs = 0;
+        if (lowSinceMs == 0) lowSinceMs = now;
+        // Never pulled out from under a running shot - BREW is left by hand
+        if (!batteryOverride && activeId != ProfileId::LOW_BATTERY && activeId != ProfileId::BREW &&
+            now - lowSinceMs >= LOW_BATTERY_ENTER_MS) {
+            lowSinceMs = now; // Retry later if the request is dropped
+            controlEvents.publish(ControlEventType::PROFILE, EventSource::SYSTEM,
+                                  (uint16_t)ProfileId::LOW_BATTERY | ARG_AUTO);
+        }
+    } else {
+        lowSinceMs = 0;
+        if (okSinceMs == 0) okSinceMs = now;
+        if (batteryOverride && now - okSinceMs >= LOW_BATTERY_LEAVE_MS) {
+            okSinceMs = now;
+            controlEvents.publish(ControlEventType::PROFILE, EventSource::SYSTEM,
+                                  (uint16_t)selectedId | ARG_AUTO);
+        }
+    }
+}
+
+String ProfileManager::toJson() const {
+    const PerformanceProfile& p = current();
+    String json = "{\"active\":\"" + String(p.name) + "\"";
+    json += ",\"selected\":\"" + String(name(selectedId)) + "\"";
+    json += ",\"battery_override\":" + String(batteryOverride ? "true" : "false");
+    json += ",\"switches\":" + String(switches);
+    json += ",\"settings\":{\"pin_full_rate\":" + String(p.pinFullRate ? "true" : "false");
+    json += ",\"stable_average_samples\":" + String(p.stableAverageSamples);
+    json += ",\"hold_max_cpu\":" + String(p.holdMaxCpu ? "true" : "false");
+    json += ",\"ble_weight_interval_ms\":" + String(p.bleWeightIntervalMs);
+    json += ",\"ble_heartbeat_ms\":" + String(p.bleHeartbeatMs);
+    json += ",\"ble_conn_interval_ms\":[" + String(p.bleConnIntervalMin * 1.25f, 2) + "," + String(p.bleConnIntervalMax * 1.25f, 2) + "]";
+    json += ",\"ble_conn_latency\":" + String(p.bleConnLatency);
+    json += ",\"wifi_power_save\":" + String((int)p.wifiPowerSave);
+    json += ",\"wifi_latency_boost\":" + String(p.wifiLatencyBoost ? "true" : "false");
+    json += ",\"ui_period_ms\":" + String(p.uiPeriodMs) + "}";
+    json += ",\"available\":[";
+    for (int i = 0; i < (int)ProfileId::COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "\"" + String(PROFILES[i].name) + "\"";
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,187 @@
+#include "PourSegmenter.h"
+#include "Scale.h"
+#include "ShotAnalytics.h"
+
+PourSegmenter::PourSegmenter(Scale* scale)
+    : scalePtr(scale), analyticsPtr(nullptr), enabled(false), phase(PourPhase::IDLE),
+      pourCount(0), sessionStarted(false), sessionStartUs(0), lastPourEndMs(0),
+      windowHead(0), windowCount(0), riseSamples(0), slowing(false), slowSinceMs(0),
+      nearZeroSinceMs(0), lastSequence(0) {}
+
+void PourSegmenter::begin() {
+    preferences.begin("brew", true);
+    enabled = preferences.getBool("pourover", false);
+    preferences.end();
+    applyFilter();
+    Serial.printf("PourSegmenter: pour-over mode %s\n", enabled ? "enabled" : "disabled");
+}
+
+void PourSegmenter::setEnabled(bool value) {
+    enabled = value;
+    reset();
+
+    preferences.begin("brew", false);
+    preferences.putBool("pourover", enabled);
+    preferences.end();
+    Serial.printf("PourSegmenter: pour-over mode %s\n", enabled ? "enabled" : "disabled");
+}
+
+void PourSegmenter::setShotAnalytics(ShotAnalytics* analytics) {
+    analyticsPtr = analytics;
+}
+
+void PourSegmenter::reset() {
+    phase = PourPhase::IDLE;
+    pourCount = 0;
+    sessionStarted = false;
+    lastPourEndMs = 0;
+    riseSamples = 0;
+    slowing = false;
+    nearZeroSinceMs = 0;
+    applyFilter();
+}
+
+void PourSegmenter::update(const TelemetrySample& sample, float unfilteredWeight) {
+    if (!enabled || sample.sequence == lastSequence) {
+        return;
+    }
+    lastSequence = sample.sequence;
+
+    windowWeight[windowHead] = unfilteredWeight;
+    windowTimeUs[windowHead] = sample.timestampUs;
+    windowHead = (windowHead + 1) % SLOPE_WINDOW;
+    if (windowCount < SLOPE_WINDOW) windowCount++;
+
+    uint32_t nowMs = sessionStarted ? (sample.timestampUs - sessionStartUs) / 1000 : 0;
+    float rate = slope();
+
+    // Empty scale (dripper removed or tared) ends the session
+    if (phase != PourPhase::POURING && pourCount > 0 && fabsf(sample.weight) < EMPTY_WEIGHT) {
+        uint32_t nowWallMs = millis();
+        if (nearZeroSinceMs == 0) {
+            nearZeroSinceMs = nowWallMs;
+        } else if (nowWallMs - nearZeroSinceMs >= EMPTY_HOLD_MS) {
+            Serial.println("PourSegmenter: scale emptied - session reset");
+            reset();
+            return;
+        }
+    } else {
+        nearZeroSinceMs = 0;
+    }
+
+    if (phase != PourPhase::POURING) {
+        riseSamples = rate > POUR_START_RATE ? riseSamples + 1 : 0;
+        if (riseSamples >= POUR_CONFIRM_SAMPLES) {
+            riseSamples = 0;
+            // Back-date to the start of the slope window - the pour began there
+            size_t oldest = (windowHead + SLOPE_WINDOW - windowCount) % SLOPE_WINDOW;
+            if (!sessionStarted) {
+                sessionStarted = true;
+                sessionStartUs = windowTimeUs[oldest];
+            }
+            uint32_t startMs = (windowTimeUs[oldest] - sessionStartUs) / 1000;
+            startPour(startMs, windowWeight[oldest]);
+        }
+        return;
+    }
+
+    // Keep the running pour's figures live for the dashboard
+    PourSegment& pour = pours[pourCount - 1];
+    pour.durationMs = nowMs > pour.startMs ? nowMs - pour.startMs : 0;
+    pour.volume = max(0.0f, sample.weight - pour.startWeight);
+
+    // POURING: the pour ends once the weight stays flat for a moment
+    if (rate < POUR_END_RATE) {
+        if (!slowing) {
+            slowing = true;
+            slowSinceMs = nowMs;
+        } else if (nowMs - slowSinceMs >= PAUSE_HOLD_MS) {
+            endPour(slowSinceMs, sample.weight);
+        }
+    } else {
+        slowing = false;
+    }
+}
+
+float PourSegmenter::slope() const {
+    if (windowCount < 2) {
+        return 0.0f;
+    }
+    size_t newest = (windowHead + SLOPE_WINDOW - 1) % SLOPE_WINDOW;
+    size_t oldest = (windowHead + SLOPE_WINDOW - windowCount) % SLOPE_WINDOW;
+    uint32_t dtUs = windowTimeUs[newest] - windowTimeUs[oldest];
+    if (dtUs == 0) {
+        return 0.0f;
+    }
+    return (windowWeight[newest] - windowWeight[oldest]) * 1000000.0f / (float)dtUs;
+}
+
+void PourSegmenter::startPour(uint32_t nowMs, float weight) {
+    phase = PourPhase::POURING;
+    slowing = false;
+
+    if (pourCount < MAX_POURS) {
+        PourSegment& pour = pours[pourCount++];
+        pour.startMs = nowMs;
+        pour.durationMs = 0;
+        pour.pauseBeforeMs = pourCount > 1 && nowMs > lastPourEndMs ? nowMs - lastPourEndMs : 0;
+        pour.startWeight = weight;
+        pour.volume = 0.0f;
+        pour.flowRate = 0.0f;
+    }
+    // Past MAX_POURS the last entry keeps growing instead
+
+    applyFilter();
+    Serial.printf("PourSegmenter: pour %u started at %.1fs (%.1fg)\n",
+                  (unsigned)pourCount, nowMs / 1000.0f, weight);
+    if (analyticsPtr) {
+        analyticsPtr->publish(ShotEventType::POUR_STARTED, nowMs, weight, (float)pourCount);
+    }
+}
+
+void PourSegmenter::endPour(uint32_t nowMs, float weight) {
+    phase = PourPhase::PAUSE;
+    slowing = false;
+    lastPourEndMs = nowMs;
+
+    PourSegment& pour = pours[pourCount - 1];
+    pour.durationMs = nowMs > pour.startMs ? nowMs - pour.startMs : 0;
+    pour.volume = max(0.0f, weight - pour.startWeight);
+    pour.flowRate = pour.durationMs > 0 ? pour.volume * 1000.0f / pour.durationMs : 0.0f;
+
+    applyFilter();
+    Serial.printf("PourSegmenter: pour %u ended - %.1fg in %.1fs (%.2f g/s)\n", (unsigned)pourCount,
+                  pour.volume, pour.durationMs / 1000.0f, pour.flowRate);
+    if (analyticsPtr) {
+        analyticsPtr->publish(ShotEventType::POUR_ENDED, nowMs, weight, pour.volume);
+    }
+}
+
+void PourSegmenter::applyFilter() {
+    if (scalePtr == nullptr) {
+        return;
+    }
+    if (!enabled || phase == PourPhase::IDLE) {
+        scalePtr->setFilterOverride(Scale::FILTER_AUTO);
+    } else if (phase == PourPhase::POURING) {
+        scalePtr->setFilterOverride(Scale::FILTER_FAST);
+    } else {
+        scalePtr->setFilterOverride(Scale::FILTER_SMOOTH);
+    }
+}
+
+float PourSegmenter::getTotalVolume() const {
+    float total = 0.0f;
+    for (size_t i = 0; i < pourCount; i++) {
+        total += pours[i].volume;
+    }
+    return total;
+}
+
+const char* PourSegmenter::phaseName(PourPhase phase) {
+    switch (phase) {
+        case PourPhase::POURING: return "pouring";
+        case PourPhase::PAUSE: return "pause";
+        default: return "idle";
+    }
+}
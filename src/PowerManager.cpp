@@ -1,11 +1,12 @@
 #include "PowerManager.h"
 #include "Display.h"
+#include "EventBus.h"
+#include "RetainedState.h"
+#include "UlpWake.h"
 
 PowerManager::PowerManager(uint8_t sleepTouchPin, Display* display) 
     : sleepTouchPin(sleepTouchPin), displayPtr(display), sleepTouchThreshold(0),
-      lastSleepTouchState(false), lastSleepTouchTime(0), touchStartTime(0),
-      debounceDelay(200), sleepCountdownStart(0), sleepCountdownActive(false),
-      longPressDetected(false), cancelledRecently(false), cancelTime(0),
+      sleepCountdownStart(0), sleepCountdownActive(false), sleepCountdownShown(0), ignoreUntilRelease(false),
       timerState(TimerState::STOPPED), lastTimerControlTime(0) {
 }
 
@@ -14,9 +15,10 @@ void PowerManager::begin() {
     // This prevents false triggers when no touch sensor is connected
     pinMode(sleepTouchPin, INPUT_PULLDOWN);
     
-    // Configure external wake-up on the touch pin
-    // Wake up when pin goes HIGH (touch sensor outputs HIGH when touched)
-    esp_sleep_enable_ext0_wakeup((gpio_num_t)sleepTouchPin, 1);
+    // Tap for timer control, hold 1 second for sleep - the input engine also
+    // makes the pin a light-sleep wake source
+    InputPadConfig config = { SLEEP_PRESS_DURATION, 0, false };
+    inputEngine.attach(InputPad::SLEEP, sleepTouchPin, config, this);
     
     Serial.println("Power Manager initialized. Sleep touch sensor on GPIO" + String(sleepTouchPin));
     Serial.println("Using EXT0 wake-up (digital touch sensor) with pull-down resistor");
@@ -24,14 +26,8 @@ void PowerManager::begin() {
 }
 
 void PowerManager::update() {
-    bool currentSleepTouchState = isSleepTouchPressed();
     unsigned long currentTime = millis();
     
-    // Clear recent cancellation flag after 1 second
-    if (cancelledRecently && (currentTime - cancelTime) > 1000) {
-        cancelledRecently = false;
-    }
-    
     // Handle sleep countdown
     if (sleepCountdownActive) {
         unsigned long elapsed = currentTime - sleepCountdownStart;
@@ -42,7 +38,10 @@ void PowerManager::update() {
                 int countdownElapsed = (elapsed - 1500) / 1000; // Countdown time since 1.5s mark
                 int remainingSeconds = 3 - countdownElapsed;
                 
-                if (remainingSeconds > 0 && (elapsed - 1500) % 1000 < 100) {
+                // Draw on each change - the UI task may run only every few hundred ms
+                // (low battery profile), so a narrow window after each second is missed
+                if (remainingSeconds > 0 && remainingSeconds != sleepCountdownShown) {
+                    sleepCountdownShown = remainingSeconds;
                     showSleepCountdown(remainingSeconds);
                 }
             }
@@ -51,52 +50,45 @@ void PowerManager::update() {
             enterDeepSleep();
         }
     }
-    
-    // Handle touch state changes with long press detection
-    if (currentSleepTouchState != lastSleepTouchState) {
-        if (currentTime - lastSleepTouchTime > debounceDelay) {
-            if (currentSleepTouchState) {
-                // Touch started
-                if (sleepCountdownActive) {
-                    // Touch during countdown - cancel sleep
-                    sleepCountdownActive = false;
-                    longPressDetected = false;
-                    cancelledRecently = true;
-                    cancelTime = currentTime;
-                    Serial.println("Sleep cancelled - touch pressed during countdown");
-                    if (displayPtr != nullptr) {
-                        displayPtr->showSleepCancelledMessage();
-                    }
-                } else if (!cancelledRecently) {
-                    // Handle timer control
-                    touchStartTime = currentTime;
-                    longPressDetected = false;
-                    Serial.println("Timer control touch started");
+}
+
+void PowerManager::onInputGesture(InputPad pad, InputGesture gesture, uint32_t heldMs) {
+    switch (gesture) {
+        case InputGesture::PRESS:
+            if (sleepCountdownActive) {
+                // Touch during countdown - cancel sleep
+                sleepCountdownActive = false;
+                ignoreUntilRelease = true;
+                Serial.println("Sleep cancelled - touch pressed during countdown");
+                if (displayPtr != nullptr) {
+                    displayPtr->showSleepCancelledMessage();
                 }
             } else {
-                // Touch ended
-                if (!sleepCountdownActive && !longPressDetected && !cancelledRecently) {
-                    // Handle timer control
-                    Serial.println("Timer control executed");
-                    handleTimerControl();
-                }
-                // Don't reset longPressDetected here if countdown is active
-                if (!sleepCountdownActive) {
-                    longPressDetected = false;
-                }
+                Serial.println("Timer control touch started");
             }
-            lastSleepTouchState = currentSleepTouchState;
-            lastSleepTouchTime = currentTime;
-        }
-    }
-    
-    // Check for long press (1 second) for sleep functionality
-    if (currentSleepTouchState && !longPressDetected && !sleepCountdownActive && !cancelledRecently) {
-        if (currentTime - touchStartTime >= 1000) {
-            longPressDetected = true;
-            Serial.println("Sleep control executed");
-            handleSleepTouch();
-        }
+            break;
+            
+        case InputGesture::TAP:
+            if (!ignoreUntilRelease && !sleepCountdownActive) {
+                Serial.println("Timer control executed");
+                handleTimerControl();
+            }
+            break;
+            
+        case InputGesture::LONG_PRESS:
+            // Long press (1 second) for sleep functionality
+            if (!ignoreUntilRelease && !sleepCountdownActive) {
+                Serial.println("Sleep control executed");
+                handleSleepTouch();
+            }
+            break;
+            
+        case InputGesture::RELEASE:
+            ignoreUntilRelease = false;
+            break;
+            
+        default:
+            break;
     }
 }
 
@@ -110,10 +102,27 @@ void PowerManager::enterDeepSleep() {
         displayPtr->clear();
     }
     
+    // Configure external wake-up on the touch pin
+    // Wake up when pin goes HIGH (touch sensor outputs HIGH when touched).
+    // Armed only now - EXT0 also applies to light sleep and would move the pin
+    // to the RTC mux, away from the input engine's interrupt
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)sleepTouchPin, 1);
+    
     // Print wake-up configuration for debugging
     Serial.println("Wake-up configured for EXT0 on GPIO" + String(sleepTouchPin));
     Serial.println("Will wake when pin goes HIGH");
     
+    // Keep tare, calibration, filter settings and the WiFi association in
+    // RTC memory so the wake path can skip probing, taring and the splash
+    if (scalePtr != nullptr) {
+        RetainedState::save(*scalePtr);
+        
+        // Cup on the scale wakes it too (ULP builds only)
+        if (UlpWake::arm(*scalePtr)) {
+            Serial.println("Will also wake on a weight change");
+        }
+    }
+    
     // Flush serial output
     Serial.flush();
     
@@ -144,10 +153,15 @@ void PowerManager::setDisplay(Display* display) {
     displayPtr = display;
 }
 
+void PowerManager::setScale(Scale* scale) {
+    scalePtr = scale;
+}
+
 void PowerManager::handleSleepTouch() {
     // Only called after long press detection
     sleepCountdownActive = true;
     sleepCountdownStart = millis();
+    sleepCountdownShown = 0;
     Serial.println("Long press detected! Starting 3-second sleep countdown...");
     if (displayPtr != nullptr) {
         displayPtr->showSleepMessage();
@@ -173,25 +187,34 @@ void PowerManager::handleTimerControl() {
     lastTimerControlTime = currentTime;
     Serial.println("Timer control triggered");
     
+    // The timer may have been started/stopped elsewhere (web, BLE, auto-timer)
+    if (displayPtr->isTimerRunning()) {
+        timerState = TimerState::RUNNING;
+    } else if (displayPtr->getElapsedTime() > 0) {
+        timerState = TimerState::PAUSED;
+    } else {
+        timerState = TimerState::STOPPED;
+    }
+    
     // Unified mode timer control
     switch (timerState) {
         case TimerState::STOPPED:
             // First tap - start timer
-            displayPtr->startTimer();
+            controlEvents.publish(ControlEventType::TIMER_START, EventSource::TOUCH);
             timerState = TimerState::RUNNING;
             Serial.println("Timer started");
             break;
             
         case TimerState::RUNNING:
             // Second tap - stop/pause timer
-            displayPtr->stopTimer();
+            controlEvents.publish(ControlEventType::TIMER_STOP, EventSource::TOUCH);
             timerState = TimerState::PAUSED;
             Serial.println("Timer stopped/paused");
             break;
             
         case TimerState::PAUSED:
             // Third tap - reset timer
-            displayPtr->resetTimer();
+            controlEvents.publish(ControlEventType::TIMER_RESET, EventSource::TOUCH);
             timerState = TimerState::STOPPED;
             Serial.println("Timer reset");
             break;
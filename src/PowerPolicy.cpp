@@ -0,0 +1,115 @@
+#include "PowerPolicy.h"
+#include <sdkconfig.h>
+
+PowerPolicy powerPolicy;
+
+PowerPolicy::PowerPolicy() : enabled(false), lightSleep(false), startMs(0) {
+    memset(locks, 0, sizeof(locks));
+}
+
+bool PowerPolicy::begin() {
+    startMs = millis();
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32s3_t config = {};
+    config.max_freq_mhz = MAX_CPU_MHZ;
+    config.min_freq_mhz = MIN_CPU_MHZ;
+    config.light_sleep_enable = true;
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_OK) {
+        lightSleep = true;
+    } else {
+        // Automatic light sleep needs tickless idle in the SDK build - fall back to DFS only
+        Serial.printf("PowerPolicy: light sleep unavailable (%s), using DFS only\n", esp_err_to_name(err));
+        config.light_sleep_enable = false;
+        err = esp_pm_configure(&config);
+    }
+    if (err != ESP_OK) {
+        Serial.printf("PowerPolicy: esp_pm_configure failed (%s) - running at full clock\n", esp_err_to_name(err));
+        return false;
+    }
+
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        const char* name = lockName((PowerLock)i);
+        if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, name, &locks[i].cpuLock) != ESP_OK) {
+            locks[i].cpuLock = nullptr;
+        }
+    }
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "acquire_nosleep", &locks[POWER_LOCK_ACQUIRE].sleepLock) != ESP_OK) {
+        locks[POWER_LOCK_ACQUIRE].sleepLock = nullptr;
+    }
+    enabled = true;
+    Serial.printf("PowerPolicy: DFS %d-%d MHz, light sleep %s\n",
+                  MIN_CPU_MHZ, MAX_CPU_MHZ, lightSleep ? "ON" : "OFF");
+    return true;
+#else
+    Serial.println("PowerPolicy: power management not enabled in this SDK build");
+    return false;
+#endif
+}
+
+void PowerPolicy::setActive(PowerLock lock, bool active) {
+    LockState& state = locks[lock];
+    if (state.active == active) {
+        return;
+    }
+    unsigned long now = millis();
+    if (active) {
+        state.activeSinceMs = now;
+        state.acquisitions++;
+    } else {
+        state.totalActiveMs += now - state.activeSinceMs;
+    }
+    state.active = active;
+
+    if (!enabled) {
+        return; // Still tracked for /api/power
+    }
+    if (active) {
+        if (state.cpuLock) esp_pm_lock_acquire(state.cpuLock);
+        if (state.sleepLock) esp_pm_lock_acquire(state.sleepLock);
+    } else {
+        if (state.sleepLock) esp_pm_lock_release(state.sleepLock);
+        if (state.cpuLock) esp_pm_lock_release(state.cpuLock);
+    }
+}
+
+bool PowerPolicy::isIdle() const {
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        if (locks[i].active) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* PowerPolicy::lockName(PowerLock lock) {
+    switch (lock) {
+        case POWER_LOCK_ACQUIRE: return "acquire";
+        case POWER_LOCK_BLE: return "ble";
+        case POWER_LOCK_HTTP: return "http";
+        case POWER_LOCK_PROFILE: return "profile";
+        default: return "unknown";
+    }
+}
+
+String PowerPolicy::toJson() const {
+    unsigned long now = millis();
+    String json = "{\"enabled\":" + String(enabled ? "true" : "false");
+    json += ",\"light_sleep\":" + String(lightSleep ? "true" : "false");
+    json += ",\"min_mhz\":" + String(MIN_CPU_MHZ);
+    json += ",\"max_mhz\":" + String(MAX_CPU_MHZ);
+    json += ",\"idle\":" + String(isIdle() ? "true" : "false");
+    json += ",\"uptime_ms\":" + String(now - startMs);
+    json += ",\"locks\":[";
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        const LockState& state = locks[i];
+        unsigned long activeMs = state.totalActiveMs + (state.active ? now - state.activeSinceMs : 0);
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + String(lockName((PowerLock)i)) + "\"";
+        json += ",\"active\":" + String(state.active ? "true" : "false");
+        json += ",\"active_ms\":" + String(activeMs);
+        json += ",\"acquisitions\":" + String(state.acquisitions) + "}";
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,139 @@
+#include "Profiler.h"
+
+#ifdef WMB_PROFILING
+
+#include <esp_freertos_hooks.h>
+
+const uint32_t Profiler::BUCKET_BOUNDS_US[Profiler::BUCKET_COUNT - 1] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000
+};
+
+static const char* const POINT_NAMES[PROFILE_POINT_COUNT] = {
+    "scale_read", "flow_update", "ble_update", "wifi_maintain",
+    "touch_update", "battery_update", "display_update"
+};
+
+struct ProfileStats {
+    uint32_t buckets[Profiler::BUCKET_COUNT];
+    uint32_t count;
+    uint64_t totalUs;
+    uint32_t maxUs;       // Since boot (or the last reset)
+    uint32_t windowMaxUs; // Current window
+    uint32_t lastWindowMaxUs;
+};
+
+static ProfileStats stats[PROFILE_POINT_COUNT];
+
+// Idle accounting - consecutive hook calls closer than this are idle time,
+// a longer gap means a task or an interrupt ran in between
+static const uint32_t IDLE_GAP_US = 50;
+static const int CORE_COUNT = portNUM_PROCESSORS;
+
+static volatile uint32_t lastIdleHookUs[CORE_COUNT];
+static volatile uint32_t idleUs[CORE_COUNT];
+static float idlePercent[CORE_COUNT];
+static uint32_t windowStartUs = 0;
+
+static inline bool idleHook(int core) {
+    uint32_t now = micros();
+    uint32_t gap = now - lastIdleHookUs[core];
+    if (gap < IDLE_GAP_US) {
+        idleUs[core] = idleUs[core] + gap;
+    }
+    lastIdleHookUs[core] = now;
+    return false; // Keep spinning instead of WFI so the next gap is measured too
+}
+
+static bool idleHookCore0() { return idleHook(0); }
+static bool idleHookCore1() { return idleHook(1); }
+
+void Profiler::begin() {
+    reset();
+    windowStartUs = micros();
+    esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+    if (CORE_COUNT > 1) {
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+    }
+    Serial.println("Profiler: enabled - idle hooks registered, WFI disabled while profiling");
+}
+
+void Profiler::reset() {
+    memset(stats, 0, sizeof(stats));
+}
+
+void Profiler::record(ProfilePoint point, uint32_t cycles) {
+    if (point >= PROFILE_POINT_COUNT) {
+        return;
+    }
+    // Read the clock per sample - the CPU frequency can change at runtime
+    uint32_t us = cycles / getCpuFrequencyMhz();
+    ProfileStats& s = stats[point];
+
+    size_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && us > BUCKET_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+    s.buckets[bucket]++;
+    s.count++;
+    s.totalUs += us;
+    if (us > s.maxUs) s.maxUs = us;
+    if (us > s.windowMaxUs) s.windowMaxUs = us;
+}
+
+void Profiler::sample() {
+    uint32_t now = micros();
+    uint32_t windowUs = now - windowStartUs;
+    if (windowUs == 0) {
+        return;
+    }
+    windowStartUs = now;
+
+    for (int core = 0; core < CORE_COUNT; core++) {
+        uint32_t idle = idleUs[core];
+        idleUs[core] = 0;
+        idlePercent[core] = min(100.0f, idle * 100.0f / windowUs);
+    }
+    for (size_t i = 0; i < PROFILE_POINT_COUNT; i++) {
+        stats[i].lastWindowMaxUs = stats[i].windowMaxUs;
+        stats[i].windowMaxUs = 0;
+    }
+}
+
+String Profiler::toJson() {
+    String json = "{\"enabled\":true,\"cpu_mhz\":" + String(getCpuFrequencyMhz());
+
+    json += ",\"idle_percent\":[";
+    for (int core = 0; core < CORE_COUNT; core++) {
+        if (core > 0) json += ",";
+        json += String(idlePercent[core], 1);
+    }
+    json += "]";
+
+    json += ",\"bucket_bounds_us\":[";
+    for (size_t b = 0; b < BUCKET_COUNT - 1; b++) {
+        if (b > 0) json += ",";
+        json += String(BUCKET_BOUNDS_US[b]);
+    }
+    json += "]";
+
+    json += ",\"points\":{";
+    for (size_t i = 0; i < PROFILE_POINT_COUNT; i++) {
+        const ProfileStats& s = stats[i];
+        if (i > 0) json += ",";
+        json += "\"" + String(POINT_NAMES[i]) + "\":{";
+        json += "\"count\":" + String(s.count);
+        json += ",\"mean_us\":" + String(s.count > 0 ? (float)s.totalUs / s.count : 0.0f, 1);
+        json += ",\"max_us\":" + String(s.maxUs);
+        json += ",\"window_max_us\":" + String(s.lastWindowMaxUs);
+        json += ",\"buckets\":[";
+        for (size_t b = 0; b < BUCKET_COUNT; b++) {
+            if (b > 0) json += ",";
+            json += String(s.buckets[b]);
+        }
+        json += "]}";
+    }
+    json += "}}";
+    return json;
+}
+
+#endif
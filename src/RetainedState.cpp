@@ -0,0 +1,67 @@
+#include "RetainedState.h"
+#include "Scale.h"
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+
+static const uint32_t RETAINED_MAGIC = 0x574D4252; // "WMBR"
+static const uint16_t RETAINED_VERSION = 2;
+
+struct RetainedBlock {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    RetainedScaleState scale;
+    WiFiAssociation wifi;
+    uint32_t crc; // Over everything above
+};
+
+// Survives deep sleep, cleared (garbage) after power-on
+RTC_DATA_ATTR static RetainedBlock retained;
+
+static int8_t validity = -1; // -1 unchecked, 0 invalid, 1 valid
+
+uint32_t RetainedState::checksum() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&retained, offsetof(RetainedBlock, crc));
+}
+
+bool RetainedState::isValid() {
+    if (validity < 0) {
+        bool valid = esp_reset_reason() == ESP_RST_DEEPSLEEP &&
+                     retained.magic == RETAINED_MAGIC &&
+                     retained.version == RETAINED_VERSION &&
+                     retained.size == sizeof(RetainedBlock) &&
+                     retained.crc == checksum();
+        validity = valid ? 1 : 0;
+        Serial.printf("RetainedState: %s\n", valid ? "valid - fast resume" : "not valid - full init");
+    }
+    return validity == 1;
+}
+
+const RetainedScaleState& RetainedState::scale() {
+    return retained.scale;
+}
+
+bool RetainedState::wifiAssociation(WiFiAssociation& association) {
+    if (!isValid() || !retained.wifi.valid) {
+        return false;
+    }
+    association = retained.wifi;
+    return true;
+}
+
+void RetainedState::save(const Scale& scale) {
+    memset(&retained, 0, sizeof(retained));
+    retained.magic = RETAINED_MAGIC;
+    retained.version = RETAINED_VERSION;
+    retained.size = sizeof(RetainedBlock);
+    scale.exportRetained(retained.scale);
+    getWiFiAssociation(retained.wifi);
+    retained.crc = checksum();
+    Serial.println("RetainedState: saved for wake");
+}
+
+void RetainedState::invalidate() {
+    retained.magic = 0;
+    validity = 0;
+}
@@ -0,0 +1,82 @@
+#include "SampleBus.h"
+
+SampleBus::SampleBus() : published(0), lastSequence(0) {}
+
+void SampleBus::publish(const TelemetrySample& sample) {
+    ring[published % CAPACITY] = sample;
+    // Make the slot visible before the new count
+    __sync_synchronize();
+    published = published + 1;
+    lastSequence = sample.sequence;
+}
+
+bool SampleBus::copy(uint32_t index, TelemetrySample& sample) const {
+    sample = ring[index % CAPACITY];
+    __sync_synchronize();
+    // The writer only touches this slot again when publishing index + CAPACITY
+    return published - index < CAPACITY;
+}
+
+bool SampleBus::latest(TelemetrySample& sample) const {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        uint32_t count = published;
+        if (count == 0) {
+            return false;
+        }
+        if (copy(count - 1, sample)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SampleBus::read(SampleCursor& cursor, TelemetrySample& sample) {
+    uint32_t count = published;
+    if (cursor.position == count) {
+        return false;
+    }
+
+    if (cursor.policy == SamplePolicy::EVERY) {
+        // Fell a whole ring behind - continue with the oldest sample still held
+        if (count - cursor.position >= CAPACITY) {
+            uint32_t resume = count - CAPACITY + 1;
+            cursor.overruns += resume - cursor.position;
+            cursor.position = resume;
+        }
+        if (!copy(cursor.position, sample)) {
+            cursor.overruns++;
+            cursor.position++;
+            return false;
+        }
+        cursor.position++;
+        cursor.delivered++;
+        cursor.lastDeliveredUs = sample.timestampUs;
+        cursor.lastDeliveredWeight = sample.weight;
+        cursor.hasDelivered = true;
+        return true;
+    }
+
+    // LATEST: jump to the head, everything in between is superseded
+    if (!copy(count - 1, sample)) {
+        return false; // Writer lapped us mid-copy - try again next time
+    }
+    cursor.skipped += count - cursor.position - 1;
+    cursor.position = count;
+
+    if (cursor.hasDelivered) {
+        if (cursor.minIntervalUs > 0 && sample.timestampUs - cursor.lastDeliveredUs < cursor.minIntervalUs) {
+            cursor.skipped++;
+            return false;
+        }
+        if (cursor.deadband > 0.0f && fabsf(sample.weight - cursor.lastDeliveredWeight) < cursor.deadband) {
+            cursor.skipped++;
+            return false;
+        }
+    }
+
+    cursor.delivered++;
+    cursor.lastDeliveredUs = sample.timestampUs;
+    cursor.lastDeliveredWeight = sample.weight;
+    cursor.hasDelivered = true;
+    return true;
+}
@@ -1,7 +1,7 @@
 #include "Scale.h"
+#include "RetainedState.h"
 #include "WebServer.h"
 #include "Calibration.h"
-#include "FlowRate.h"
 
 // Konstruktor für einen HX711 (abwärtskompatibel)
 Scale::Scale(uint8_t dataPin, uint8_t clockPin, float calibrationFactor)
@@ -21,6 +21,7 @@ Scale::Scale(uint8_t dataPin1, uint8_t dataPin2, uint8_t clockPin, float calibra
       currentWeight(0.0f), readingIndex(0), samplesInitialized(false), previousFilteredWeight(0),
       medianSamples(3), averageSamples(2), currentFilterState(STABLE), lastBrewingActivity(0),
       lastStableWeight(0.0f), dualHX711(true), lastSuccessfulRead(0) {
+    governor.setChipCount(2);
     // Initialize readings array
     for (int i = 0; i < MAX_SAMPLES; i++) {
         readings[i] = 0.0f;
@@ -42,6 +43,7 @@ bool Scale::begin() {
     
     // Load filtering parameters with load cell-specific defaults
     loadFilterSettings();
+    vibrationFilter.begin();
     
     // Auto-adjust brewing threshold based on calibration factor and load cell characteristics
     if (!preferences.isKey("brew_thresh")) {
@@ -92,6 +94,7 @@ bool Scale::begin() {
         
         // Initialen successful read setzen
         lastSuccessfulRead = millis();
+        attachReadyInterrupt();
         
         return true;
     } else {
@@ -124,7 +127,7 @@ bool Scale::initializeSingleHX711() {
                 return true;
             }
         }
-        delay(100);
+        delay(10); // First conversion arrives 12.5-100ms after power-up (80/10 SPS)
     }
     
     Serial.println("ERROR: Single HX711 not responding!");
@@ -165,7 +168,7 @@ bool Scale::initializeDualHX711() {
         if (hx7111Ready && hx7112Ready) {
             break;
         }
-        delay(100);
+        delay(10); // First conversion arrives 12.5-100ms after power-up (80/10 SPS)
     }
     
     if (hx7111Ready && hx7112Ready) {
@@ -189,18 +192,72 @@ bool Scale::initializeDualHX711() {
     }
 }
 
+// Wake-from-deep-sleep path: the HX711s were powered down with the chip, but
+// offsets, factors and filter settings are still valid, so skip the connection
+// probe, the initial tare and the NVS reads. The first read() simply waits for
+// the first conversion like any other sample.
+bool Scale::resume(const RetainedScaleState& state) {
+    if (state.dualHX711 != dualHX711) {
+        return false; // Retained for another wiring - take the full path
+    }
+
+    calibrationFactor = state.calibrationFactor;
+    calibrationFactor1 = state.calibrationFactor1;
+    calibrationFactor2 = state.calibrationFactor2;
+    brewingThreshold = state.brewingThreshold;
+    stabilityTimeout = state.stabilityTimeout;
+    medianSamples = state.medianSamples;
+    averageSamples = state.averageSamples;
+    vibrationFilter.setEnabled(state.notchEnabled);
+    vibrationFilter.begin();
+    firEnabled = state.firEnabled;
+    firTaps = state.firTaps;
+    firCutoffHz = state.firCutoffHz;
+
+    hx7111.begin(dataPin1, clockPin);
+    if (dualHX711) {
+        hx7112.begin(dataPin2, clockPin);
+        hx7111.set_scale(calibrationFactor1);
+        hx7112.set_scale(calibrationFactor2);
+        hx7112.set_offset(state.offset2);
+    } else {
+        hx7111.set_scale(calibrationFactor);
+    }
+    hx7111.set_offset(state.offset1);
+
+    isConnected = true;
+    lastSuccessfulRead = millis();
+    attachReadyInterrupt();
+    Serial.println("Scale resumed from retained state (no probe, no tare)");
+    return true;
+}
+
+void Scale::exportRetained(RetainedScaleState& state) const {
+    state.dualHX711 = dualHX711;
+    // get_offset() is not const in the HX711 library
+    state.offset1 = const_cast<HX711&>(hx7111).get_offset();
+    state.offset2 = dualHX711 ? const_cast<HX711&>(hx7112).get_offset() : 0;
+    state.calibrationFactor = calibrationFactor;
+    state.calibrationFactor1 = calibrationFactor1;
+    state.calibrationFactor2 = calibrationFactor2;
+    state.brewingThreshold = brewingThreshold;
+    state.stabilityTimeout = stabilityTimeout;
+    state.medianSamples = medianSamples;
+    state.averageSamples = averageSamples;
+    state.notchEnabled = vibrationFilter.isEnabled();
+    state.firEnabled = firEnabled;
+    state.firTaps = firTaps;
+    state.firCutoffHz = firCutoffHz;
+}
+
 void Scale::tare(uint8_t times) {
     if (!isConnected) {
         Serial.println("Cannot tare: HX711 not connected");
         return;
     }
     
-    // Pause flow rate calculation to prevent tare operation from affecting flow rate
-    if (flowRatePtr != nullptr) {
-        flowRatePtr->pauseCalculation();
-    }
-    
     Serial.println("Taring scale...");
+    wakeAcquisition(); // tare() blocks on a conversion - a powered-down HX711 never delivers one
     
     if (dualHX711) {
         // Tare both modules sequentially
@@ -222,12 +279,6 @@ void Scale::tare(uint8_t times) {
     // Reinitialize sample buffer
     samplesInitialized = false;
     Serial.println("Smart filter reset to STABLE state");
-    
-    // Resume flow rate calculation after a short delay to ensure stable readings
-    if (flowRatePtr != nullptr) {
-        delay(100); // Short delay to let scale stabilize
-        flowRatePtr->resumeCalculation();
-    }
 }
 
 void Scale::set_scale(float factor) {
@@ -269,11 +320,13 @@ void Scale::setCalibrationFactors(float factor1, float factor2) {
 
 long Scale::getRawValue1() {
     if (!isConnected || !dualHX711) return 0;
+    wakeAcquisition();
     return hx7111.get_value(1);
 }
 
 long Scale::getRawValue2() {
     if (!isConnected || !dualHX711) return 0;
+    wakeAcquisition();
     return hx7112.get_value(1);
 }
 
@@ -324,11 +377,23 @@ float Scale::getWeight() {
     static unsigned long lastReadTime = 0;
     unsigned long currentTime = millis();
     
-    // Read at 50Hz (every 20ms) for good responsiveness
-    if (currentTime - lastReadTime < 20) {
+    // 50Hz (every 20ms) while brewing - the governor stretches this when idle
+    if (currentTime - lastReadTime < governor.readIntervalMs()) {
         return currentWeight;
     }
     lastReadTime = currentTime;
+    
+    // Sparse mode: power up for this reading and wait for the first conversion
+    if (governor.isPoweredDown()) {
+        powerUpHX711();
+        return currentWeight;
+    }
+    if (governor.isWaking()) {
+        if (!hx711Ready()) {
+            return currentWeight;
+        }
+        governor.onFirstConversion(currentTime);
+    }
 
     float rawReading;
     
@@ -339,7 +404,8 @@ float Scale::getWeight() {
         rawReading = readSingleHX711();
     }
     
-    // Handle invalid readings
+    // No conversion since the last read (10 SPS vs. the 20ms poll) - only a real
+    // conversion advances the sample sequence and timestamp
     if (isnan(rawReading)) {
         return currentWeight;
     }
@@ -347,8 +413,15 @@ float Scale::getWeight() {
     // ✅ SUCCESSFUL READ - Update timestamp for status detection
     lastSuccessfulRead = currentTime;
     
+    // Every processed reading produces one filtered sample for telemetry
+    sampleSequence++;
+    sampleTimestampUs = lastConversionMicros;
+    lastUnfilteredWeight = rawReading;
+    
     // Initialize sample buffer on first valid reading
     if (!samplesInitialized) {
+        vibrationFilter.reset(rawReading);
+        firFilter.reset(rawReading);
         initializeSamples(rawReading);
         currentWeight = rawReading;
         lastStableWeight = rawReading;
@@ -356,6 +429,10 @@ float Scale::getWeight() {
         return currentWeight;
     }
     
+    // Notch out pump vibration first; the tone is only tracked while brewing
+    float unnotchedReading = rawReading;
+    rawReading = vibrationFilter.process(rawReading, sampleTimestampUs, currentFilterState != STABLE);
+    
     // Store reading in circular buffer
     readings[readingIndex] = rawReading;
     readingIndex = (readingIndex + 1) % MAX_SAMPLES;
@@ -397,9 +474,32 @@ float Scale::getWeight() {
         }
     }
     
+    // FIR runs on every sample so its delay line is warm whenever it is selected
+    float firWeight = rawReading;
+    if (firEnabled) {
+        float rate = vibrationFilter.getSampleRate();
+        if (rate > 0.0f && (firRedesignPending || !firFilter.isDesigned() ||
+                            fabsf(rate - firFilter.getDesignRate()) > firFilter.getDesignRate() * 0.1f)) {
+            // Kernel depends on the settings and the real conversion rate - redesign
+            // here, on the acquisition task, never under a running process()
+            firRedesignPending = false;
+            firFilter.design(firTaps, firCutoffHz, rate);
+        }
+        firWeight = firFilter.process(rawReading);
+    }
+    
     // Apply appropriate filter based on current state
     float filteredWeight;
-    switch (currentFilterState) {
+    if (filterOverride == FILTER_FAST) {
+        // Pour-over: a pour is running - keep the response quick
+        filteredWeight = medianFilter(medianSamples);
+    } else if (filterOverride == FILTER_SMOOTH) {
+        // Pour-over: pause between pours - weight is static, smooth hard
+        filteredWeight = averageFilter(MAX_SAMPLES);
+    } else if (firEnabled && firFilter.isDesigned()) {
+        // FIR low-pass replaces median/average in every state
+        filteredWeight = firWeight;
+    } else switch (currentFilterState) {
         case BREWING:
             // Use median filter during brewing for noise rejection
             filteredWeight = medianFilter(medianSamples);
@@ -407,15 +507,18 @@ float Scale::getWeight() {
         case STABLE:
         case TRANSITIONING:
             // Use average filter for stable readings - smoother and faster
-            filteredWeight = averageFilter(averageSamples);
+            filteredWeight = averageFilter(governor.stableAverageSamples(
+                profileAverageSamples > 0 ? profileAverageSamples : averageSamples, MAX_SAMPLES));
             break;
     }
     
     // Handle rapid changes (>5g) with immediate response regardless of filter state
     if (weightChange > 5.0f) {
-        filteredWeight = rawReading;
+        filteredWeight = unnotchedReading;
         // Reset sample buffer for immediate response
-        initializeSamples(rawReading);
+        initializeSamples(unnotchedReading);
+        vibrationFilter.reset(unnotchedReading);
+        firFilter.reset(unnotchedReading);
         // Update state appropriately
         if (currentFilterState == STABLE) {
             currentFilterState = BREWING;
@@ -424,24 +527,100 @@ float Scale::getWeight() {
     }
     
     currentWeight = filteredWeight;
+    
+    // Any change above the brewing threshold returns to FULL on this conversion
+    governor.onSample(currentFilterState != STABLE || weightChange > brewingThreshold ||
+                      filterOverride != FILTER_AUTO, currentTime);
+    if (governor.shouldPowerDown()) {
+        powerDownHX711();
+    }
     return currentWeight;
 }
 
+void Scale::powerDownHX711() {
+    // PD_SCK high for >60us - also switches off the bridge excitation
+    hx7111.power_down();
+    if (dualHX711) {
+        hx7112.power_down();
+    }
+    governor.onPowerDown(millis());
+}
+
+void Scale::powerUpHX711() {
+    hx7111.power_up();
+    if (dualHX711) {
+        hx7112.power_up();
+    }
+    governor.onPowerUp(millis());
+}
+
+bool Scale::hx711Ready() {
+    return hx7111.is_ready() && (!dualHX711 || hx7112.is_ready());
+}
+
+void Scale::wakeAcquisition() {
+    if (governor.isPoweredDown()) {
+        powerUpHX711();
+    }
+    governor.wake(millis());
+}
+
+void Scale::setAcquisitionProfile(bool pinFullRate, uint8_t stableAverageSamples) {
+    // Not persisted - the saved filter settings stay the user's
+    profileAverageSamples = stableAverageSamples;
+    if (pinFullRate && governor.isPoweredDown()) {
+        powerUpHX711();
+    }
+    governor.setPinned(pinFullRate, millis());
+}
+
+void IRAM_ATTR Scale::doutReadyIsr(void* arg) {
+    // The data bits clock out falling edges too, but DOUT stays high after the
+    // 25th pulse until the next conversion - the latest edge before a read is
+    // always that conversion's ready edge
+    static_cast<Scale*>(arg)->doutReadyMicros = micros();
+}
+
+void Scale::attachReadyInterrupt() {
+    // Capture time for the latency tracer: DOUT going low is the conversion
+    // itself, so the poll delay until getWeight() reads it shows up in every
+    // stage. Both HX711s share the clock and convert together - one pin is enough
+    attachInterruptArg(dataPin1, doutReadyIsr, this, FALLING);
+}
+
+uint32_t Scale::takeConversionTime() {
+    uint32_t now = micros();
+    uint32_t readyUs = doutReadyMicros;
+    doutReadyMicros = 0;
+    // No edge seen (interrupt not attached yet) or implausibly old - fall back to now
+    if (readyUs == 0 || (int32_t)(now - readyUs) < 0 || now - readyUs > 1000000) {
+        return now;
+    }
+    return readyUs;
+}
+
 float Scale::readSingleHX711() {
     if (!hx7111.is_ready()) {
-        return currentWeight;  // Return last known value if not ready
+        return NAN;  // No new conversion yet - not a sample
     }
-    return hx7111.get_units(1);
+    // Same as get_units(1), but keeps the raw conversion for telemetry
+    lastConversionMicros = takeConversionTime();
+    lastRaw1 = hx7111.read();
+    return (lastRaw1 - hx7111.get_offset()) / hx7111.get_scale();
 }
 
 float Scale::readDualHX711() {
     // Read from both HX711 modules and combine the readings
     if (!hx7111.is_ready() || !hx7112.is_ready()) {
-        return currentWeight;  // Return last known value if not ready
+        return NAN;  // No new conversion yet - not a sample
     }
     
-    float reading1 = hx7111.get_units(1);
-    float reading2 = hx7112.get_units(1);
+    // Same as get_units(1), but keeps the raw conversions for telemetry
+    lastConversionMicros = takeConversionTime();
+    lastRaw1 = hx7111.read();
+    lastRaw2 = hx7112.read();
+    float reading1 = (lastRaw1 - hx7111.get_offset()) / hx7111.get_scale();
+    float reading2 = (lastRaw2 - hx7112.get_offset()) / hx7112.get_scale();
     
     // KORREKTUR: Beide Zellen sind individuell kalibriert und zeigen 
     // jeweils das GESAMTGEWICHT an, das sie tragen würden
@@ -467,6 +646,7 @@ long Scale::getRawValue() {
     if (!isConnected) {
         return 0;
     }
+    wakeAcquisition();
     
     if (dualHX711) {
         // KORREKTUR: Rohwerte addieren für korrekte Kalibrierung
@@ -576,6 +756,10 @@ void Scale::saveFilterSettings() {
     preferences.putULong("stab_timeout", stabilityTimeout);
     preferences.putInt("median_samples", medianSamples);
     preferences.putInt("avg_samples", averageSamples);
+    preferences.putBool("notch", vibrationFilter.isEnabled());
+    preferences.putBool("fir", firEnabled);
+    preferences.putInt("fir_taps", firTaps);
+    preferences.putFloat("fir_cutoff", firCutoffHz);
     preferences.end();
     Serial.println("Filter settings saved to EEPROM");
 }
@@ -587,14 +771,36 @@ void Scale::loadFilterSettings() {
     stabilityTimeout = preferences.getULong("stab_timeout", 2000);
     medianSamples = preferences.getInt("median_samples", 3);
     averageSamples = preferences.getInt("avg_samples", 2);
+    vibrationFilter.setEnabled(preferences.getBool("notch", true));
+    firEnabled = preferences.getBool("fir", false);
+    firTaps = preferences.getInt("fir_taps", 32);
+    firCutoffHz = preferences.getFloat("fir_cutoff", 5.0f);
     preferences.end();
 }
 
-void Scale::setFlowRatePtr(FlowRate* flowRatePtr) {
-    this->flowRatePtr = flowRatePtr;
+void Scale::setNotchEnabled(bool enabled) {
+    vibrationFilter.setEnabled(enabled);
+    saveFilterSettings();
+}
+
+void Scale::setFirSettings(bool enabled, int taps, float cutoffHz) {
+    if (taps >= 16 && taps <= (int)FirFilter::MAX_TAPS) {
+        firTaps = taps;
+    }
+    if (cutoffHz >= 0.5f && cutoffHz <= 20.0f) {
+        firCutoffHz = cutoffHz;
+    }
+    firEnabled = enabled;
+    // Redesign on the next sample with the current conversion rate - the
+    // acquisition task owns the coefficients and the delay line
+    firRedesignPending = true;
+    saveFilterSettings();
 }
 
 String Scale::getFilterState() const {
+    if (filterOverride == FILTER_FAST) return "POUR";
+    if (filterOverride == FILTER_SMOOTH) return "POUR_PAUSE";
+    if (firEnabled && firFilter.isDesigned()) return "FIR";
     switch (currentFilterState) {
         case STABLE: return "STABLE";
         case BREWING: return "BREWING";
@@ -0,0 +1,189 @@
+#include "ShotAnalytics.h"
+#include "ShotLog.h"
+
+ShotAnalytics::ShotAnalytics() : shotLogPtr(nullptr), startPending(false), startUs(0), startWeight(0),
+    dropCandidates(0), lastSequence(0), lastWeight(0), flowSamples(0), flowMean(0.0f), flowM2(0.0f),
+    lowFlowSinceMs(0), lowFlow(false), endMs(0), settleReference(0), settleSinceMs(0), eventSequence(0),
+    eventLock(portMUX_INITIALIZER_UNLOCKED) {}
+
+void ShotAnalytics::setShotLog(ShotLog* shotLog) {
+    shotLogPtr = shotLog;
+}
+
+void ShotAnalytics::beginShot(uint32_t shotStartUs) {
+    summary = ShotSummary();
+    summary.phase = ShotPhase::WAITING_FOR_DROP;
+    startPending = true; // Baseline weight comes from the next sample
+    startUs = shotStartUs;
+    lastSequence = 0; // Back-dated samples are replayed after the start
+    dropCandidates = 0;
+    flowSamples = 0;
+    flowMean = 0;
+    flowM2 = 0;
+    lowFlow = false;
+    publish(ShotEventType::SHOT_STARTED, 0, lastWeight, 0.0f);
+}
+
+void ShotAnalytics::endShot() {
+    uint32_t nowMs = (micros() - startUs) / 1000;
+    if (summary.phase == ShotPhase::FLOWING) {
+        finishFlowing(nowMs, lastWeight);
+    } else if (summary.phase == ShotPhase::WAITING_FOR_DROP) {
+        // Timer stopped before anything reached the cup
+        summary.phase = ShotPhase::IDLE;
+        publish(ShotEventType::SHOT_ENDED, nowMs, lastWeight, 0.0f);
+    }
+    // SETTLING: flow already ended, keep waiting for the yield
+}
+
+void ShotAnalytics::reset() {
+    // A reset right after stopping should not cost us the yield
+    if (summary.phase == ShotPhase::WAITING_FOR_DROP || summary.phase == ShotPhase::FLOWING) {
+        summary.phase = ShotPhase::IDLE;
+    }
+}
+
+void ShotAnalytics::update(const TelemetrySample& sample) {
+    if (sample.sequence == lastSequence) {
+        return;
+    }
+    lastSequence = sample.sequence;
+    lastWeight = sample.weight;
+
+    if (summary.phase == ShotPhase::IDLE) {
+        return;
+    }
+
+    int32_t sinceStart = (int32_t)(sample.timestampUs - startUs);
+    if (sinceStart < 0) {
+        return; // Captured before the timer started
+    }
+    uint32_t nowMs = (uint32_t)sinceStart / 1000;
+
+    if (startPending) {
+        startWeight = sample.weight;
+        startPending = false;
+    }
+
+    switch (summary.phase) {
+        case ShotPhase::WAITING_FOR_DROP:
+            // Weight has to rise and keep rising for a few samples - a bump is not a drip
+            if (sample.weight - startWeight > DROP_WEIGHT && sample.flowRate > DROP_FLOW) {
+                dropCandidates++;
+            } else {
+                dropCandidates = 0;
+            }
+            if (dropCandidates >= DROP_CONFIRM_SAMPLES) {
+                summary.hasFirstDrop = true;
+                summary.firstDropMs = nowMs;
+                summary.phase = ShotPhase::FLOWING;
+                publish(ShotEventType::FIRST_DROP, nowMs, sample.weight, (float)nowMs);
+            }
+            break;
+
+        case ShotPhase::FLOWING: {
+            // Welford update - numerically stable running mean/variance
+            flowSamples++;
+            float delta = sample.flowRate - flowMean;
+            flowMean += delta / (float)flowSamples;
+            flowM2 += delta * (sample.flowRate - flowMean);
+
+            if (sample.flowRate > summary.peakFlowRate) {
+                summary.peakFlowRate = sample.flowRate;
+            }
+            summary.meanFlowRate = flowMean;
+            summary.flowStdDev = flowSamples > 1 ? sqrtf(flowM2 / (float)(flowSamples - 1)) : 0.0f;
+
+            if (sample.flowRate < END_FLOW) {
+                if (!lowFlow) {
+                    lowFlow = true;
+                    lowFlowSinceMs = nowMs;
+                } else if (nowMs - lowFlowSinceMs >= END_HOLD_MS) {
+                    finishFlowing(lowFlowSinceMs, sample.weight);
+                }
+            } else {
+                lowFlow = false;
+            }
+            break;
+        }
+
+        case ShotPhase::SETTLING:
+            if (fabsf(sample.weight - settleReference) > SETTLE_BAND) {
+                settleReference = sample.weight;
+                settleSinceMs = nowMs;
+            } else if (nowMs - settleSinceMs >= SETTLE_HOLD_MS || nowMs - endMs >= SETTLE_TIMEOUT_MS) {
+                summary.yieldWeight = sample.weight;
+                summary.settled = true;
+                summary.phase = ShotPhase::IDLE;
+                publish(ShotEventType::YIELD_SETTLED, nowMs, sample.weight, sample.weight);
+                if (shotLogPtr != nullptr) {
+                    shotLogPtr->annotateShot(summary);
+                }
+            }
+            break;
+
+        case ShotPhase::IDLE:
+            break;
+    }
+}
+
+void ShotAnalytics::finishFlowing(uint32_t nowMs, float weight) {
+    summary.flowingMs = nowMs > summary.firstDropMs ? nowMs - summary.firstDropMs : 0;
+    summary.phase = ShotPhase::SETTLING;
+    endMs = nowMs;
+    settleReference = weight;
+    settleSinceMs = nowMs;
+    publish(ShotEventType::SHOT_ENDED, nowMs, weight, summary.meanFlowRate);
+}
+
+void ShotAnalytics::publish(ShotEventType type, uint32_t shotTimeMs, float weight, float value) {
+    portENTER_CRITICAL(&eventLock);
+    ShotEvent& event = events[(eventSequence + 1) % EVENT_QUEUE_SIZE];
+    event.sequence = eventSequence + 1;
+    event.type = type;
+    event.shotTimeMs = shotTimeMs;
+    event.weight = weight;
+    event.value = value;
+    eventSequence++;
+    portEXIT_CRITICAL(&eventLock);
+
+    Serial.printf("ShotAnalytics: %s at %.1fs (%.1fg, %.2f)\n", eventName(type),
+                  shotTimeMs / 1000.0f, weight, value);
+}
+
+bool ShotAnalytics::nextEvent(uint32_t& cursor, ShotEvent& event) const {
+    portENTER_CRITICAL(&eventLock);
+    if (cursor >= eventSequence) {
+        portEXIT_CRITICAL(&eventLock);
+        return false;
+    }
+    // Consumer fell behind the ring - skip what was overwritten
+    if (eventSequence - cursor > EVENT_QUEUE_SIZE) {
+        cursor = eventSequence - EVENT_QUEUE_SIZE;
+    }
+    cursor++;
+    event = events[cursor % EVENT_QUEUE_SIZE];
+    portEXIT_CRITICAL(&eventLock);
+    return true;
+}
+
+const char* ShotAnalytics::phaseName(ShotPhase phase) {
+    switch (phase) {
+        case ShotPhase::WAITING_FOR_DROP: return "waiting";
+        case ShotPhase::FLOWING: return "flowing";
+        case ShotPhase::SETTLING: return "settling";
+        default: return "idle";
+    }
+}
+
+const char* ShotAnalytics::eventName(ShotEventType type) {
+    switch (type) {
+        case ShotEventType::SHOT_STARTED: return "shot_started";
+        case ShotEventType::FIRST_DROP: return "first_drop";
+        case ShotEventType::SHOT_ENDED: return "shot_ended";
+        case ShotEventType::YIELD_SETTLED: return "yield_settled";
+        case ShotEventType::POUR_STARTED: return "pour_started";
+        case ShotEventType::POUR_ENDED: return "pour_ended";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,466 @@
+#include "ShotLog.h"
+#include "WebAssets.h"
+#include "ShotAnalytics.h"
+#include <LittleFS.h>
+#include <freertos/semphr.h>
+
+const char* ShotLog::INDEX_PATH = "/shots/index.bin";
+const char* ShotLog::INDEX_TMP_PATH = "/shots/index.tmp";
+
+static const uint8_t CURVE_MAGIC[4] = {'W', 'M', 'B', 'S'};
+static const uint8_t CURVE_VERSION = 1;
+static const uint16_t CURVE_HEADER_SIZE = 16;
+
+// Index rewrites (pruning) must not interleave with /api/shots reads
+static SemaphoreHandle_t indexMutex = nullptr;
+
+static int32_t toCentis(float value) {
+    return (int32_t)lroundf(value * 100.0f);
+}
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+ShotCurveDecoder::ShotCurveDecoder(Stream& input)
+    : input(input), timeMs(0), weightCg(0), flowCg(0) {}
+
+bool ShotCurveDecoder::readHeader(uint32_t& shotId) {
+    uint8_t header[CURVE_HEADER_SIZE];
+    for (size_t i = 0; i < CURVE_HEADER_SIZE; i++) {
+        int b = input.read();
+        if (b < 0) return false;
+        header[i] = (uint8_t)b;
+    }
+    if (memcmp(header, CURVE_MAGIC, 4) != 0 || header[4] != CURVE_VERSION) {
+        return false;
+    }
+    shotId = (uint32_t)header[8] | ((uint32_t)header[9] << 8) |
+             ((uint32_t)header[10] << 16) | ((uint32_t)header[11] << 24);
+    return true;
+}
+
+bool ShotCurveDecoder::next(ShotPoint& point) {
+    uint32_t dt, dw, df;
+    if (!readVarint(dt) || !readVarint(dw) || !readVarint(df)) {
+        return false;
+    }
+    // Undo zigzag encoding of the signed deltas
+    timeMs += dt;
+    weightCg += (int32_t)((dw >> 1) ^ -(int32_t)(dw & 1));
+    flowCg += (int32_t)((df >> 1) ^ -(int32_t)(df & 1));
+
+    point.timeMs = timeMs;
+    point.weight = weightCg / 100.0f;
+    point.flowRate = flowCg / 100.0f;
+    return true;
+}
+
+bool ShotCurveDecoder::readVarint(uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int b = input.read();
+        if (b < 0) return false;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false; // Corrupt varint
+}
+
+ShotLog::ShotLog() : queue(nullptr), writerTask(nullptr), recording(false), damaged(false),
+    shotId(0), nextShotId(1), startUs(0), lastSequence(0), lastTimeMs(0), lastWeightCg(0),
+    lastFlowCg(0), pointCount(0), encodedBytes(0), lastWeight(0), peakFlowRate(0),
+    annotationPending(false), pendingFirstDropMs(0), pendingFlowStdDev(0), pendingYieldWeight(0),
+    chunkLength(0), droppedChunks(0) {}
+
+bool ShotLog::begin() {
+    if (isReady()) {
+        return true;
+    }
+
+    // Embedded-UI builds do not ship a filesystem image, so format on first boot there
+    if (!LittleFS.begin(webAssetsEmbedded())) {
+        Serial.println("ShotLog: LittleFS mount failed - shots will not be saved");
+        return false;
+    }
+    if (!LittleFS.exists("/shots")) {
+        LittleFS.mkdir("/shots");
+    }
+
+    indexMutex = xSemaphoreCreateMutex();
+    queue = xQueueCreate(QUEUE_DEPTH, sizeof(Message));
+    if (indexMutex == nullptr || queue == nullptr) {
+        Serial.println("ShotLog: failed to create queue");
+        queue = nullptr;
+        return false;
+    }
+
+    nextShotId = readLastShotId() + 1;
+
+    // Priority 1 - only runs when acquisition, BLE and the web server are idle
+    if (xTaskCreatePinnedToCore(writerTaskFunc, "shotlog", 4096, this, 1, &writerTask, tskNO_AFFINITY) != pdPASS) {
+        Serial.println("ShotLog: failed to start writer task");
+        vQueueDelete(queue);
+        queue = nullptr;
+        return false;
+    }
+
+    Serial.printf("ShotLog: ready, next shot id %u, %u/%u bytes used\n", (unsigned)nextShotId,
+                  (unsigned)LittleFS.usedBytes(), (unsigned)LittleFS.totalBytes());
+    return true;
+}
+
+void ShotLog::beginShot(uint32_t shotStartUs) {
+    if (!isReady()) {
+        return;
+    }
+    if (recording) {
+        endShot(0.0f);
+    }
+
+    shotId = nextShotId++;
+    recording = true;
+    damaged = false;
+    startUs = shotStartUs;
+    lastSequence = 0;
+    lastTimeMs = 0;
+    lastWeightCg = 0;
+    lastFlowCg = 0;
+    pointCount = 0;
+    encodedBytes = CURVE_HEADER_SIZE;
+    lastWeight = 0;
+    peakFlowRate = 0;
+    annotationPending = false;
+    chunkLength = 0;
+
+    Message message;
+    message.type = MSG_OPEN;
+    message.damaged = false;
+    message.length = 0;
+    message.shotId = shotId;
+    send(message);
+}
+
+void ShotLog::record(const TelemetrySample& sample) {
+    if (!recording || sample.sequence == lastSequence) {
+        return;
+    }
+    lastSequence = sample.sequence;
+
+    // Samples captured just before the timer started belong to the idle period
+    int32_t sinceStart = (int32_t)(sample.timestampUs - startUs);
+    if (sinceStart < 0) {
+        return;
+    }
+
+    uint32_t timeMs = (uint32_t)sinceStart / 1000;
+    int32_t weightCg = toCentis(sample.weight);
+    int32_t flowCg = toCentis(sample.flowRate);
+
+    if (chunkLength + MAX_POINT_BYTES > CHUNK_SIZE) {
+        flushChunk();
+    }
+    putVarint(timeMs - lastTimeMs);
+    putSigned(weightCg - lastWeightCg);
+    putSigned(flowCg - lastFlowCg);
+
+    lastTimeMs = timeMs;
+    lastWeightCg = weightCg;
+    lastFlowCg = flowCg;
+    lastWeight = sample.weight;
+    if (sample.flowRate > peakFlowRate) {
+        peakFlowRate = sample.flowRate;
+    }
+    pointCount++;
+}
+
+void ShotLog::endShot(float avgFlowRate) {
+    if (!recording) {
+        return;
+    }
+    recording = false;
+    flushChunk();
+
+    Message message;
+    message.type = MSG_FINALIZE;
+    message.damaged = damaged;
+    message.length = 0;
+    message.shotId = shotId;
+    message.summary.id = shotId;
+    message.summary.durationMs = (micros() - startUs) / 1000;
+    message.summary.points = pointCount;
+    message.summary.bytes = encodedBytes;
+    message.summary.finalWeight = lastWeight;
+    message.summary.avgFlowRate = avgFlowRate;
+    message.summary.peakFlowRate = peakFlowRate;
+    message.summary.firstDropMs = annotationPending ? pendingFirstDropMs : 0;
+    message.summary.flowStdDev = annotationPending ? pendingFlowStdDev : 0;
+    message.summary.yieldWeight = annotationPending ? pendingYieldWeight : 0;
+    annotationPending = false;
+    send(message);
+}
+
+void ShotLog::annotateShot(const ShotSummary& analytics) {
+    if (!isReady() || shotId == 0) {
+        return;
+    }
+    
+    // Yield settled while the timer still runs - the index record is written
+    // by endShot(), which takes the figures from here
+    if (recording) {
+        annotationPending = true;
+        pendingFirstDropMs = analytics.hasFirstDrop ? analytics.firstDropMs : 0;
+        pendingFlowStdDev = analytics.flowStdDev;
+        pendingYieldWeight = analytics.settled ? analytics.yieldWeight : 0;
+        return;
+    }
+    
+    // The yield settled after the timer stopped, so the index record already exists
+
+    Message message;
+    message.type = MSG_ANNOTATE;
+    message.damaged = false;
+    message.length = 0;
+    message.shotId = shotId;
+    message.summary.id = shotId;
+    message.summary.firstDropMs = analytics.hasFirstDrop ? analytics.firstDropMs : 0;
+    message.summary.flowStdDev = analytics.flowStdDev;
+    message.summary.yieldWeight = analytics.settled ? analytics.yieldWeight : 0;
+    send(message);
+}
+
+size_t ShotLog::listShots(size_t offset, size_t limit, ShotIndexEntry* out, size_t& total) {
+    total = 0;
+    if (!isReady() || out == nullptr) {
+        return 0;
+    }
+
+    size_t count = 0;
+    xSemaphoreTake(indexMutex, portMAX_DELAY);
+    File index = LittleFS.open(INDEX_PATH, "r");
+    if (index) {
+        total = index.size() / sizeof(ShotIndexEntry);
+        // Newest first: page 0 starts at the last record
+        for (size_t i = offset; i < total && count < limit; i++) {
+            index.seek((total - 1 - i) * sizeof(ShotIndexEntry));
+            if (index.read((uint8_t*)&out[count], sizeof(ShotIndexEntry)) != sizeof(ShotIndexEntry)) {
+                break;
+            }
+            count++;
+        }
+        index.close();
+    }
+    xSemaphoreGive(indexMutex);
+    return count;
+}
+
+String ShotLog::curvePath(uint32_t id) {
+    return "/shots/" + String(id) + ".bin";
+}
+
+void ShotLog::putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        chunk[chunkLength++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    chunk[chunkLength++] = (uint8_t)value;
+}
+
+void ShotLog::putSigned(int32_t value) {
+    // Zigzag: small negative deltas stay small
+    putVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void ShotLog::flushChunk() {
+    if (chunkLength == 0) {
+        return;
+    }
+    Message message;
+    message.type = MSG_CHUNK;
+    message.damaged = false;
+    message.length = chunkLength;
+    message.shotId = shotId;
+    memcpy(message.data, chunk, chunkLength);
+    if (send(message)) {
+        encodedBytes += chunkLength;
+    } else {
+        damaged = true;
+    }
+    chunkLength = 0;
+}
+
+bool ShotLog::send(Message& message) {
+    // Never wait - a full queue means flash is behind, drop rather than stall the scale
+    if (xQueueSend(queue, &message, 0) != pdTRUE) {
+        droppedChunks++;
+        return false;
+    }
+    return true;
+}
+
+void ShotLog::writerTaskFunc(void* param) {
+    ShotLog* log = static_cast<ShotLog*>(param);
+    Message message;
+    File file;
+    for (;;) {
+        if (xQueueReceive(log->queue, &message, portMAX_DELAY) == pdTRUE) {
+            log->handleMessage(message, file);
+        }
+    }
+}
+
+void ShotLog::handleMessage(const Message& message, File& file) {
+    String path = curvePath(message.shotId);
+
+    switch (message.type) {
+        case MSG_OPEN: {
+            if (file) file.close();
+            file = LittleFS.open(path, "w");
+            if (!file) {
+                Serial.printf("ShotLog: cannot create %s\n", path.c_str());
+                return;
+            }
+            uint8_t header[CURVE_HEADER_SIZE] = {0};
+            memcpy(header, CURVE_MAGIC, 4);
+            header[4] = CURVE_VERSION;
+            header[6] = CURVE_HEADER_SIZE & 0xFF;
+            header[7] = CURVE_HEADER_SIZE >> 8;
+            putLE32(header + 8, message.shotId);
+            file.write(header, sizeof(header));
+            break;
+        }
+
+        case MSG_CHUNK:
+            if (file) {
+                file.write(message.data, message.length);
+            }
+            break;
+
+        case MSG_FINALIZE: {
+            if (file) file.close();
+
+            // Accidental timer taps and shots with lost chunks are not kept
+            if (message.damaged || message.summary.durationMs < MIN_SHOT_MS) {
+                LittleFS.remove(path);
+                Serial.printf("ShotLog: shot %u discarded (%s)\n", (unsigned)message.shotId,
+                              message.damaged ? "chunks dropped" : "too short");
+                return;
+            }
+
+            appendIndex(message.summary);
+            Serial.printf("ShotLog: shot %u saved - %.1fs, %u points, %u bytes, %.1fg\n",
+                          (unsigned)message.shotId, message.summary.durationMs / 1000.0f,
+                          (unsigned)message.summary.points, (unsigned)message.summary.bytes,
+                          message.summary.finalWeight);
+            break;
+        }
+
+        case MSG_ANNOTATE:
+            updateLastEntry(message.summary);
+            break;
+    }
+}
+
+void ShotLog::updateLastEntry(const ShotIndexEntry& analytics) {
+    xSemaphoreTake(indexMutex, portMAX_DELAY);
+    File index = LittleFS.open(INDEX_PATH, "r+");
+    if (index) {
+        size_t total = index.size() / sizeof(ShotIndexEntry);
+        ShotIndexEntry entry;
+        size_t position = (total - 1) * sizeof(ShotIndexEntry);
+        // Only the newest record can match - discarded shots never got one
+        if (total > 0 && index.seek(position) &&
+            index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry) && entry.id == analytics.id) {
+            entry.firstDropMs = analytics.firstDropMs;
+            entry.flowStdDev = analytics.flowStdDev;
+            entry.yieldWeight = analytics.yieldWeight;
+            index.seek(position);
+            index.write((const uint8_t*)&entry, sizeof(entry));
+        }
+        index.close();
+    }
+    xSemaphoreGive(indexMutex);
+}
+
+void ShotLog::appendIndex(const ShotIndexEntry& entry) {
+    xSemaphoreTake(indexMutex, portMAX_DELAY);
+    File index = LittleFS.open(INDEX_PATH, "a");
+    if (index) {
+        index.write((const uint8_t*)&entry, sizeof(entry));
+        index.close();
+    }
+    xSemaphoreGive(indexMutex);
+
+    // Keep weeks of shots but always leave room for the next one
+    for (;;) {
+        size_t total = 0;
+        File check = LittleFS.open(INDEX_PATH, "r");
+        if (check) {
+            total = check.size() / sizeof(ShotIndexEntry);
+            check.close();
+        }
+        bool lowSpace = LittleFS.totalBytes() - LittleFS.usedBytes() < MIN_FREE_BYTES;
+        if (total <= 1 || (total <= MAX_SHOTS && !lowSpace)) {
+            break;
+        }
+        if (!pruneOldest()) {
+            Serial.println("ShotLog: pruning failed - keeping the index as it is");
+            break;
+        }
+    }
+}
+
+bool ShotLog::pruneOldest() {
+    xSemaphoreTake(indexMutex, portMAX_DELAY);
+    File index = LittleFS.open(INDEX_PATH, "r");
+    File rewritten = LittleFS.open(INDEX_TMP_PATH, "w");
+    ShotIndexEntry oldest;
+    bool ok = false;
+
+    if (index && rewritten) {
+        // Every remaining record must land in the copy - a short write on a
+        // full filesystem would otherwise drop the newest shots with the rename
+        size_t remaining = index.size() / sizeof(ShotIndexEntry);
+        ok = remaining > 0 && index.read((uint8_t*)&oldest, sizeof(oldest)) == sizeof(oldest);
+        ShotIndexEntry entry;
+        for (size_t i = 1; ok && i < remaining; i++) {
+            ok = index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry) &&
+                 rewritten.write((const uint8_t*)&entry, sizeof(entry)) == sizeof(entry);
+        }
+    }
+    if (index) index.close();
+    if (rewritten) rewritten.close();
+
+    // LittleFS rename replaces the target atomically - the index is never missing
+    if (ok && !LittleFS.rename(INDEX_TMP_PATH, INDEX_PATH)) {
+        ok = false;
+    }
+    if (!ok) {
+        LittleFS.remove(INDEX_TMP_PATH);
+    }
+    xSemaphoreGive(indexMutex);
+
+    if (ok) {
+        LittleFS.remove(curvePath(oldest.id));
+        Serial.printf("ShotLog: pruned shot %u\n", (unsigned)oldest.id);
+    }
+    return ok;
+}
+
+uint32_t ShotLog::readLastShotId() {
+    uint32_t lastId = 0;
+    File index = LittleFS.open(INDEX_PATH, "r");
+    if (index) {
+        size_t total = index.size() / sizeof(ShotIndexEntry);
+        ShotIndexEntry entry;
+        if (total > 0 && index.seek((total - 1) * sizeof(ShotIndexEntry)) &&
+            index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry)) {
+            lastId = entry.id;
+        }
+        index.close();
+    }
+    return lastId;
+}
@@ -0,0 +1,117 @@
+#include "TaskMonitor.h"
+
+TaskMonitor::TaskMonitor() : count(0), windowStartUs(0) {}
+
+int TaskMonitor::start(TaskFunction_t function, const char* name, uint32_t stackBytes,
+                       UBaseType_t priority, BaseType_t core) {
+    if (count >= MAX_TASKS) {
+        Serial.printf("TaskMonitor: no slot for task %s\n", name);
+        return -1;
+    }
+
+    int id = (int)count;
+    Entry& entry = entries[id];
+    entry.name = name;
+    entry.stackBytes = stackBytes;
+    entry.priority = priority;
+    entry.core = core;
+    entry.busyUs = 0;
+    entry.cycles = 0;
+    entry.cpuPercent = 0.0f;
+    entry.cyclesPerSecond = 0;
+    entry.maxCycleUs = 0;
+    entry.handle = nullptr;
+
+    // Register before the task runs - it reports with its id straight away
+    count++;
+    // ESP-IDF takes the stack size in bytes
+    if (xTaskCreatePinnedToCore(function, name, stackBytes, (void*)(intptr_t)id, priority,
+                                &entry.handle, core) != pdPASS) {
+        count--;
+        Serial.printf("TaskMonitor: failed to start task %s\n", name);
+        return -1;
+    }
+
+    if (windowStartUs == 0) {
+        windowStartUs = micros();
+    }
+    Serial.printf("TaskMonitor: %s started (core %d, priority %u, %u byte stack)\n",
+                  name, (int)core, (unsigned)priority, (unsigned)stackBytes);
+    return id;
+}
+
+void TaskMonitor::addBusy(int id, uint32_t busyUs) {
+    if (id < 0 || (size_t)id >= count) {
+        return;
+    }
+    Entry& entry = entries[id];
+    entry.busyUs = entry.busyUs + busyUs;
+    entry.cycles = entry.cycles + 1;
+    if (busyUs > entry.maxCycleUs) {
+        entry.maxCycleUs = busyUs;
+    }
+}
+
+void TaskMonitor::sample() {
+    uint32_t now = micros();
+    uint32_t windowUs = now - windowStartUs;
+    if (windowUs == 0) {
+        return;
+    }
+    windowStartUs = now;
+
+    for (size_t i = 0; i < count; i++) {
+        Entry& entry = entries[i];
+        // Racing with addBusy() only moves a cycle into the next window
+        uint32_t busy = entry.busyUs;
+        uint32_t cycles = entry.cycles;
+        entry.busyUs = 0;
+        entry.cycles = 0;
+        entry.cpuPercent = busy * 100.0f / windowUs;
+        entry.cyclesPerSecond = (uint32_t)((uint64_t)cycles * 1000000ULL / windowUs);
+    }
+}
+
+String TaskMonitor::toJson() const {
+    String json = "{\"tasks\":[";
+    for (size_t i = 0; i < count; i++) {
+        const Entry& entry = entries[i];
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + String(entry.name) + "\"";
+        json += ",\"core\":" + String((int)entry.core);
+        json += ",\"priority\":" + String((unsigned)entry.priority);
+        json += ",\"stack_bytes\":" + String(entry.stackBytes);
+        // High-water mark = least free stack ever, in bytes on ESP-IDF
+        json += ",\"stack_free_min\":" + String(entry.handle ? (unsigned)uxTaskGetStackHighWaterMark(entry.handle) : 0);
+        json += ",\"cpu_percent\":" + String(entry.cpuPercent, 2);
+        json += ",\"cycles_per_s\":" + String(entry.cyclesPerSecond);
+        json += ",\"max_cycle_us\":" + String(entry.maxCycleUs) + "}";
+    }
+    json += "]";
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    // Every task in the system, with run time relative to the total
+    UBaseType_t taskCount = uxTaskGetNumberOfTasks();
+    TaskStatus_t* status = (TaskStatus_t*)malloc(taskCount * sizeof(TaskStatus_t));
+    if (status != nullptr) {
+        uint32_t totalRunTime = 0;
+        taskCount = uxTaskGetSystemState(status, taskCount, &totalRunTime);
+        json += ",\"system\":[";
+        for (UBaseType_t i = 0; i < taskCount; i++) {
+            if (i > 0) json += ",";
+            json += "{\"name\":\"" + String(status[i].pcTaskName) + "\"";
+            json += ",\"priority\":" + String((unsigned)status[i].uxCurrentPriority);
+            json += ",\"stack_free_min\":" + String((unsigned)status[i].usStackHighWaterMark);
+            float share = totalRunTime > 0 ? status[i].ulRunTimeCounter * 100.0f / totalRunTime : 0.0f;
+            json += ",\"runtime_percent\":" + String(share, 2) + "}";
+        }
+        json += "]";
+        free(status);
+    }
+#endif
+
+    json += ",\"free_heap\":" + String(ESP.getFreeHeap());
+    json += ",\"min_free_heap\":" + String(ESP.getMinFreeHeap());
+    json += "}";
+    return json;
+}
@@ -0,0 +1,111 @@
+#include "TelemetryFrame.h"
+#include "Scale.h"
+#include "FlowRate.h"
+#include "Display.h"
+#include <string.h>
+
+size_t TelemetryFrame::encode(const TelemetrySample& sample, uint8_t* buffer, size_t capacity) {
+    bool withRaw = (sample.flags & TELEMETRY_FLAG_RAW) != 0;
+    size_t size = withRaw ? RAW_SIZE : BASE_SIZE;
+    if (buffer == nullptr || capacity < size) {
+        return 0;
+    }
+
+    buffer[0] = VERSION;
+    buffer[1] = sample.flags;
+    putU16(buffer + 2, (uint16_t)size);
+    putU32(buffer + 4, sample.sequence);
+    putU32(buffer + 8, sample.timestampUs);
+    putFloat(buffer + 12, sample.weight);
+    putFloat(buffer + 16, sample.flowRate);
+
+    if (withRaw) {
+        putU32(buffer + 20, (uint32_t)sample.raw1);
+        putU32(buffer + 24, (uint32_t)sample.raw2);
+    }
+    return size;
+}
+
+bool TelemetryFrame::decode(const uint8_t* buffer, size_t length, TelemetrySample& sample) {
+    if (buffer == nullptr || length < BASE_SIZE || buffer[0] != VERSION) {
+        return false;
+    }
+
+    uint16_t frameLength = getU16(buffer + 2);
+    if (frameLength < BASE_SIZE || frameLength > length) {
+        return false;
+    }
+
+    sample.flags = buffer[1];
+    sample.sequence = getU32(buffer + 4);
+    sample.timestampUs = getU32(buffer + 8);
+    sample.weight = getFloat(buffer + 12);
+    sample.flowRate = getFloat(buffer + 16);
+
+    if (sample.flags & TELEMETRY_FLAG_RAW) {
+        if (frameLength < RAW_SIZE) {
+            return false;
+        }
+        sample.raw1 = (int32_t)getU32(buffer + 20);
+        sample.raw2 = (int32_t)getU32(buffer + 24);
+    } else {
+        sample.raw1 = 0;
+        sample.raw2 = 0;
+    }
+    return true;
+}
+
+TelemetrySample TelemetryFrame::capture(Scale& scale, FlowRate* flowRate, Display* display, bool includeRaw) {
+    TelemetrySample sample;
+    sample.sequence = scale.getSampleSequence();
+    sample.timestampUs = scale.getSampleTimestampUs();
+    sample.weight = scale.getCurrentWeight();
+    sample.flowRate = (flowRate != nullptr) ? flowRate->getFlowRate() : 0.0f;
+
+    if (scale.isHX711Connected()) sample.flags |= TELEMETRY_FLAG_SCALE_OK;
+    if (scale.isDualHX711()) sample.flags |= TELEMETRY_FLAG_DUAL_HX711;
+    if (scale.isBrewingActive()) sample.flags |= TELEMETRY_FLAG_BREWING;
+    if (display != nullptr && display->isTimerRunning()) sample.flags |= TELEMETRY_FLAG_TIMER_RUNNING;
+
+    if (includeRaw) {
+        // Last raw conversions of the filtered sample - no extra HX711 read
+        sample.flags |= TELEMETRY_FLAG_RAW;
+        sample.raw1 = scale.getLastRaw1();
+        sample.raw2 = scale.getLastRaw2();
+    }
+    return sample;
+}
+
+// Explicit byte order so the frame layout does not depend on the host CPU
+void TelemetryFrame::putU16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+void TelemetryFrame::putU32(uint8_t* p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+void TelemetryFrame::putFloat(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    putU32(p, bits);
+}
+
+uint16_t TelemetryFrame::getU16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+uint32_t TelemetryFrame::getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+float TelemetryFrame::getFloat(const uint8_t* p) {
+    uint32_t bits = getU32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
@@ -1,13 +1,12 @@
 #include "TouchSensor.h"
-#include "Scale.h"
 #include "Display.h"
-#include "FlowRate.h"
+#include "EventBus.h"
 #include "WiFiManager.h"
+#include "PerformanceProfile.h"
 
-TouchSensor::TouchSensor(uint8_t touchPin, Scale* scale) 
-    : touchPin(touchPin), scalePtr(scale), displayPtr(nullptr), flowRatePtr(nullptr), touchThreshold(30000), 
-      lastTouchState(false), lastTouchTime(0), touchStartTime(0), debounceDelay(200),
-      longPressDetected(false), delayedTarePending(false), delayedTareTime(0) {
+TouchSensor::TouchSensor(uint8_t touchPin) 
+    : touchPin(touchPin), displayPtr(nullptr), touchThreshold(30000), 
+      delayedTarePending(false), delayedTareTime(0), lastTapTime(0) {
 }
 
 void TouchSensor::begin() {
@@ -15,58 +14,56 @@ void TouchSensor::begin() {
     // This prevents false triggers when no touch sensor is connected
     pinMode(touchPin, INPUT_PULLDOWN);
     Serial.println("Digital touch sensor initialized on pin " + String(touchPin) + " with pull-down resistor");
+    
+    // Edges are caught by interrupt - status page on release after 500ms,
+    // WiFi toggle as soon as the pad has been held for 5 seconds
+    InputPadConfig config = { STATUS_PAGE_DURATION, WIFI_TOGGLE_DURATION, true };
+    inputEngine.attach(InputPad::TARE, touchPin, config, this);
 }
 
 void TouchSensor::update() {
-    bool currentTouchState = isTouched();
+    // Check for pending delayed tare
+    checkDelayedTare();
+}
+
+void TouchSensor::onInputGesture(InputPad pad, InputGesture gesture, uint32_t heldMs) {
     unsigned long currentTime = millis();
     
-    // Check for touch state change with debouncing
-    if (currentTouchState != lastTouchState) {
-        if (currentTime - lastTouchTime > debounceDelay) {
-            if (currentTouchState) {
-                // Touch started - record start time
-                touchStartTime = currentTime;
-                longPressDetected = false;
-                Serial.println("Touch started");
+    switch (gesture) {
+        case InputGesture::PRESS:
+            Serial.println("Touch started");
+            break;
+            
+        case InputGesture::TAP:
+            if (delayedTarePending && currentTime - lastTapTime < DOUBLE_TAP_WINDOW) {
+                // Double tap - cancel the pending tare and switch profile
+                delayedTarePending = false;
+                handleProfileCycle();
+                Serial.println("Double tap detected - profile switch");
             } else {
-                // Touch ended
-                unsigned long pressDuration = currentTime - touchStartTime;
-                
-                if (!longPressDetected) {
-                    if (pressDuration >= WIFI_TOGGLE_DURATION) {
-                        // Very long press (5+ seconds) - WiFi toggle
-                        handleWiFiToggle();
-                        Serial.println("Very long press detected - WiFi toggle");
-                    } else if (pressDuration >= 500) {
-                        // Medium press (500ms+) - Status page toggle
-                        handleStatusPageToggle();
-                        Serial.println("Medium press detected - status page toggle");
-                    } else {
-                        // Short press - Tare
-                        scheduleDelayedTare();
-                        Serial.println("Short press detected - tare");
-                    }
-                }
-                longPressDetected = false;
-                Serial.println("Touch ended");
+                // Short press - Tare
+                scheduleDelayedTare();
+                lastTapTime = currentTime;
+                Serial.println("Short press detected - tare");
             }
-            lastTouchState = currentTouchState;
-            lastTouchTime = currentTime;
-        }
-    }
-    
-    // Check for very long press (WiFi toggle) while touch is still active
-    if (currentTouchState && !longPressDetected && touchStartTime > 0) {
-        if (currentTime - touchStartTime >= WIFI_TOGGLE_DURATION) {
-            longPressDetected = true;
+            break;
+            
+        case InputGesture::LONG_PRESS:
+            // Medium press (500ms+) - Status page toggle
+            handleStatusPageToggle();
+            Serial.println("Medium press detected - status page toggle");
+            break;
+            
+        case InputGesture::VERY_LONG_PRESS:
+            // Very long press (5+ seconds) - WiFi toggle
             handleWiFiToggle();
-            Serial.println("Very long press detected (during hold) - WiFi toggle");
-        }
+            Serial.println("Very long press detected - WiFi toggle");
+            break;
+            
+        case InputGesture::RELEASE:
+            Serial.println("Touch ended");
+            break;
     }
-    
-    // Check for pending delayed tare
-    checkDelayedTare();
 }
 
 void TouchSensor::setTouchThreshold(uint16_t threshold) {
@@ -98,41 +95,10 @@ void TouchSensor::setDisplay(Display* display) {
     displayPtr = display;
 }
 
-void TouchSensor::setFlowRate(FlowRate* flowRate) {
-    flowRatePtr = flowRate;
-}
-
 void TouchSensor::handleTouch() {
-    if (scalePtr != nullptr) {
-        Serial.println("Touch detected! Taring scale...");
-        
-        // Show tare message on display if available
-        if (displayPtr != nullptr) {
-            displayPtr->showTaringMessage();
-        }
-        
-        scalePtr->tare();
-        Serial.println("Scale tared successfully");
-        
-        // Reset timer when manual tare is pressed
-        if (displayPtr != nullptr) {
-            displayPtr->resetTimer();
-            Serial.println("Timer reset with manual tare");
-        }
-        
-        // Reset flow rate averaging for fresh brew
-        if (flowRatePtr != nullptr) {
-            flowRatePtr->resetTimerAveraging();
-            Serial.println("Flow rate averaging reset for fresh brew");
-        }
-        
-        // Show completion message on display if available
-        if (displayPtr != nullptr) {
-            displayPtr->showTaredMessage();
-        }
-    } else {
-        Serial.println("Error: Scale pointer is null");
-    }
+    Serial.println("Touch detected! Requesting tare...");
+    // Brew control tares, resets the timer and shows the messages
+    controlEvents.publish(ControlEventType::TARE, EventSource::TOUCH);
 }
 
 void TouchSensor::scheduleDelayedTare() {
@@ -153,31 +119,7 @@ void TouchSensor::checkDelayedTare() {
     if (delayedTarePending && millis() >= delayedTareTime) {
         Serial.println("Executing delayed tare operation");
         delayedTarePending = false;
-        
-        // Perform the actual tare operation without showing message again
-        if (scalePtr != nullptr) {
-            scalePtr->tare();
-            Serial.println("Scale tared successfully");
-            
-            // Reset timer when manual tare is pressed
-            if (displayPtr != nullptr) {
-                displayPtr->resetTimer();
-                Serial.println("Timer reset with manual tare");
-            }
-            
-            // Reset flow rate averaging for fresh brew
-            if (flowRatePtr != nullptr) {
-                flowRatePtr->resetTimerAveraging();
-                Serial.println("Flow rate averaging reset for fresh brew");
-            }
-            
-            // Show completion message on display if available
-            if (displayPtr != nullptr) {
-                displayPtr->showTaredMessage();
-            }
-        } else {
-            Serial.println("Error: Scale pointer is null");
-        }
+        controlEvents.publish(ControlEventType::TARE, EventSource::TOUCH);
     }
 }
 
@@ -191,6 +133,15 @@ void TouchSensor::handleStatusPageToggle() {
     }
 }
 
+void TouchSensor::handleProfileCycle() {
+    ProfileId next = profileManager.nextInCycle();
+    profileManager.requestCycle(EventSource::TOUCH);
+    
+    if (displayPtr != nullptr) {
+        displayPtr->showMessage("Profile: " + String(ProfileManager::name(next)), 1500);
+    }
+}
+
 void TouchSensor::handleWiFiToggle() {
     Serial.println("Long press detected - toggling WiFi power");
     
@@ -0,0 +1,155 @@
+#include "UlpWake.h"
+#include "Scale.h"
+#include "UlpWakeLogic.h"
+#include <esp_sleep.h>
+#include <Preferences.h>
+
+#ifdef WMB_ULP_WAKE
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <driver/rtc_io.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <ulp_riscv.h>
+#else
+#include <esp32s3/ulp_riscv.h>
+#include <soc/rtc_cntl_reg.h>
+#endif
+#include "ulp_main.h" // Generated by the ULP build - ulp_<name> for the program's variables
+
+extern const uint8_t ulp_main_bin_start[] asm("_binary_ulp_main_bin_start");
+extern const uint8_t ulp_main_bin_end[] asm("_binary_ulp_main_bin_end");
+
+static const uint32_t ULP_ARMED_MAGIC = 0x554C5057; // "ULPW"
+
+// Set while the ULP owns the HX711 pins in deep sleep
+RTC_DATA_ATTR static uint32_t ulpArmed;
+#endif
+
+static uint8_t hx711DataPin1 = 0;
+static uint8_t hx711DataPin2 = 0;
+static uint8_t hx711ClockPin = 0;
+
+static uint32_t checkPeriodMs = 0; // 0 until loaded from NVS
+
+void UlpWake::setPins(uint8_t dataPin1, uint8_t dataPin2, uint8_t clockPin) {
+    hx711DataPin1 = dataPin1;
+    hx711DataPin2 = dataPin2;
+    hx711ClockPin = clockPin;
+}
+
+bool UlpWake::isAvailable() {
+#ifdef WMB_ULP_WAKE
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t UlpWake::getCheckPeriodMs() {
+    if (checkPeriodMs == 0) {
+        Preferences prefs;
+        prefs.begin("ulpwake", true);
+        checkPeriodMs = prefs.getULong("period", DEFAULT_CHECK_PERIOD_MS);
+        prefs.end();
+        if (checkPeriodMs < MIN_CHECK_PERIOD_MS || checkPeriodMs > MAX_CHECK_PERIOD_MS) {
+            checkPeriodMs = DEFAULT_CHECK_PERIOD_MS;
+        }
+    }
+    return checkPeriodMs;
+}
+
+bool UlpWake::setCheckPeriodMs(uint32_t periodMs) {
+    if (periodMs < MIN_CHECK_PERIOD_MS || periodMs > MAX_CHECK_PERIOD_MS) {
+        return false;
+    }
+    checkPeriodMs = periodMs;
+    Preferences prefs;
+    prefs.begin("ulpwake", false);
+    prefs.putULong("period", periodMs);
+    prefs.end();
+    Serial.printf("UlpWake: check period %lums\n", (unsigned long)periodMs);
+    return true;
+}
+
+bool UlpWake::arm(const Scale& scale) {
+#ifdef WMB_ULP_WAKE
+    float countsPerGram = fabsf(scale.getCalibrationFactor());
+    if (countsPerGram <= 0.0f) {
+        Serial.println("UlpWake: no calibration - weight wake disabled");
+        return false;
+    }
+
+    esp_err_t err = ulp_riscv_load_binary(ulp_main_bin_start, ulp_main_bin_end - ulp_main_bin_start);
+    if (err != ESP_OK) {
+        Serial.printf("UlpWake: loading the ULP program failed (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+
+    // Both cells are summed, so the combined factor converts grams to counts
+    UlpWakeConfig* config = (UlpWakeConfig*)&ulp_wake_config;
+    config->thresholdCounts = (int32_t)(WAKE_THRESHOLD_G * countsPerGram);
+    config->confirmReads = CONFIRM_READS;
+    config->driftShift = DRIFT_SHIFT;
+    config->readyTimeoutMs = READY_TIMEOUT_MS;
+    config->dual = scale.isDualHX711() ? 1 : 0;
+    ulp_hx711_data_pin1 = hx711DataPin1;
+    ulp_hx711_data_pin2 = hx711DataPin2;
+    ulp_hx711_clock_pin = hx711ClockPin;
+    memset((void*)&ulp_wake_state, 0, sizeof(UlpWakeState));
+    ulp_pins_ready = 0;
+    ulp_wake_reading = 0;
+
+    uint32_t periodMs = getCheckPeriodMs();
+    ulp_set_wakeup_period(0, periodMs * 1000);
+    err = ulp_riscv_run();
+    if (err != ESP_OK) {
+        Serial.printf("UlpWake: starting the ULP failed (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+    esp_sleep_enable_ulp_wakeup();
+    ulpArmed = ULP_ARMED_MAGIC;
+
+    Serial.printf("UlpWake: armed - %.0fg (%ld counts) every %lums, %s HX711\n",
+                  WAKE_THRESHOLD_G, (long)config->thresholdCounts, (unsigned long)periodMs,
+                  config->dual ? "dual" : "single");
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool UlpWake::wokeOnWeight() {
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP;
+}
+
+void UlpWake::releasePins() {
+#ifdef WMB_ULP_WAKE
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP || ulpArmed != ULP_ARMED_MAGIC) {
+        return;
+    }
+    ulpArmed = 0;
+
+    // The ULP timer keeps running after the main cores wake - stop it before
+    // the scale drives the clock line
+#if ESP_IDF_VERSION_MAJOR >= 5
+    ulp_riscv_timer_stop();
+#else
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+#endif
+
+    rtc_gpio_deinit((gpio_num_t)hx711ClockPin);
+    rtc_gpio_deinit((gpio_num_t)hx711DataPin1);
+    if (hx711DataPin2 != 0) {
+        rtc_gpio_deinit((gpio_num_t)hx711DataPin2);
+    }
+
+    const UlpWakeState* state = (const UlpWakeState*)&ulp_wake_state;
+    if (wokeOnWeight()) {
+        Serial.printf("UlpWake: weight change - reading %ld vs baseline %ld after %lu checks\n",
+                      (long)ulp_wake_reading, (long)state->baseline, (unsigned long)state->checks);
+    } else {
+        Serial.printf("UlpWake: %lu checks during sleep, %lu HX711 timeouts\n",
+                      (unsigned long)state->checks, (unsigned long)state->timeouts);
+    }
+#endif
+}
@@ -0,0 +1,256 @@
+#include "VibrationFilter.h"
+
+#if WMB_HAS_ESP_DSP
+#include <esp_dsp.h>
+#endif
+
+// FFT work buffers - interleaved complex, aligned for the S3 SIMD kernels
+static float fftData[2 * VibrationFilter::FFT_SIZE] __attribute__((aligned(16)));
+static float hannWindow[VibrationFilter::FFT_SIZE];
+static bool fftReady = false;
+
+VibrationFilter::VibrationFilter()
+    : enabled(true), window(nullptr), windowHead(0), windowCount(0), samplesSinceAnalysis(0),
+      lastTimestampUs(0), sampleRateHz(0.0f), locked(false), notchHz(0.0f),
+      b0(1.0f), b1(0.0f), b2(0.0f), a1(0.0f), a2(0.0f), z1(0.0f), z2(0.0f),
+      missedAnalyses(0), peakRatio(0.0f), analysisMicros(0) {}
+
+bool VibrationFilter::begin() {
+    if (window != nullptr) {
+        return true;
+    }
+
+    if (psramFound()) {
+        window = (float*)ps_malloc(FFT_SIZE * sizeof(float));
+    }
+    if (window == nullptr) {
+        window = (float*)malloc(FFT_SIZE * sizeof(float));
+    }
+    if (window == nullptr) {
+        Serial.println("VibrationFilter: allocation failed - notch disabled");
+        return false;
+    }
+
+    if (!fftReady) {
+        for (size_t i = 0; i < FFT_SIZE; i++) {
+            hannWindow[i] = 0.5f - 0.5f * cosf(2.0f * PI * i / (FFT_SIZE - 1));
+        }
+#if WMB_HAS_ESP_DSP
+        fftReady = dsps_fft2r_init_fc32(NULL, FFT_SIZE) == ESP_OK;
+#else
+        fftReady = true;
+#endif
+    }
+
+    Serial.printf("VibrationFilter: %u point FFT (%s)\n", (unsigned)FFT_SIZE,
+                  WMB_HAS_ESP_DSP ? "esp-dsp" : "portable");
+    return fftReady;
+}
+
+void VibrationFilter::setEnabled(bool value) {
+    enabled = value;
+    if (!enabled) {
+        locked = false;
+        notchHz = 0.0f;
+    }
+}
+
+void VibrationFilter::reset(float value) {
+    windowCount = 0;
+    samplesSinceAnalysis = 0;
+    settle(value);
+}
+
+void VibrationFilter::settle(float value) {
+    // Steady state of the notch for a constant input: y = x
+    z2 = (b2 - a2) * value;
+    z1 = (b1 - a1) * value + z2;
+}
+
+float VibrationFilter::process(float reading, uint32_t timestampUs, bool track) {
+    // Track the real conversion rate - the notch frequency depends on it.
+    // Done even when disabled, the FIR stage designs its kernel from it too.
+    if (lastTimestampUs != 0) {
+        uint32_t dtUs = timestampUs - lastTimestampUs;
+        if (dtUs > 0 && dtUs < 1000000) {
+            float rate = 1000000.0f / dtUs;
+            sampleRateHz = sampleRateHz == 0.0f ? rate : sampleRateHz * 0.95f + rate * 0.05f;
+        }
+    }
+    lastTimestampUs = timestampUs;
+
+    if (!enabled || window == nullptr) {
+        return reading;
+    }
+
+    window[windowHead] = reading;
+    windowHead = (windowHead + 1) % FFT_SIZE;
+    if (windowCount < FFT_SIZE) windowCount++;
+
+    if (track && windowCount == FFT_SIZE && ++samplesSinceAnalysis >= HOP_SIZE) {
+        samplesSinceAnalysis = 0;
+        analyse();
+    }
+
+    if (!locked) {
+        return reading;
+    }
+
+    float output = b0 * reading + z1;
+    z1 = b1 * reading - a1 * output + z2;
+    z2 = b2 * reading - a2 * output;
+    return output;
+}
+
+void VibrationFilter::analyse() {
+    if (!fftReady || sampleRateHz <= 0.0f) {
+        return;
+    }
+    uint32_t startUs = micros();
+
+    // Remove the linear trend (the pour itself), then window - least squares over x = 0..N-1
+    float sumY = 0.0f;
+    float sumXY = 0.0f;
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        float y = window[(windowHead + i) % FFT_SIZE];
+        sumY += y;
+        sumXY += i * y;
+    }
+    const float n = (float)FFT_SIZE;
+    const float meanX = (n - 1.0f) / 2.0f;
+    const float varX = (n * n - 1.0f) / 12.0f;
+    float meanY = sumY / n;
+    float slope = (sumXY / n - meanX * meanY) / varX;
+
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        float y = window[(windowHead + i) % FFT_SIZE];
+        float detrended = y - (meanY + slope * (i - meanX));
+        fftData[2 * i] = detrended * hannWindow[i];
+        fftData[2 * i + 1] = 0.0f;
+    }
+
+    fft(fftData, FFT_SIZE);
+
+    // Power per bin up to Nyquist, skipping the slow pour dynamics
+    float binHz = sampleRateHz / FFT_SIZE;
+    size_t firstBin = (size_t)ceilf(MIN_TONE_HZ / binHz);
+    if (firstBin < 1) firstBin = 1;
+    size_t lastBin = FFT_SIZE / 2 - 1;
+    if (firstBin >= lastBin) {
+        return;
+    }
+
+    float total = 0.0f;
+    float peak = 0.0f;
+    size_t peakBin = firstBin;
+    for (size_t k = firstBin; k <= lastBin; k++) {
+        float re = fftData[2 * k];
+        float im = fftData[2 * k + 1];
+        float power = re * re + im * im;
+        total += power;
+        if (power > peak) {
+            peak = power;
+            peakBin = k;
+        }
+    }
+    size_t bins = lastBin - firstBin + 1;
+    float meanOthers = bins > 1 ? (total - peak) / (bins - 1) : 0.0f;
+    peakRatio = meanOthers > 0.0f ? peak / meanOthers : 0.0f;
+
+    if (peakRatio >= LOCK_RATIO) {
+        // Parabolic interpolation between neighbouring bins for a sub-bin estimate
+        float offset = 0.0f;
+        if (peakBin > firstBin && peakBin < lastBin) {
+            float left = sqrtf(fftData[2 * (peakBin - 1)] * fftData[2 * (peakBin - 1)] +
+                               fftData[2 * (peakBin - 1) + 1] * fftData[2 * (peakBin - 1) + 1]);
+            float centre = sqrtf(peak);
+            float right = sqrtf(fftData[2 * (peakBin + 1)] * fftData[2 * (peakBin + 1)] +
+                                fftData[2 * (peakBin + 1) + 1] * fftData[2 * (peakBin + 1) + 1]);
+            float denominator = left - 2.0f * centre + right;
+            if (denominator != 0.0f) {
+                offset = 0.5f * (left - right) / denominator;
+            }
+        }
+        float frequency = (peakBin + offset) * binHz;
+        missedAnalyses = 0;
+        if (!locked || fabsf(frequency - notchHz) > binHz / 2.0f) {
+            setNotch(frequency);
+            Serial.printf("VibrationFilter: notch at %.2f Hz (fs %.1f Hz, ratio %.1f)\n",
+                          frequency, sampleRateHz, peakRatio);
+        }
+    } else if (locked && ++missedAnalyses >= UNLOCK_AFTER_MISSES) {
+        // Pump stopped - no tone left to remove
+        locked = false;
+        notchHz = 0.0f;
+        Serial.println("VibrationFilter: tone gone - notch released");
+    }
+
+    analysisMicros = micros() - startUs;
+}
+
+void VibrationFilter::setNotch(float frequencyHz) {
+    // RBJ cookbook notch
+    float w0 = 2.0f * PI * frequencyHz / sampleRateHz;
+    float alpha = sinf(w0) / (2.0f * NOTCH_Q);
+    float cosW0 = cosf(w0);
+    float a0 = 1.0f + alpha;
+
+    b0 = 1.0f / a0;
+    b1 = -2.0f * cosW0 / a0;
+    b2 = 1.0f / a0;
+    a1 = -2.0f * cosW0 / a0;
+    a2 = (1.0f - alpha) / a0;
+    if (!locked) {
+        // Engage without a step: start from steady state at the latest reading
+        settle(window[(windowHead + FFT_SIZE - 1) % FFT_SIZE]);
+    }
+
+    notchHz = frequencyHz;
+    locked = true;
+}
+
+void VibrationFilter::fft(float* data, size_t n) {
+#if WMB_HAS_ESP_DSP
+    dsps_fft2r_fc32(data, n);
+    dsps_bit_rev_fc32(data, n);
+#else
+    // Iterative radix-2: bit reversal, then butterflies
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float tr = data[2 * i];
+            float ti = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = tr;
+            data[2 * j + 1] = ti;
+        }
+    }
+    for (size_t length = 2; length <= n; length <<= 1) {
+        float angle = -2.0f * PI / length;
+        float wr = cosf(angle);
+        float wi = sinf(angle);
+        for (size_t i = 0; i < n; i += length) {
+            float cr = 1.0f;
+            float ci = 0.0f;
+            for (size_t k = 0; k < length / 2; k++) {
+                size_t a = i + k;
+                size_t b = a + length / 2;
+                float xr = data[2 * b] * cr - data[2 * b + 1] * ci;
+                float xi = data[2 * b] * ci + data[2 * b + 1] * cr;
+                data[2 * b] = data[2 * a] - xr;
+                data[2 * b + 1] = data[2 * a + 1] - xi;
+                data[2 * a] += xr;
+                data[2 * a + 1] += xi;
+                float next = cr * wr - ci * wi;
+                ci = cr * wi + ci * wr;
+                cr = next;
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,50 @@
+#include "WebAssets.h"
+
+#ifdef EMBED_WEB_ASSETS
+// Generated into the build directory by scripts/embed_web_assets.py
+#include "WebAssetsData.h"
+
+bool webAssetsEmbedded() {
+    return true;
+}
+
+const EmbeddedAsset* findEmbeddedAsset(const String& path) {
+    // Directory requests map to index.html like serveStatic().setDefaultFile()
+    String lookup = path.endsWith("/") ? path + "index.html" : path;
+
+    // Linear scan is fine - the UI has a handful of files
+    for (size_t i = 0; i < EMBEDDED_WEB_ASSET_COUNT; i++) {
+        if (lookup.equals(EMBEDDED_WEB_ASSETS[i].path)) {
+            return &EMBEDDED_WEB_ASSETS[i];
+        }
+    }
+    return nullptr;
+}
+
+size_t getEmbeddedAssetCount() {
+    return EMBEDDED_WEB_ASSET_COUNT;
+}
+
+size_t getEmbeddedAssetBytes() {
+    return EMBEDDED_WEB_ASSET_BYTES;
+}
+
+#else
+
+bool webAssetsEmbedded() {
+    return false;
+}
+
+const EmbeddedAsset* findEmbeddedAsset(const String& path) {
+    return nullptr;
+}
+
+size_t getEmbeddedAssetCount() {
+    return 0;
+}
+
+size_t getEmbeddedAssetBytes() {
+    return 0;
+}
+
+#endif
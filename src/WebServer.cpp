@@ -7,6 +7,25 @@
 #include "FlowRate.h"
 #include "Calibration.h"
 #include "BluetoothScale.h"
+#include "WebAssets.h"
+#include "TelemetryFrame.h"
+#include "WeightHistory.h"
+#include "ShotLog.h"
+#include "ShotAnalytics.h"
+#include "AutoTimer.h"
+#include "PourSegmenter.h"
+#include "SampleBus.h"
+#include "EventBus.h"
+#include "TaskMonitor.h"
+#include "Profiler.h"
+#include "LatencyTracer.h"
+#include "BootScheduler.h"
+#include "PowerPolicy.h"
+#include "PerformanceProfile.h"
+#include "CoexPolicy.h"
+#include "InputEngine.h"
+#include "UlpWake.h"
+#include <memory>
 
 Preferences preferences;
 
@@ -91,8 +110,92 @@ void diagnoseEEPROMPerformance() {
 
 AsyncWebServer server(80);
 
+// Binary telemetry stream - one TelemetryFrame per filtered sample
+AsyncWebSocket telemetrySocket("/ws");
+
 // Global scale instance pointer for dual HX711 configuration
 static Scale* globalScalePtr = nullptr;
+static FlowRate* globalFlowRatePtr = nullptr;
+static Display* globalDisplayPtr = nullptr;
+static WeightHistory* globalHistoryPtr = nullptr;
+
+static ShotLog* globalShotLogPtr = nullptr;
+static ShotAnalytics* globalAnalyticsPtr = nullptr;
+static AutoTimer* globalAutoTimerPtr = nullptr;
+static PourSegmenter* globalPourSegmenterPtr = nullptr;
+static SampleBus* globalSampleBusPtr = nullptr;
+static TaskMonitor* globalTaskMonitorPtr = nullptr;
+static EventBus::SubscriberId socketControlSubscription = -1;
+
+// Time of the last HTTP request - keeps the HTTP power lock held for a while
+static volatile unsigned long lastRequestMs = 0;
+const unsigned long HTTP_ACTIVE_HOLD_MS = 5000;
+
+// Bulk transfers (page assets, history and shot downloads) in flight, and when
+// the last one finished - WiFi gets the coexistence preference from the
+// request until HTTP_HEAVY_HOLD_MS after its response has been sent. Both
+// change on the async TCP task only
+static volatile uint32_t heavyResponses = 0;
+static volatile unsigned long lastHeavyRequestMs = 0;
+const unsigned long HTTP_HEAVY_HOLD_MS = 3000;
+
+// Registered before every route: notes the request and declines it, so the
+// server moves on to the real handler
+class RequestActivityHandler : public AsyncWebHandler {
+public:
+  bool canHandle(AsyncWebServerRequest *request) override {
+    lastRequestMs = millis();
+    String url = request->url();
+    // WebSocket upgrades hand the connection to the socket and delete the
+    // request without its disconnect callback - never count them as heavy
+    bool upgrade = url == telemetrySocket.url() || request->hasHeader("Upgrade");
+    if (!upgrade && (!url.startsWith("/api/") || url.startsWith("/api/history") || url.startsWith("/api/shots"))) {
+      // The request is destroyed once the last chunk is out (or the client went away)
+      heavyResponses++;
+      request->onDisconnect([]() {
+        heavyResponses--;
+        lastHeavyRequestMs = millis();
+      });
+    }
+    return false;
+  }
+};
+
+void setWeightHistory(WeightHistory* history) {
+  globalHistoryPtr = history;
+}
+
+void setShotLog(ShotLog* shotLog) {
+  globalShotLogPtr = shotLog;
+}
+
+void setShotAnalytics(ShotAnalytics* analytics) {
+  globalAnalyticsPtr = analytics;
+}
+
+void setAutoTimer(AutoTimer* autoTimer) {
+  globalAutoTimerPtr = autoTimer;
+}
+
+void setPourSegmenter(PourSegmenter* segmenter) {
+  globalPourSegmenterPtr = segmenter;
+}
+
+void setSampleBus(SampleBus* bus) {
+  globalSampleBusPtr = bus;
+}
+
+void setTaskMonitor(TaskMonitor* monitor) {
+  globalTaskMonitorPtr = monitor;
+}
+
+// Decodes a stored shot curve into CSV while the response is being sent
+struct ShotCsvStream {
+  File file;
+  ShotCurveDecoder decoder;
+  bool headerSent = false;
+  explicit ShotCsvStream(File f) : file(f), decoder(file) {}
+};
 
 /*
  * API Endpoints for External Brewing Systems (e.g., GaggiMate):
@@ -105,15 +208,119 @@ static Scale* globalScalePtr = nullptr;
  * GET /api/brew/status  
  * Response: {"w":45.2,"f":2.1} (weight and flowrate)
  * 
+ * Binary telemetry frame (layout in TelemetryFrame.h):
+ * GET /api/brew/frame[?raw=1]
+ * Response: application/octet-stream, 20 bytes (28 with per-cell raw values)
+ * 
+ * Binary telemetry stream (same frame, pushed per filtered sample):
+ * WebSocket /ws
+ * Shot events arrive on the same socket as text messages:
+ * {"event":"first_drop","t":6200,"weight":0.8,"value":6200}
+ * and control notifications (tare done, timer, settings) as:
+ * {"control":"tared","source":"touch","arg":0}
+ * 
+ * Shot history (full-rate, LTTB-downsampled to max_points):
+ * GET /api/history?since=<seq>&max_points=300[&shot=previous]
+ * Response: {"shot_id":3,"latest_seq":1234,...,"points":[[t_ms,weight,flow],...]}
+ * Pass latest_seq back as since= to fetch only new points.
+ * 
+ * Saved shots (newest first) and their curves:
+ * GET /api/shots?offset=0&limit=20
+ * GET /api/shots/data?id=<id>[&format=csv]  (binary curve, layout in ShotLog.h)
+ * 
+ * FIR filter benchmark (cycles per sample, scalar vs esp-dsp):
+ * GET /api/filter-benchmark?taps=32&samples=1024
+ * 
+ * Firmware tasks (core, priority, stack high-water mark, CPU share):
+ * GET /api/tasks
+ * 
+ * Subsystem timing histograms and per-core idle time (-DWMB_PROFILING builds):
+ * GET /api/perf[?reset=1]
+ * 
+ * Conversion-to-consumer latency per stage (p50/p95/p99, histogram):
+ * GET /api/latency[?reset=1]
+ * 
+ * HX711 acquisition governor (FULL/REDUCED/SPARSE, wake latency, mAh per hour, deep sleep current):
+ * GET /api/acquisition
+ * POST /api/acquisition  sleep_check_ms=1000..30000 (ULP weight wake check period)
+ * 
+ * Power policy (DFS range, light sleep, time each subsystem held full clock):
+ * GET /api/power
+ * 
+ * WiFi modem sleep policy (level in effect, boosts, base-level probes, WebSocket round trip per level):
+ * GET /api/wifi-power[?reset=1]
+ * 
+ * Touch pad input engine (edges, bounces, gesture dispatch delay):
+ * GET /api/input[?reset=1]
+ * 
+ * WiFi/BLE coexistence preference and BLE notification congestion/failure counters per preference:
+ * GET /api/coex[?reset=1]
+ * 
+ * Performance profiles (brew, dose, idle, low_battery - one call retunes everything):
+ * GET /api/profile
+ * POST /api/profile  name=brew|dose|idle|low_battery
+ * 
+ * Boot timeline (per-subsystem start/ready and milestones, µs since boot):
+ * GET /api/boot
+ * 
+ * Pour-over mode (segments the brew into pours and pauses):
+ * GET /api/pour-over
+ * POST /api/pour-over  enabled=true|false
+ * 
  * Standard dashboard:
  * GET /api/dashboard
  * Response: {"weight":45.23,"flowrate":2.15}
+ * Includes "pours":{"phase":"pause","total":120.5,"list":[{"start_ms":0,...}]} in pour-over mode
  */
 
+// Quote user-supplied text (SSIDs, passwords) for a JSON string value
+static String jsonEscape(const String& text) {
+  String escaped;
+  escaped.reserve(text.length() + 8);
+  for (size_t i = 0; i < text.length(); i++) {
+    char c = text[i];
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if ((uint8_t)c < 0x20) {
+      char code[7];
+      snprintf(code, sizeof(code), "\\u%04x", (uint8_t)c);
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+#ifdef EMBED_WEB_ASSETS
+// Stream an embedded asset straight from memory-mapped flash
+static void sendEmbeddedAsset(AsyncWebServerRequest *request, const EmbeddedAsset* asset) {
+  // Content never changes for a given firmware - let the browser revalidate cheaply
+  if (request->hasHeader("If-None-Match") &&
+      request->getHeader("If-None-Match")->value().equals(asset->etag)) {
+    request->send(304);
+    return;
+  }
+  AsyncWebServerResponse *response = request->beginResponse_P(200, asset->contentType, asset->data, asset->length);
+  response->addHeader("Content-Encoding", "gzip");
+  response->addHeader("ETag", asset->etag);
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
+}
+#endif
+
 void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothScale, Display &display, BatteryMonitor &battery) {
   // Store global scale pointer for dual HX711 configuration
   globalScalePtr = &scale;
+  globalFlowRatePtr = &flowRate;
+  globalDisplayPtr = &display;
 
+#ifdef EMBED_WEB_ASSETS
+  // Web UI is compiled into the firmware - no filesystem mount needed
+  Serial.printf("Web UI: %u embedded assets (%u bytes gzip) served from flash\n",
+                (unsigned)getEmbeddedAssetCount(), (unsigned)getEmbeddedAssetBytes());
+#else
   if (!LittleFS.begin()) {
     Serial.println();
     Serial.println("=====================================");
@@ -133,6 +340,7 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     Serial.println();
     return;
   }
+#endif
 
   // Run EEPROM diagnostics
   diagnoseEEPROMPerformance();
@@ -142,6 +350,9 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
   getCachedDecimals();        // This will cache the decimal setting
   getStoredSSID();            // This will cache WiFi credentials
 
+  // Activity tracking for the power policy - must stay the first handler
+  server.addHandler(new RequestActivityHandler());
+
   // Register API route first
   server.on("/api/dashboard", HTTP_GET, [&scale, &flowRate, &display, &battery, &bluetoothScale](AsyncWebServerRequest *request) {
     String json = "{";
@@ -198,26 +409,210 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     json += ",\"bluetooth_connected\":" + String(bluetoothScale.isConnected() ? "true" : "false");
     json += ",\"bluetooth_signal_strength\":" + String(bluetoothScale.getBluetoothSignalStrength());
     
+    // Add shot analytics of the current/last shot
+    if (globalAnalyticsPtr != nullptr) {
+      const ShotSummary& shot = globalAnalyticsPtr->getSummary();
+      json += ",\"shot\":{\"phase\":\"" + String(ShotAnalytics::phaseName(shot.phase)) + "\"";
+      json += ",\"first_drop_ms\":" + (shot.hasFirstDrop ? String(shot.firstDropMs) : String("null"));
+      json += ",\"peak_flowrate\":" + String(shot.peakFlowRate, 2);
+      json += ",\"mean_flowrate\":" + String(shot.meanFlowRate, 2);
+      json += ",\"flow_stddev\":" + String(shot.flowStdDev, 2);
+      json += ",\"yield\":" + (shot.settled ? String(shot.yieldWeight, 2) : String("null"));
+      json += "}";
+    }
+    
+    // Add pour segmentation in pour-over mode
+    if (globalPourSegmenterPtr != nullptr && globalPourSegmenterPtr->isEnabled()) {
+      json += ",\"pours\":{\"phase\":\"" + String(PourSegmenter::phaseName(globalPourSegmenterPtr->getPhase())) + "\"";
+      json += ",\"total\":" + String(globalPourSegmenterPtr->getTotalVolume(), 1);
+      json += ",\"list\":[";
+      for (size_t i = 0; i < globalPourSegmenterPtr->getPourCount(); i++) {
+        const PourSegment& pour = globalPourSegmenterPtr->getPour(i);
+        if (i > 0) json += ",";
+        json += "{\"start_ms\":" + String(pour.startMs);
+        json += ",\"duration_ms\":" + String(pour.durationMs);
+        json += ",\"pause_before_ms\":" + String(pour.pauseBeforeMs);
+        json += ",\"volume\":" + String(pour.volume, 1);
+        json += ",\"flowrate\":" + String(pour.flowRate, 2) + "}";
+      }
+      json += "]}";
+    }
+    
     json += "}";
     request->send(200, "application/json", json);
   });
 
   // Timer control endpoints
-  server.on("/api/timer/start", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.startTimer();
+  server.on("/api/timer/start", HTTP_POST, [](AsyncWebServerRequest *request) {
+    controlEvents.publish(ControlEventType::TIMER_START, EventSource::WEB);
     request->send(200, "text/plain", "Timer started");
   });
 
-  server.on("/api/timer/stop", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.stopTimer();
+  server.on("/api/timer/stop", HTTP_POST, [](AsyncWebServerRequest *request) {
+    controlEvents.publish(ControlEventType::TIMER_STOP, EventSource::WEB);
     request->send(200, "text/plain", "Timer stopped");
   });
 
-  server.on("/api/timer/reset", HTTP_POST, [&display](AsyncWebServerRequest *request) {
-    display.resetTimer();
+  server.on("/api/timer/reset", HTTP_POST, [](AsyncWebServerRequest *request) {
+    controlEvents.publish(ControlEventType::TIMER_RESET, EventSource::WEB);
     request->send(200, "text/plain", "Timer reset");
   });
 
+  // Flow-triggered automatic timer setting
+  server.on("/api/auto-timer", HTTP_GET, [](AsyncWebServerRequest *request) {
+    bool enabled = globalAutoTimerPtr != nullptr && globalAutoTimerPtr->isEnabled();
+    request->send(200, "application/json", String("{\"enabled\":") + (enabled ? "true" : "false") + "}");
+  });
+
+  server.on("/api/auto-timer", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (globalAutoTimerPtr == nullptr) {
+      request->send(503, "text/plain", "Auto timer not available");
+      return;
+    }
+    if (!request->hasParam("enabled", true)) {
+      request->send(400, "text/plain", "Missing enabled parameter");
+      return;
+    }
+    String value = request->getParam("enabled", true)->value();
+    bool enabled = value == "true" || value == "1";
+    globalAutoTimerPtr->setEnabled(enabled);
+    controlEvents.publish(ControlEventType::SETTINGS_CHANGED, EventSource::WEB, SETTINGS_TIMER);
+    request->send(200, "text/plain", enabled ? "Auto timer enabled" : "Auto timer disabled");
+  });
+
+  // Firmware tasks: stack watermarks and CPU share per task
+  server.on("/api/tasks", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (globalTaskMonitorPtr == nullptr) {
+      request->send(503, "text/plain", "Task monitor not available");
+      return;
+    }
+    request->send(200, "application/json", globalTaskMonitorPtr->toJson());
+  });
+
+  // Subsystem profiling - only compiled into -DWMB_PROFILING builds
+  server.on("/api/perf", HTTP_GET, [](AsyncWebServerRequest *request) {
+#ifdef WMB_PROFILING
+    String json = Profiler::toJson();
+    if (request->hasParam("reset")) {
+      Profiler::reset();
+    }
+    request->send(200, "application/json", json);
+#else
+    request->send(200, "application/json", "{\"enabled\":false}");
+#endif
+  });
+
+  // Age of the sample at each stage, measured from its HX711 conversion
+  server.on("/api/latency", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String json = latencyTracer.toJson();
+    if (request->hasParam("reset")) {
+      latencyTracer.reset();
+    }
+    request->send(200, "application/json", json);
+  });
+
+  // HX711 acquisition governor - mode, wake-up latency and estimated energy per hour
+  server.on("/api/acquisition", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (globalScalePtr == nullptr) {
+      request->send(503, "application/json", "{\"error\":\"Scale not available\"}");
+      return;
+    }
+    request->send(200, "application/json", globalScalePtr->getGovernor().toJson());
+  });
+
+  server.on("/api/acquisition", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!request->hasParam("sleep_check_ms", true)) {
+      request->send(400, "text/plain", "Missing sleep_check_ms parameter");
+      return;
+    }
+    uint32_t periodMs = strtoul(request->getParam("sleep_check_ms", true)->value().c_str(), nullptr, 10);
+    if (!UlpWake::setCheckPeriodMs(periodMs)) {
+      request->send(400, "text/plain", "sleep_check_ms must be between " + String(UlpWake::MIN_CHECK_PERIOD_MS) +
+                    " and " + String(UlpWake::MAX_CHECK_PERIOD_MS));
+      return;
+    }
+    request->send(200, "text/plain", "Sleep check period set to " + String(periodMs) + "ms");
+  });
+
+  // CPU frequency policy and per-subsystem power lock usage
+  server.on("/api/power", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(200, "application/json", powerPolicy.toJson());
+  });
+
+  server.on("/api/wifi-power", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String json = getWiFiPowerSaveJson();
+    if (request->hasParam("reset")) {
+      resetWiFiRoundTrips();
+    }
+    request->send(200, "application/json", json);
+  });
+
+  server.on("/api/input", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String json = inputEngine.toJson();
+    if (request->hasParam("reset")) {
+      inputEngine.reset();
+    }
+    request->send(200, "application/json", json);
+  });
+
+  server.on("/api/coex", HTTP_GET, [](AsyncWebServerRequest *request) {
+    String json = coexPolicy.toJson();
+    if (request->hasParam("reset")) {
+      coexPolicy.reset();
+    }
+    request->send(200, "application/json", json);
+  });
+
+  server.on("/api/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(200, "application/json", profileManager.toJson());
+  });
+
+  server.on("/api/profile", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!request->hasParam("name", true)) {
+      request->send(400, "text/plain", "Missing name parameter");
+      return;
+    }
+    ProfileId id;
+    String name = request->getParam("name", true)->value();
+    if (!ProfileManager::fromName(name, id)) {
+      request->send(400, "text/plain", "Unknown profile");
+      return;
+    }
+    // Executed on the acquisition task; SETTINGS_CHANGED tells /ws clients when it is active
+    if (!profileManager.request(id, EventSource::WEB)) {
+      request->send(503, "text/plain", "Control queue full");
+      return;
+    }
+    request->send(200, "application/json", "{\"status\":\"switching\",\"profile\":\"" + String(ProfileManager::name(id)) + "\"}");
+  });
+
+  // Boot timeline recorded by the init scheduler
+  server.on("/api/boot", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(200, "application/json", bootScheduler.toJson());
+  });
+
+  // Pour-over mode: pour/pause segmentation and filter switching
+  server.on("/api/pour-over", HTTP_GET, [](AsyncWebServerRequest *request) {
+    bool enabled = globalPourSegmenterPtr != nullptr && globalPourSegmenterPtr->isEnabled();
+    request->send(200, "application/json", String("{\"enabled\":") + (enabled ? "true" : "false") + "}");
+  });
+
+  server.on("/api/pour-over", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (globalPourSegmenterPtr == nullptr) {
+      request->send(503, "text/plain", "Pour-over mode not available");
+      return;
+    }
+    if (!request->hasParam("enabled", true)) {
+      request->send(400, "text/plain", "Missing enabled parameter");
+      return;
+    }
+    String value = request->getParam("enabled", true)->value();
+    bool enabled = value == "true" || value == "1";
+    globalPourSegmenterPtr->setEnabled(enabled);
+    controlEvents.publish(ControlEventType::SETTINGS_CHANGED, EventSource::WEB, SETTINGS_BREW);
+    request->send(200, "text/plain", enabled ? "Pour-over mode enabled" : "Pour-over mode disabled");
+  });
+
   server.on("/api/weight", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
     request->send(200, "text/plain", String(scale.getCurrentWeight()));
   });
@@ -233,6 +628,7 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     // Ultra-fast response for brewing systems
     float weight = scale.getCurrentWeight();
     request->send(200, "text/plain", String(weight, 1)); // 1 decimal for speed
+    latencyTracer.mark(LATENCY_HTTP_RESPONSE, scale.getSampleTimestampUs());
   });
   
   server.on("/api/brew/status", HTTP_GET, [&scale, &flowRate](AsyncWebServerRequest *request) {
@@ -240,6 +636,136 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     String json = "{\"w\":" + String(scale.getCurrentWeight(), 1) + 
                   ",\"f\":" + String(flowRate.getFlowRate(), 1) + "}";
     request->send(200, "application/json", json);
+    latencyTracer.mark(LATENCY_HTTP_RESPONSE, scale.getSampleTimestampUs());
+  });
+
+  // Binary telemetry frame - same encoding as the WebSocket and BLE telemetry streams
+  server.on("/api/brew/frame", HTTP_GET, [&scale, &flowRate, &display](AsyncWebServerRequest *request) {
+    bool includeRaw = request->hasParam("raw") && request->getParam("raw")->value() == "1";
+    TelemetrySample sample = TelemetryFrame::capture(scale, &flowRate, &display, includeRaw);
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    size_t length = TelemetryFrame::encode(sample, frame, sizeof(frame));
+    AsyncResponseStream *response = request->beginResponseStream("application/octet-stream");
+    response->write(frame, length);
+    request->send(response);
+    latencyTracer.mark(LATENCY_HTTP_RESPONSE, sample.timestampUs);
+  });
+
+  // Weight/flow history of the current or previous shot
+  server.on("/api/history", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (globalHistoryPtr == nullptr || !globalHistoryPtr->isReady()) {
+      request->send(503, "application/json", "{\"error\":\"History not available\"}");
+      return;
+    }
+    
+    uint32_t since = 0;
+    if (request->hasParam("since")) {
+      since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+    }
+    size_t maxPoints = 300;
+    if (request->hasParam("max_points")) {
+      maxPoints = constrain(request->getParam("max_points")->value().toInt(), 3, 1000);
+    }
+    bool previousShot = request->hasParam("shot") && request->getParam("shot")->value() == "previous";
+    
+    HistoryPoint* points = (HistoryPoint*)malloc(maxPoints * sizeof(HistoryPoint));
+    if (points == nullptr) {
+      request->send(503, "application/json", "{\"error\":\"Out of memory\"}");
+      return;
+    }
+    
+    HistoryQueryInfo info;
+    size_t count = globalHistoryPtr->query(previousShot, since, maxPoints, points, info);
+    
+    // Stream the JSON instead of building one large String
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->printf("{\"shot\":\"%s\",\"shot_id\":%u,\"latest_seq\":%u,\"available\":%u,"
+                     "\"returned\":%u,\"buffered\":%u,\"capacity\":%u,\"downsampled\":%s,\"points\":[",
+                     previousShot ? "previous" : "current", (unsigned)info.shotId, (unsigned)info.latestSequence,
+                     (unsigned)info.available, (unsigned)count, (unsigned)info.buffered,
+                     (unsigned)globalHistoryPtr->getCapacity(), info.downsampled ? "true" : "false");
+    for (size_t i = 0; i < count; i++) {
+      response->printf("%s[%u,%.2f,%.2f]", i > 0 ? "," : "", (unsigned)points[i].timeMs,
+                       points[i].weight, points[i].flowRate);
+    }
+    response->print("]}");
+    free(points);
+    request->send(response);
+  });
+
+  // Shot log listing (newest first, paginated)
+  server.on("/api/shots", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (globalShotLogPtr == nullptr || !globalShotLogPtr->isReady()) {
+      request->send(503, "application/json", "{\"error\":\"Shot log not available\"}");
+      return;
+    }
+    
+    size_t offset = request->hasParam("offset") ? request->getParam("offset")->value().toInt() : 0;
+    size_t limit = request->hasParam("limit") ? constrain(request->getParam("limit")->value().toInt(), 1, 25) : 20;
+    
+    ShotIndexEntry entries[25];
+    size_t total = 0;
+    size_t count = globalShotLogPtr->listShots(offset, limit, entries, total);
+    
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->printf("{\"total\":%u,\"offset\":%u,\"dropped_chunks\":%u,\"fs_used\":%u,\"fs_total\":%u,\"shots\":[",
+                     (unsigned)total, (unsigned)offset, (unsigned)globalShotLogPtr->getDroppedChunks(),
+                     (unsigned)LittleFS.usedBytes(), (unsigned)LittleFS.totalBytes());
+    for (size_t i = 0; i < count; i++) {
+      response->printf("%s{\"id\":%u,\"duration_ms\":%u,\"points\":%u,\"bytes\":%u,"
+                       "\"final_weight\":%.2f,\"avg_flowrate\":%.2f,\"peak_flowrate\":%.2f,"
+                       "\"first_drop_ms\":%u,\"flow_stddev\":%.2f,\"yield\":%.2f}",
+                       i > 0 ? "," : "", (unsigned)entries[i].id, (unsigned)entries[i].durationMs,
+                       (unsigned)entries[i].points, (unsigned)entries[i].bytes, entries[i].finalWeight,
+                       entries[i].avgFlowRate, entries[i].peakFlowRate, (unsigned)entries[i].firstDropMs,
+                       entries[i].flowStdDev, entries[i].yieldWeight);
+    }
+    response->print("]}");
+    request->send(response);
+  });
+  
+  // Single shot curve, streamed from flash
+  server.on("/api/shots/data", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (!request->hasParam("id")) {
+      request->send(400, "text/plain", "Missing id parameter");
+      return;
+    }
+    String path = ShotLog::curvePath(strtoul(request->getParam("id")->value().c_str(), nullptr, 10));
+    if (!LittleFS.exists(path)) {
+      request->send(404, "text/plain", "Shot not found");
+      return;
+    }
+    
+    bool csv = request->hasParam("format") && request->getParam("format")->value() == "csv";
+    if (!csv) {
+      request->send(LittleFS, path, "application/octet-stream");
+      return;
+    }
+    
+    // Decode on the fly - the whole curve is never held in RAM
+    std::shared_ptr<ShotCsvStream> stream = std::make_shared<ShotCsvStream>(LittleFS.open(path, "r"));
+    uint32_t shotId;
+    if (!stream->file || !stream->decoder.readHeader(shotId)) {
+      request->send(500, "text/plain", "Corrupt shot file");
+      return;
+    }
+    request->send(request->beginChunkedResponse("text/csv", [stream](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      size_t written = 0;
+      if (!stream->headerSent && maxLen > 32) {
+        written += snprintf((char*)buffer, maxLen, "time_ms,weight,flowrate\n");
+        stream->headerSent = true;
+      }
+      ShotPoint point;
+      // 40 bytes is more than the longest possible line
+      while (maxLen - written > 40 && stream->decoder.next(point)) {
+        written += snprintf((char*)buffer + written, maxLen - written, "%u,%.2f,%.2f\n",
+                            (unsigned)point.timeMs, point.weight, point.flowRate);
+      }
+      if (written == 0) {
+        stream->file.close(); // End of curve
+      }
+      return written;
+    }));
   });
 
   // Battery calibration endpoints (must be before general /api/battery route)
@@ -333,14 +859,9 @@ void setupWebServer(Scale &scale, FlowRate &flowRate, BluetoothScale &bluetoothS
     request->send(200, "application/json", json);
   });
 
-  server.on("/api/tare", HTTP_POST, [&scale, &display, &flowRate](AsyncWebServerRequest *request){
-    scale.tare(20);
-    
-    // Reset timer when taring (prepare for fresh brew)
-    display.resetTimer();
-    
-    // Reset flow rate averaging for fresh brew measurement
-    flowRate.resetTimerAveraging();
+  server.on("/api/tare", HTTP_POST, [](AsyncWebServerRequest *request){
+    // Brew control runs the tare on the acquisition loop and resets timer and flow averaging
+    controlEvents.publish(ControlEventType::TARE, EventSource::WEB, 20);
     
     request->send(200, "text/plain", "Scale tared! Timer and flow rate reset for fresh brew.");
   });
@@ -502,7 +1023,7 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
   server.on("/api/wifi-creds", HTTP_GET, [](AsyncWebServerRequest *request) {
     String ssid = getStoredSSID();
     String password = getStoredPassword();
-    String json = "{\"ssid\":\"" + ssid + "\",\"password\":\"" + password + "\"}";
+    String json = "{\"ssid\":\"" + jsonEscape(ssid) + "\",\"password\":\"" + jsonEscape(password) + "\"}";
     request->send(200, "application/json", json);
   });
 
@@ -516,20 +1037,16 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
       // Save credentials first
       saveWiFiCredentials(ssid.c_str(), password.c_str());
       
-      // Attempt immediate STA connection to avoid needing a reboot
-      bool connected = attemptSTAConnection(ssid.c_str(), password.c_str());
-      
-      if (connected) {
+      // Connect in the background - the AP drops once the switch starts, so answer first
+      if (attemptSTAConnection(ssid.c_str(), password.c_str())) {
         request->send(200, "application/json", 
-          "{\"status\":\"success\",\"message\":\"Connected successfully! AP mode disabled for power savings.\",\"ip\":\"" + WiFi.localIP().toString() + "\"}");
+          "{\"status\":\"connecting\",\"message\":\"Connecting to " + jsonEscape(ssid) + "... Reconnect to your home network and open http://weighmybru.local. If the connection fails, 'WeighMyBru-AP' comes back.\"}");
       } else {
-        // Connection failed - switch back to AP mode
-        switchToAPMode();
         request->send(200, "application/json", 
-          "{\"status\":\"failed\",\"message\":\"Connection failed. Check credentials and try again. AP mode restored.\"}");
+          "{\"status\":\"saved\",\"message\":\"Credentials saved. WiFi is off - they are used when WiFi is turned on.\"}");
       }
     } else {
-      request->send(400, "text/plain", "Missing SSID or password");
+      request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing SSID or password\"}");
     }
   });
 
@@ -538,13 +1055,52 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     request->send(200, "text/plain", "WiFi credentials cleared. Reboot to apply changes.");
   });
 
+  // Static IP (optional) - DHCP otherwise, with the last lease reused on fast reconnects
+  server.on("/api/wifi-ip", HTTP_GET, [](AsyncWebServerRequest *request) {
+    IPAddress ip, gateway, subnet, dns;
+    bool enabled = getStaticIPConfig(ip, gateway, subnet, dns);
+    String json = "{\"static\":" + String(enabled ? "true" : "false");
+    json += ",\"ip\":\"" + ip.toString() + "\"";
+    json += ",\"gateway\":\"" + gateway.toString() + "\"";
+    json += ",\"subnet\":\"" + subnet.toString() + "\"";
+    json += ",\"dns\":\"" + dns.toString() + "\"}";
+    request->send(200, "application/json", json);
+  });
+
+  server.on("/api/wifi-ip", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!request->hasParam("static", true)) {
+      request->send(400, "text/plain", "Missing static parameter");
+      return;
+    }
+    bool enabled = request->getParam("static", true)->value() == "true";
+    IPAddress ip, gateway, subnet, dns;
+    if (enabled) {
+      if (!request->hasParam("ip", true) || !request->hasParam("gateway", true) || !request->hasParam("subnet", true) ||
+          !ip.fromString(request->getParam("ip", true)->value().c_str()) ||
+          !gateway.fromString(request->getParam("gateway", true)->value().c_str()) ||
+          !subnet.fromString(request->getParam("subnet", true)->value().c_str())) {
+        request->send(400, "text/plain", "Invalid IP, gateway or subnet");
+        return;
+      }
+      // DNS defaults to the gateway
+      if (!request->hasParam("dns", true) || !dns.fromString(request->getParam("dns", true)->value().c_str())) {
+        dns = gateway;
+      }
+    }
+    saveStaticIPConfig(enabled, ip, gateway, subnet, dns);
+    request->send(200, "text/plain", enabled ? "Static IP saved - used from the next connect" : "DHCP enabled - used from the next connect");
+  });
+
   // WiFi Power Management endpoints
   server.on("/api/wifi-status", HTTP_GET, [](AsyncWebServerRequest *request) {
     String json = "{";
     json += "\"enabled\":" + String(isWiFiEnabled() ? "true" : "false") + ",";
-    json += "\"connected\":" + String((WiFi.status() == WL_CONNECTED) ? "true" : "false");
+    json += "\"connected\":" + String((WiFi.status() == WL_CONNECTED) ? "true" : "false") + ",";
+    json += "\"state\":\"" + String(getWiFiStateName()) + "\",";
+    json += "\"connect_ms\":" + String(getLastConnectTimeMs()) + ",";
+    json += "\"connect_method\":\"" + String(getLastConnectMethod()) + "\"";
     if (WiFi.status() == WL_CONNECTED) {
-      json += ",\"ssid\":\"" + WiFi.SSID() + "\"";
+      json += ",\"ssid\":\"" + jsonEscape(WiFi.SSID()) + "\"";
     }
     json += "}";
     request->send(200, "application/json", json);
@@ -554,10 +1110,8 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     bool currentlyEnabled = isWiFiEnabled() && WiFi.getMode() != WIFI_OFF;
     
     if (currentlyEnabled) {
-      // Send response before disabling WiFi
+      // disableWiFi() is deferred, so the response still goes out
       request->send(200, "text/plain", "WiFi disabled for battery saving. Device will be inaccessible until WiFi is re-enabled.");
-      // Add delay to allow response to be sent, then disable WiFi
-      delay(100);
       disableWiFi();
     } else {
       enableWiFi();
@@ -572,10 +1126,8 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
         enableWiFi();
         request->send(200, "text/plain", "WiFi enabled");
       } else {
-        // Send response before disabling WiFi
+        // disableWiFi() is deferred, so the response still goes out
         request->send(200, "text/plain", "WiFi disabled for battery saving. Device will be inaccessible until WiFi is re-enabled.");
-        // Add delay to allow response to be sent, then disable WiFi
-        delay(100);
         disableWiFi();
       }
     } else {
@@ -633,7 +1185,11 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     json += "\"brewingThreshold\":" + String(scale.getBrewingThreshold(), 2) + ",";
     json += "\"stabilityTimeout\":" + String(scale.getStabilityTimeout()) + ",";
     json += "\"medianSamples\":" + String(scale.getMedianSamples()) + ",";
-    json += "\"averageSamples\":" + String(scale.getAverageSamples());
+    json += "\"averageSamples\":" + String(scale.getAverageSamples()) + ",";
+    json += "\"notchEnabled\":" + String(scale.isNotchEnabled() ? "true" : "false") + ",";
+    json += "\"firEnabled\":" + String(scale.isFirEnabled() ? "true" : "false") + ",";
+    json += "\"firTaps\":" + String(scale.getFirTaps()) + ",";
+    json += "\"firCutoff\":" + String(scale.getFirCutoff(), 1);
     json += "}";
     request->send(200, "application/json", json);
   });
@@ -666,8 +1222,23 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
       response += "Average samples updated. ";
       updated = true;
     }
+    if (request->hasParam("notchEnabled", true)) {
+      String value = request->getParam("notchEnabled", true)->value();
+      scale.setNotchEnabled(value == "true" || value == "1");
+      response += "Vibration notch updated. ";
+      updated = true;
+    }
+    if (request->hasParam("firEnabled", true)) {
+      String value = request->getParam("firEnabled", true)->value();
+      int taps = request->hasParam("firTaps", true) ? request->getParam("firTaps", true)->value().toInt() : scale.getFirTaps();
+      float cutoff = request->hasParam("firCutoff", true) ? request->getParam("firCutoff", true)->value().toFloat() : scale.getFirCutoff();
+      scale.setFirSettings(value == "true" || value == "1", taps, cutoff);
+      response += "FIR filter updated. ";
+      updated = true;
+    }
     
     if (updated) {
+      controlEvents.publish(ControlEventType::SETTINGS_CHANGED, EventSource::WEB, SETTINGS_FILTER);
       response += "\"}";
       request->send(200, "application/json", response);
     } else {
@@ -675,6 +1246,29 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     }
   });
 
+  // FIR kernel benchmark - scalar reference vs esp-dsp (PIE) in CPU cycles per sample
+  server.on("/api/filter-benchmark", HTTP_GET, [](AsyncWebServerRequest *request) {
+    size_t taps = request->hasParam("taps") ? request->getParam("taps")->value().toInt() : 32;
+    size_t samples = request->hasParam("samples") ? request->getParam("samples")->value().toInt() : 1024;
+    if (samples < 64) samples = 64;
+    if (samples > 8192) samples = 8192;
+    
+    FirBenchmark result = FirFilter::benchmark(taps, samples);
+    String json = "{";
+    json += "\"taps\":" + String(result.taps) + ",";
+    json += "\"samples\":" + String(result.samples) + ",";
+    json += "\"cpu_mhz\":" + String(getCpuFrequencyMhz()) + ",";
+    json += "\"scalar_cycles_per_sample\":" + String(result.scalarCyclesPerSample, 1) + ",";
+    if (result.vectorCyclesPerSample > 0.0f) {
+      json += "\"esp_dsp_cycles_per_sample\":" + String(result.vectorCyclesPerSample, 1) + ",";
+      json += "\"speedup\":" + String(result.scalarCyclesPerSample / result.vectorCyclesPerSample, 2);
+    } else {
+      json += "\"esp_dsp_cycles_per_sample\":null,\"speedup\":null";
+    }
+    json += "}";
+    request->send(200, "application/json", json);
+  });
+
   // Filter debug endpoint - shows current filter state
   server.on("/api/filter-debug", HTTP_GET, [&scale](AsyncWebServerRequest *request) {
     String json = "{";
@@ -684,6 +1278,24 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     json += "\"medianSamples\":" + String(scale.getMedianSamples()) + ",";
     json += "\"averageSamples\":" + String(scale.getAverageSamples()) + ",";
     json += "\"currentWeight\":" + String(scale.getCurrentWeight(), 1) + ",";
+    
+    // Pump vibration analysis
+    const VibrationFilter& vibration = scale.getVibrationFilter();
+    json += "\"notch\":{\"enabled\":" + String(vibration.isEnabled() ? "true" : "false");
+    json += ",\"locked\":" + String(vibration.isLocked() ? "true" : "false");
+    json += ",\"frequency_hz\":" + String(vibration.getNotchFrequency(), 2);
+    json += ",\"sample_rate_hz\":" + String(vibration.getSampleRate(), 1);
+    json += ",\"peak_ratio\":" + String(vibration.getPeakRatio(), 1);
+    json += ",\"analysis_us\":" + String(vibration.getAnalysisMicros());
+    json += ",\"fft\":\"" + String(WMB_HAS_ESP_DSP ? "esp-dsp" : "portable") + "\"},";
+    
+    // FIR low-pass stage
+    const FirFilter& fir = scale.getFirFilter();
+    json += "\"fir\":{\"enabled\":" + String(scale.isFirEnabled() ? "true" : "false");
+    json += ",\"taps\":" + String(fir.getTaps());
+    json += ",\"cutoff_hz\":" + String(fir.getCutoff(), 1);
+    json += ",\"design_rate_hz\":" + String(fir.getDesignRate(), 1);
+    json += ",\"group_delay_ms\":" + String(fir.getGroupDelayMs(), 0) + "},";
     json += "\"hx711_config\":\"";
     json += scale.isDualHX711() ? "DUAL" : "SINGLE";
     json += "\",";
@@ -703,8 +1315,8 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     
     // Combine into single JSON response
     String json = "{";
-    json += "\"ssid\":\"" + ssid + "\",";
-    json += "\"password\":\"" + password + "\",";
+    json += "\"ssid\":\"" + jsonEscape(ssid) + "\",";
+    json += "\"password\":\"" + jsonEscape(password) + "\",";
     json += "\"decimals\":" + String(decimals);
     json += "}";
     
@@ -730,6 +1342,14 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
       clearPrefs.clear();
       clearPrefs.end();
       
+      clearPrefs.begin("timer", false);
+      clearPrefs.clear();
+      clearPrefs.end();
+      
+      clearPrefs.begin("brew", false);
+      clearPrefs.clear();
+      clearPrefs.end();
+      
       request->send(200, "text/plain", "NVS storage reset. Device will restart in 3 seconds.");
       
       // Restart the ESP32 after a short delay
@@ -740,6 +1360,25 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
     }
   });
 
+#ifdef EMBED_WEB_ASSETS
+  // Serve embedded files for non-API paths, with SPA fallback to index.html
+  server.onNotFound([](AsyncWebServerRequest *request) {
+    String path = request->url();
+    if (path.startsWith("/api/")) {
+      request->send(404, "text/plain", "API endpoint not found");
+      return;
+    }
+    const EmbeddedAsset* asset = findEmbeddedAsset(path);
+    if (asset == nullptr) {
+      asset = findEmbeddedAsset("/index.html");
+    }
+    if (asset == nullptr) {
+      request->send(404, "text/plain", "Not found");
+      return;
+    }
+    sendEmbeddedAsset(request, asset);
+  });
+#else
   // Serve static files for non-API paths
   server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
 
@@ -771,6 +1410,30 @@ server.on("/api/scale/calibration/status", HTTP_GET, [&scale](AsyncWebServerRequ
   server.on("/webfonts/fa-regular-400.woff2", HTTP_GET, [](AsyncWebServerRequest *request) {
     request->send(LittleFS, "/webfonts/fa-regular-400.woff2", "font/woff2");
   });
+#endif
+
+  // Control notifications forwarded to /ws clients
+  socketControlSubscription = controlEvents.subscribe(
+      EVENT_MASK(ControlEventType::TARED) | EVENT_MASK(ControlEventType::TIMER_START) |
+      EVENT_MASK(ControlEventType::TIMER_STOP) | EVENT_MASK(ControlEventType::TIMER_RESET) |
+      EVENT_MASK(ControlEventType::SETTINGS_CHANGED), "websocket");
+
+  telemetrySocket.onEvent([](AsyncWebSocket *socket, AsyncWebSocketClient *client, AwsEventType type,
+                              void *arg, uint8_t *data, size_t len) {
+    if (type == WS_EVT_CONNECT) {
+      Serial.printf("Telemetry client #%u connected\n", client->id());
+      controlEvents.publish(ControlEventType::CLIENT_CONNECTED, EventSource::WEB, CLIENT_WEBSOCKET);
+    } else if (type == WS_EVT_DISCONNECT) {
+      Serial.printf("Telemetry client #%u disconnected\n", client->id());
+      controlEvents.publish(ControlEventType::CLIENT_DISCONNECTED, EventSource::WEB, CLIENT_WEBSOCKET);
+    } else if (type == WS_EVT_PONG && len == sizeof(uint32_t) + 1) {
+      // Our ping carries its send time and modem sleep level - the round trip includes any modem sleep wait
+      uint32_t sentMs;
+      memcpy(&sentMs, data, sizeof(sentMs));
+      recordWiFiRoundTrip(millis() - sentMs, (wifi_ps_type_t)data[sizeof(sentMs)]);
+    }
+  });
+  server.addHandler(&telemetrySocket);
 
   // Only start the web server if WiFi is enabled
   if (isWiFiEnabled()) {
@@ -788,6 +1451,96 @@ void startWebServer() {
   }
 }
 
+bool isWebServerActive() {
+  if (telemetrySocket.count() > 0) {
+    return true;
+  }
+  unsigned long last = lastRequestMs;
+  return last != 0 && millis() - last < HTTP_ACTIVE_HOLD_MS;
+}
+
+bool isWebHeavy() {
+  if (heavyResponses > 0) {
+    return true;
+  }
+  unsigned long last = lastHeavyRequestMs;
+  return last != 0 && millis() - last < HTTP_HEAVY_HOLD_MS;
+}
+
+void updateWebTelemetry() {
+  static uint32_t lastSequence = 0;
+  static unsigned long lastCleanup = 0;
+  
+  if (globalScalePtr == nullptr) {
+    return;
+  }
+  
+  // Drop closed sockets once per second, and ping the rest to measure the round trip
+  if (millis() - lastCleanup >= 1000) {
+    telemetrySocket.cleanupClients();
+    lastCleanup = millis();
+    if (telemetrySocket.count() > 0) {
+      uint8_t payload[sizeof(uint32_t) + 1];
+      uint32_t sentMs = lastCleanup;
+      memcpy(payload, &sentMs, sizeof(sentMs));
+      payload[sizeof(sentMs)] = (uint8_t)getWiFiPowerSave();
+      telemetrySocket.pingAll(payload, sizeof(payload));
+    }
+  }
+  
+  // Shot events go out as small JSON text messages
+  static uint32_t shotEventCursor = 0;
+  if (globalAnalyticsPtr != nullptr) {
+    ShotEvent event;
+    while (globalAnalyticsPtr->nextEvent(shotEventCursor, event)) {
+      if (telemetrySocket.count() > 0) {
+        char message[128];
+        snprintf(message, sizeof(message), "{\"event\":\"%s\",\"t\":%u,\"weight\":%.2f,\"value\":%.2f}",
+                 ShotAnalytics::eventName(event.type), (unsigned)event.shotTimeMs, event.weight, event.value);
+        telemetrySocket.textAll(message);
+      }
+    }
+  }
+  
+  // Tare, timer and settings changes go out as text so open pages refresh at once
+  ControlEvent controlEvent;
+  while (controlEvents.receive(socketControlSubscription, controlEvent, 0)) {
+    if (telemetrySocket.count() > 0) {
+      char message[96];
+      snprintf(message, sizeof(message), "{\"control\":\"%s\",\"source\":\"%s\",\"arg\":%u}",
+               EventBus::typeName(controlEvent.type), EventBus::sourceName(controlEvent.source),
+               (unsigned)controlEvent.arg);
+      telemetrySocket.textAll(message);
+    }
+  }
+  
+  // Only push when somebody listens and a new filtered sample exists
+  TelemetrySample sample;
+  static SampleCursor socketCursor(SamplePolicy::LATEST);
+  if (globalSampleBusPtr != nullptr) {
+    if (telemetrySocket.count() == 0) {
+      globalSampleBusPtr->attach(socketCursor); // Nobody listens - stay at the head
+      return;
+    }
+    if (!globalSampleBusPtr->read(socketCursor, sample)) {
+      return;
+    }
+  } else {
+    if (telemetrySocket.count() == 0 || globalScalePtr->getSampleSequence() == lastSequence) {
+      return;
+    }
+    sample = TelemetryFrame::capture(*globalScalePtr, globalFlowRatePtr, globalDisplayPtr, false);
+    lastSequence = sample.sequence;
+  }
+  
+  uint8_t frame[TelemetryFrame::MAX_SIZE];
+  size_t length = TelemetryFrame::encode(sample, frame, sizeof(frame));
+  if (length > 0) {
+    telemetrySocket.binaryAll(frame, length);
+    latencyTracer.mark(LATENCY_WS_SEND, sample.timestampUs);
+  }
+}
+
 void stopWebServer() {
   server.end();
   Serial.println("Web server stopped");
@@ -0,0 +1,219 @@
+#include "WeightHistory.h"
+
+WeightHistory::WeightHistory() : current(&buffers[0]), previous(&buffers[1]), capacity(0),
+    usingPSRAM(false), nextShotId(1), lastSequence(0), mutex(nullptr) {
+    for (int i = 0; i < 2; i++) {
+        buffers[i].points = nullptr;
+        buffers[i].head = 0;
+        buffers[i].count = 0;
+        buffers[i].shotId = 0;
+        buffers[i].startUs = 0;
+        buffers[i].started = false;
+    }
+}
+
+bool WeightHistory::begin() {
+    if (isReady()) {
+        return true;
+    }
+
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == nullptr) {
+        Serial.println("WeightHistory: failed to create mutex");
+        return false;
+    }
+
+    // Prefer PSRAM - the internal heap is needed by WiFi and BLE
+    if (psramFound()) {
+        capacity = PSRAM_CAPACITY;
+        buffers[0].points = (HistoryPoint*)ps_malloc(capacity * sizeof(HistoryPoint));
+        buffers[1].points = (HistoryPoint*)ps_malloc(capacity * sizeof(HistoryPoint));
+        usingPSRAM = buffers[0].points != nullptr && buffers[1].points != nullptr;
+    }
+
+    if (!usingPSRAM) {
+        free(buffers[0].points);
+        free(buffers[1].points);
+        capacity = HEAP_CAPACITY;
+        buffers[0].points = (HistoryPoint*)malloc(capacity * sizeof(HistoryPoint));
+        buffers[1].points = (HistoryPoint*)malloc(capacity * sizeof(HistoryPoint));
+    }
+
+    if (buffers[0].points == nullptr || buffers[1].points == nullptr) {
+        free(buffers[0].points);
+        free(buffers[1].points);
+        buffers[0].points = nullptr;
+        buffers[1].points = nullptr;
+        capacity = 0;
+        Serial.println("WeightHistory: allocation failed - history disabled");
+        return false;
+    }
+
+    Serial.printf("WeightHistory: %u points per shot in %s (%u bytes)\n",
+                  (unsigned)capacity, usingPSRAM ? "PSRAM" : "heap",
+                  (unsigned)(2 * capacity * sizeof(HistoryPoint)));
+    return true;
+}
+
+void WeightHistory::record(const TelemetrySample& sample) {
+    if (!isReady() || sample.sequence == lastSequence) {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    lastSequence = sample.sequence;
+
+    if (!current->started) {
+        current->startUs = sample.timestampUs;
+        current->started = true;
+    }
+
+    size_t index = (current->head + current->count) % capacity;
+    if (current->count == capacity) {
+        // Ring full - overwrite the oldest point
+        current->head = (current->head + 1) % capacity;
+    } else {
+        current->count++;
+    }
+
+    HistoryPoint& point = current->points[index];
+    point.sequence = sample.sequence;
+    // Signed difference so a sample captured just before the shot start maps to 0
+    int32_t sinceStart = (int32_t)(sample.timestampUs - current->startUs);
+    point.timeMs = sinceStart > 0 ? (uint32_t)sinceStart / 1000 : 0;
+    point.weight = sample.weight;
+    point.flowRate = sample.flowRate;
+    xSemaphoreGive(mutex);
+}
+
+void WeightHistory::beginShot(uint32_t startUs) {
+    if (!isReady()) {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    ShotBuffer* finished = current;
+    current = previous;
+    previous = finished;
+
+    current->head = 0;
+    current->count = 0;
+    current->shotId = nextShotId++;
+    current->startUs = startUs;
+    current->started = true;
+    lastSequence = 0; // Allow back-dated samples to be replayed into the new shot
+    xSemaphoreGive(mutex);
+
+    Serial.printf("WeightHistory: shot %u started\n", (unsigned)current->shotId);
+}
+
+size_t WeightHistory::query(bool previousShot, uint32_t since, size_t maxPoints,
+                            HistoryPoint* out, HistoryQueryInfo& info) {
+    info = HistoryQueryInfo();
+    info.latestSequence = since;
+    if (!isReady() || out == nullptr || maxPoints == 0) {
+        return 0;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const ShotBuffer& buffer = previousShot ? *previous : *current;
+    info.shotId = buffer.shotId;
+    info.buffered = buffer.count;
+
+    size_t first = firstAfter(buffer, since);
+    size_t available = buffer.count - first;
+    info.available = available;
+
+    if (available > 0) {
+        info.latestSequence = at(buffer, buffer.count - 1).sequence;
+        if (available <= maxPoints || maxPoints < 3) {
+            size_t n = available < maxPoints ? available : maxPoints;
+            // Too few output points for LTTB - keep the newest ones
+            size_t start = first + (available - n);
+            for (size_t i = 0; i < n; i++) {
+                out[i] = at(buffer, start + i);
+            }
+            info.returned = n;
+        } else {
+            info.returned = downsampleLTTB(buffer, first, available, out, maxPoints);
+            info.downsampled = true;
+        }
+    }
+    xSemaphoreGive(mutex);
+    return info.returned;
+}
+
+const HistoryPoint& WeightHistory::at(const ShotBuffer& buffer, size_t index) const {
+    return buffer.points[(buffer.head + index) % capacity];
+}
+
+size_t WeightHistory::firstAfter(const ShotBuffer& buffer, uint32_t since) const {
+    // Sequences increase along the ring, so binary search for the first newer point
+    size_t low = 0;
+    size_t high = buffer.count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (at(buffer, mid).sequence <= since) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t WeightHistory::downsampleLTTB(const ShotBuffer& buffer, size_t first, size_t count,
+                                     HistoryPoint* out, size_t maxPoints) const {
+    // Largest-triangle-three-buckets on (time, weight): always keep the first and
+    // last point, then pick the point of each bucket that forms the largest
+    // triangle with the previously chosen point and the next bucket's average.
+    size_t written = 0;
+    out[written++] = at(buffer, first);
+
+    float bucketSize = (float)(count - 2) / (float)(maxPoints - 2);
+    size_t selected = 0; // Relative index of the last chosen point
+
+    for (size_t bucket = 0; bucket < maxPoints - 2; bucket++) {
+        size_t bucketStart = (size_t)(bucket * bucketSize) + 1;
+        size_t bucketEnd = (size_t)((bucket + 1) * bucketSize) + 1;
+        if (bucketEnd > count - 1) bucketEnd = count - 1;
+
+        // Average of the next bucket (the last point for the final bucket)
+        size_t nextStart = bucketEnd;
+        size_t nextEnd = (size_t)((bucket + 2) * bucketSize) + 1;
+        if (nextEnd > count) nextEnd = count;
+        if (nextEnd <= nextStart) nextEnd = nextStart + 1;
+
+        float avgX = 0.0f;
+        float avgY = 0.0f;
+        for (size_t i = nextStart; i < nextEnd; i++) {
+            const HistoryPoint& p = at(buffer, first + i);
+            avgX += (float)p.timeMs;
+            avgY += p.weight;
+        }
+        avgX /= (float)(nextEnd - nextStart);
+        avgY /= (float)(nextEnd - nextStart);
+
+        const HistoryPoint& anchor = at(buffer, first + selected);
+        float anchorX = (float)anchor.timeMs;
+        float anchorY = anchor.weight;
+
+        float maxArea = -1.0f;
+        size_t best = bucketStart;
+        for (size_t i = bucketStart; i < bucketEnd; i++) {
+            const HistoryPoint& p = at(buffer, first + i);
+            float area = fabsf((anchorX - avgX) * (p.weight - anchorY) -
+                               (anchorX - (float)p.timeMs) * (avgY - anchorY));
+            if (area > maxArea) {
+                maxArea = area;
+                best = i;
+            }
+        }
+
+        out[written++] = at(buffer, first + best);
+        selected = best;
+    }
+
+    out[written++] = at(buffer, first + count - 1);
+    return written;
+}
@@ -3,6 +3,11 @@
 #include <Preferences.h>
 #include <ESPmDNS.h>
 #include "WebServer.h"  // For web server control
+#include "RetainedState.h"
+#include <time.h>
+#include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <lwip/dhcp.h>
 
 // ESP-IDF includes for advanced WiFi power management (SuperMini antenna fix)
 #ifdef ESP_IDF_VERSION_MAJOR
@@ -36,10 +41,8 @@ const char* ap_password = "";
 // WiFi Power Management State
 static bool wifiEnabled = true; // WiFi enabled by default
 static bool wifiEnabledCached = false;
-static wifi_mode_t previousWiFiMode = WIFI_OFF; // Store previous mode when disabling WiFi
 
-unsigned long startAttemptTime = 0;
-const unsigned long timeout = 10000; // 10 seconds
+static void forgetConnectCache(); // Cached association and static IP (defined below)
 
 void checkFilesystemStatus() {
     if (filesystemChecked) {
@@ -131,6 +134,7 @@ void clearWiFiCredentials() {
         // Clear cache
         cachedSSID = "";
         cachedPassword = "";
+        forgetConnectCache();
         credentialsCached = true;
         lastCacheTime = millis();
         
@@ -224,108 +228,283 @@ String getStoredPassword() {
     return cachedPassword;
 }
 
-void setupWiFi() {
-    // Check if WiFi should be enabled
-    if (!loadWiFiEnabledState()) {
-        Serial.println("WiFi is disabled - skipping WiFi setup for battery saving");
-        WiFi.mode(WIFI_OFF);
+// ---------------------------------------------------------------------------
+// Fast reconnect: cached association and optional static IP
+//
+// After every successful connect the AP's BSSID and channel and the DHCP lease
+// are stored in NVS. The next connect (boot, wake, reconnect) goes straight
+// to that AP on that channel, skipping the channel scan. After a deep-sleep
+// wake the lease is reused as well, skipping DHCP - but only until its renewal
+// time (T1); the client then switches back to DHCP on the live connection, so
+// the router never hands the address to another host while we still use it.
+// If the directed attempt fails, the cache is dropped and a normal scan + DHCP
+// connect follows.
+// ---------------------------------------------------------------------------
+
+const unsigned long DIRECTED_CONNECT_TIMEOUT_MS = 4000; // Then fall back to a full scan
+const uint32_t DEFAULT_LEASE_RENEW_S = 1800; // Half of a one-hour lease, when lwIP can't tell
+
+static WiFiAssociation cachedAssociation;
+static bool associationLoaded = false;
+static bool leaseTimeKnown = false;   // time() since the lease is trustworthy - this boot or a deep-sleep wake, not NVS
+static bool usingCachedLease = false; // Connected on the cached address - DHCP is not running
+
+static bool staticIPLoaded = false;
+static bool staticIPEnabled = false;
+static uint32_t staticIP = 0, staticGateway = 0, staticSubnet = 0, staticDNS = 0;
+
+static uint32_t lastConnectTimeMs = 0;
+static const char* lastConnectMethod = "none";
+
+static void loadAssociation() {
+    if (associationLoaded) {
         return;
     }
-    
-    char ssid[33] = {0};
-    char password[65] = {0};
-    loadWiFiCredentials(ssid, password, sizeof(ssid));
-    
-    // Ensure WiFi is completely reset first
-    Serial.println("=== WIFI ANTENNA OPTIMIZATION ===");
-    Serial.println("Resetting WiFi subsystem...");
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
-    delay(500); // Longer delay for complete reset
-    
-    // Apply SuperMini antenna fix for boards with poor antenna design
-    applySuperMiniAntennaFix();
-    
-    // Check if we have stored credentials - prioritize STA connection
-    if (strlen(ssid) > 0) {
-        Serial.println("=== ATTEMPTING STA CONNECTION ===");
-        Serial.println("Found stored credentials for: " + String(ssid));
-        Serial.println("Trying STA mode first (power optimized)...");
-        
-        // Try STA mode first for lower power consumption
-        WiFi.mode(WIFI_STA);
-        delay(1000); // Ensure mode switch is stable
-        
-        // ANTENNA FIX: Reapply power settings after mode switch for SuperMini boards
-        // Mode switch can reset power levels, so reapply the fix
-        if (ENABLE_SUPERMINI_ANTENNA_FIX) {
-            applySuperMiniAntennaFix();
-        }
-        
-        startAttemptTime = millis();
-        WiFi.begin(ssid, password);
-        
-        // Wait for connection with reasonable timeout
-        int connectionAttempts = 0;
-        const int maxAttempts = 24; // 12 seconds total - more time for reliable connection
-        
-        Serial.print("Connecting");
-        while (WiFi.status() != WL_CONNECTED && connectionAttempts < maxAttempts) {
-            delay(500);
-            Serial.print(".");
-            connectionAttempts++;
-            
-            // Check for immediate connection failures
-            if (WiFi.status() == WL_NO_SSID_AVAIL) {
-                Serial.println("\nNetwork '" + String(ssid) + "' not found");
-                break;
-            }
-            if (WiFi.status() == WL_CONNECT_FAILED) {
-                Serial.println("\nConnection failed - likely incorrect password");
-                break;
-            }
-        }
-        
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("\nSTA CONNECTION SUCCESSFUL!");
-            Serial.println("===========================");
-            Serial.println("Connected to: " + String(ssid));
-            Serial.println("IP Address: " + WiFi.localIP().toString());
-            Serial.println("Gateway: " + WiFi.gatewayIP().toString());
-            Serial.println("DNS: " + WiFi.dnsIP().toString());
-            Serial.println("Signal: " + String(WiFi.RSSI()) + " dBm");
-            Serial.println("AP mode disabled - optimized for low power");
-            Serial.println("Will auto-fallback to AP if connection lost");
-            Serial.println("===========================");
-            
-            // Setup mDNS for STA mode
-            setupmDNS();
-            
-            return; // Exit early - we're connected via STA, no need for AP
-        } else {
-            Serial.println("\nSTA CONNECTION FAILED");
-            Serial.println("Status code: " + String(WiFi.status()));
-            Serial.println("Falling back to AP mode for configuration...");
+    associationLoaded = true;
+    memset(&cachedAssociation, 0, sizeof(cachedAssociation));
+    // After a deep-sleep wake the association is already in RTC memory - no NVS read
+    if (RetainedState::wifiAssociation(cachedAssociation)) {
+        leaseTimeKnown = true;
+        return;
+    }
+    checkFilesystemStatus();
+    if (!filesystemAvailable) {
+        return;
+    }
+    if (wifiPrefs.begin("wifi", true)) {
+        if (wifiPrefs.getBytesLength("assoc") == sizeof(cachedAssociation)) {
+            wifiPrefs.getBytes("assoc", &cachedAssociation, sizeof(cachedAssociation));
         }
+        wifiPrefs.end();
+    }
+}
+
+static void storeAssociation(const WiFiAssociation& association) {
+    loadAssociation();
+    // Only write when something changed - this runs on every connect
+    if (memcmp(&association, &cachedAssociation, sizeof(association)) == 0) {
+        return;
+    }
+    cachedAssociation = association;
+    if (filesystemAvailable && wifiPrefs.begin("wifi", false)) {
+        wifiPrefs.putBytes("assoc", &cachedAssociation, sizeof(cachedAssociation));
+        wifiPrefs.end();
+    }
+}
+
+bool getWiFiAssociation(WiFiAssociation& association) {
+    loadAssociation();
+    association = cachedAssociation;
+    return cachedAssociation.valid;
+}
+
+void invalidateWiFiAssociation() {
+    loadAssociation();
+    if (!cachedAssociation.valid) {
+        return;
+    }
+    WiFiAssociation empty;
+    memset(&empty, 0, sizeof(empty));
+    storeAssociation(empty);
+}
+
+// Seconds left on the cached lease before its renewal time, 0 when it can't be reused
+static uint32_t cachedLeaseRemainingS() {
+    if (!leaseTimeKnown || cachedAssociation.ip == 0 || cachedAssociation.leaseRenewS == 0) {
+        return 0;
+    }
+    uint32_t now = (uint32_t)time(nullptr);
+    if (now < cachedAssociation.leaseObtainedS) {
+        return 0;
+    }
+    uint32_t age = now - cachedAssociation.leaseObtainedS;
+    return age < cachedAssociation.leaseRenewS ? cachedAssociation.leaseRenewS - age : 0;
+}
+
+static uint32_t currentLeaseRenewS() {
+    esp_netif_t* netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    struct netif* lwipNetif = netif != nullptr ? (struct netif*)esp_netif_get_netif_impl(netif) : nullptr;
+    struct dhcp* dhcp = lwipNetif != nullptr ? netif_dhcp_data(lwipNetif) : nullptr;
+    if (dhcp != nullptr && dhcp->offered_t1_renew > 0) {
+        return dhcp->offered_t1_renew;
+    }
+    return DEFAULT_LEASE_RENEW_S;
+}
+
+static void rememberAssociation() {
+    WiFiAssociation association;
+    memset(&association, 0, sizeof(association));
+    strncpy(association.ssid, WiFi.SSID().c_str(), sizeof(association.ssid) - 1);
+    uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    memcpy(association.bssid, bssid, sizeof(association.bssid));
+    association.channel = WiFi.channel();
+    association.ip = (uint32_t)WiFi.localIP();
+    association.gateway = (uint32_t)WiFi.gatewayIP();
+    association.subnet = (uint32_t)WiFi.subnetMask();
+    association.dns = (uint32_t)WiFi.dnsIP();
+    if (usingCachedLease) {
+        // Same address as before - the lease still dates from the last DHCP exchange
+        association.leaseObtainedS = cachedAssociation.leaseObtainedS;
+        association.leaseRenewS = cachedAssociation.leaseRenewS;
     } else {
-        Serial.println("=== NO STORED CREDENTIALS ===");
-        Serial.println("No WiFi credentials found - starting AP mode for initial setup");
+        association.leaseObtainedS = (uint32_t)time(nullptr);
+        association.leaseRenewS = currentLeaseRenewS();
     }
-    
-    // Fallback to AP mode if STA failed or no credentials exist
+    association.valid = association.channel > 0 && association.ip != 0;
+    storeAssociation(association);
+    leaseTimeKnown = true;
+}
+
+static void loadStaticIP() {
+    if (staticIPLoaded) {
+        return;
+    }
+    staticIPLoaded = true;
+    checkFilesystemStatus();
+    if (filesystemAvailable && wifiPrefs.begin("wifi", true)) {
+        staticIPEnabled = wifiPrefs.getBool("static_ip", false);
+        staticIP = wifiPrefs.getUInt("sip", 0);
+        staticGateway = wifiPrefs.getUInt("sgw", 0);
+        staticSubnet = wifiPrefs.getUInt("smask", 0);
+        staticDNS = wifiPrefs.getUInt("sdns", 0);
+        wifiPrefs.end();
+    }
+}
+
+bool getStaticIPConfig(IPAddress& ip, IPAddress& gateway, IPAddress& subnet, IPAddress& dns) {
+    loadStaticIP();
+    ip = IPAddress(staticIP);
+    gateway = IPAddress(staticGateway);
+    subnet = IPAddress(staticSubnet);
+    dns = IPAddress(staticDNS);
+    return staticIPEnabled;
+}
+
+void saveStaticIPConfig(bool enabled, IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns) {
+    checkFilesystemStatus();
+    staticIPLoaded = true;
+    staticIPEnabled = enabled;
+    staticIP = (uint32_t)ip;
+    staticGateway = (uint32_t)gateway;
+    staticSubnet = (uint32_t)subnet;
+    staticDNS = (uint32_t)dns;
+    if (filesystemAvailable && wifiPrefs.begin("wifi", false)) {
+        wifiPrefs.putBool("static_ip", staticIPEnabled);
+        wifiPrefs.putUInt("sip", staticIP);
+        wifiPrefs.putUInt("sgw", staticGateway);
+        wifiPrefs.putUInt("smask", staticSubnet);
+        wifiPrefs.putUInt("sdns", staticDNS);
+        wifiPrefs.end();
+    } else {
+        showFilesystemErrorIfNeeded();
+    }
+    Serial.printf("Static IP %s: %s\n", enabled ? "enabled" : "disabled", ip.toString().c_str());
+}
+
+static void forgetConnectCache() {
+    // The NVS namespace was cleared - reload (as empty) on next use
+    associationLoaded = false;
+    staticIPLoaded = false;
+    staticIPEnabled = false;
+}
+
+uint32_t getLastConnectTimeMs() {
+    return lastConnectTimeMs;
+}
+
+const char* getLastConnectMethod() {
+    return lastConnectMethod;
+}
+
+// ---------------------------------------------------------------------------
+// Connection state machine
+//
+// Nothing in here waits. WiFi.onEvent() callbacks (Arduino event task) only
+// record what happened; maintainWiFi(), called from the housekeeping task,
+// moves the state machine on and uses deadlines instead of delay(). Other
+// tasks (web handlers, touch) never touch the radio - they post a request that
+// the next maintainWiFi() executes, so the scale and BLE keep running at full
+// rate while WiFi connects or falls back to AP mode in the background.
+// ---------------------------------------------------------------------------
+
+enum class WiFiRequest : uint8_t { NONE, CONNECT_STA, START_AP, ENABLE, DISABLE };
+
+const unsigned long STA_CONNECT_TIMEOUT_MS = 12000;   // First connect (boot or new credentials)
+const unsigned long STA_RECONNECT_TIMEOUT_MS = 3000;  // Lost connection - fast fallback to AP
+const unsigned long REQUEST_DEFER_MS = 500;           // Let the HTTP response that asked for it go out
+const unsigned long MAINTENANCE_LOG_INTERVAL_MS = 15000;
+
+static WiFiState wifiState = WiFiState::OFF;
+static unsigned long stateDeadline = 0;    // millis() by which the current attempt must succeed
+static unsigned long stateEnteredAt = 0;
+static unsigned long connectStartedAt = 0; // First attempt of this connect (kept across the scan fallback)
+static bool connectDirected = false;       // Current attempt uses the cached BSSID/channel
+static unsigned long fallbackTimeoutMs = 0; // Timeout for the full scan if the directed attempt fails
+
+static volatile WiFiRequest pendingRequest = WiFiRequest::NONE;
+static volatile unsigned long requestNotBefore = 0;
+
+// Written by the WiFi event callback, consumed by maintainWiFi()
+static volatile bool staGotIP = false;
+static volatile bool staDisconnected = false;
+static volatile uint8_t staDisconnectReason = 0;
+static bool wifiEventsRegistered = false;
+
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            staGotIP = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            staDisconnectReason = info.wifi_sta_disconnected.reason;
+            staDisconnected = true;
+            break;
+        default:
+            break;
+    }
+}
+
+static void registerWiFiEvents() {
+    if (wifiEventsRegistered) {
+        return;
+    }
+    WiFi.onEvent(onWiFiEvent);
+    // The state machine owns retries and the AP fallback
+    WiFi.setAutoReconnect(false);
+    wifiEventsRegistered = true;
+}
+
+static void enterState(WiFiState state, unsigned long timeoutMs = 0) {
+    wifiState = state;
+    stateEnteredAt = millis();
+    stateDeadline = timeoutMs > 0 ? stateEnteredAt + timeoutMs : 0;
+}
+
+static bool deadlinePassed() {
+    return stateDeadline != 0 && (long)(millis() - stateDeadline) >= 0;
+}
+
+static void postRequest(WiFiRequest request, unsigned long deferMs) {
+    requestNotBefore = millis() + deferMs;
+    pendingRequest = request;
+}
+
+// Bring up the configuration AP - tries channel 6, then 1, then defaults
+static bool startAccessPoint() {
     Serial.println("Starting AP mode...");
+    staGotIP = false;
+    staDisconnected = false;
+    WiFi.disconnect(true);
     WiFi.mode(WIFI_AP);
-    delay(1000); // Ensure mode switch is stable
     
     // Configure AP with optimized settings for maximum visibility
     WiFi.softAPConfig(IPAddress(192, 168, 4, 1), IPAddress(192, 168, 4, 1), IPAddress(255, 255, 255, 0));
     
-    // Start AP with maximum power and visibility settings
-    bool apStarted = false;
-    Serial.println("Starting AP for credential configuration...");
-    
     // Try channel 6 first (most common and widely supported)
-    apStarted = WiFi.softAP(ap_ssid, ap_password, 6, false, 4); // Channel 6, broadcast SSID, max 4 clients
+    bool apStarted = WiFi.softAP(ap_ssid, ap_password, 6, false, 4); // Channel 6, broadcast SSID, max 4 clients
     
     if (apStarted) {
         Serial.println("AP started successfully on channel 6");
@@ -360,6 +539,183 @@ void setupWiFi() {
     } else {
         Serial.println("ERROR: AP failed to start - hardware or RF issue suspected");
     }
+    enterState(WiFiState::AP_ACTIVE);
+    return apStarted;
+}
+
+// Start associating with the stored network; the outcome arrives as an event.
+// With useCache the cached AP is tried first (directed, no scan, no DHCP)
+static bool startStation(unsigned long timeoutMs, bool useCache) {
+    char ssid[33] = {0};
+    char password[65] = {0};
+    loadWiFiCredentials(ssid, password, sizeof(ssid));
+    if (strlen(ssid) == 0) {
+        Serial.println("No stored credentials - starting AP mode for initial setup");
+        return false;
+    }
+    
+    loadAssociation();
+    bool directed = useCache && cachedAssociation.valid && strcmp(cachedAssociation.ssid, ssid) == 0;
+    
+    Serial.println("=== ATTEMPTING STA CONNECTION ===");
+    Serial.printf("Connecting to: %s (%s)\n", ssid, directed ? "cached AP" : "full scan");
+    staGotIP = false;
+    staDisconnected = false;
+    if (WiFi.getMode() != WIFI_STA) {
+        WiFi.mode(WIFI_STA);
+        // ANTENNA FIX: Mode switch can reset power levels, so reapply the fix
+        if (ENABLE_SUPERMINI_ANTENNA_FIX) {
+            applySuperMiniAntennaFix();
+        }
+    }
+    
+    // Address: static config if set, else a still-valid cached lease on a directed attempt, else DHCP
+    IPAddress ip, gateway, subnet, dns;
+    usingCachedLease = false;
+    if (getStaticIPConfig(ip, gateway, subnet, dns)) {
+        WiFi.config(ip, gateway, subnet, dns);
+    } else if (directed && cachedLeaseRemainingS() > 0) {
+        usingCachedLease = true;
+        Serial.printf("Reusing cached lease for %lu more seconds\n", (unsigned long)cachedLeaseRemainingS());
+        WiFi.config(IPAddress(cachedAssociation.ip), IPAddress(cachedAssociation.gateway),
+                    IPAddress(cachedAssociation.subnet), IPAddress(cachedAssociation.dns));
+    } else {
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    }
+    
+    if (directed) {
+        WiFi.begin(ssid, password, cachedAssociation.channel, cachedAssociation.bssid);
+    } else {
+        WiFi.begin(ssid, password);
+    }
+    
+    WiFiState state = timeoutMs == STA_RECONNECT_TIMEOUT_MS ? WiFiState::STA_RECONNECTING : WiFiState::STA_CONNECTING;
+    // A scan fallback continues the same connect - keep the start time for the metric
+    if (useCache || wifiState != state) {
+        connectStartedAt = millis();
+    }
+    connectDirected = directed;
+    fallbackTimeoutMs = timeoutMs;
+    enterState(state, directed ? min(timeoutMs, DIRECTED_CONNECT_TIMEOUT_MS) : timeoutMs);
+    return true;
+}
+
+static void onStationConnected() {
+    Serial.println("STA CONNECTION SUCCESSFUL!");
+    Serial.println("===========================");
+    Serial.println("Connected to: " + WiFi.SSID());
+    Serial.println("IP Address: " + WiFi.localIP().toString());
+    Serial.println("Gateway: " + WiFi.gatewayIP().toString());
+    Serial.println("DNS: " + WiFi.dnsIP().toString());
+    Serial.println("Signal: " + String(WiFi.RSSI()) + " dBm");
+    lastConnectTimeMs = millis() - connectStartedAt;
+    IPAddress staticAddress, unusedGateway, unusedSubnet, unusedDNS;
+    bool usingStatic = getStaticIPConfig(staticAddress, unusedGateway, unusedSubnet, unusedDNS);
+    lastConnectMethod = connectDirected ? (usingStatic ? "cached+static" : "cached") : (usingStatic ? "scan+static" : "scan");
+    Serial.printf("Connected in %lu ms (%s)\n", (unsigned long)lastConnectTimeMs, lastConnectMethod);
+    Serial.println("AP mode disabled - optimized for low power");
+    Serial.println("Will auto-fallback to AP if connection lost");
+    Serial.println("===========================");
+    enterState(WiFiState::STA_CONNECTED);
+    rememberAssociation();
+    
+    // Setup mDNS for STA mode
+    setupmDNS();
+}
+
+static bool isFatalDisconnect(uint8_t reason) {
+    // Wrong password or missing network - waiting for the deadline won't help
+    return reason == WIFI_REASON_NO_AP_FOUND || reason == WIFI_REASON_AUTH_FAIL ||
+           reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_HANDSHAKE_TIMEOUT;
+}
+
+static void turnWiFiOff() {
+    // Stop web server first to prevent TCP/IP stack issues
+    stopWebServer();
+    
+    wifi_mode_t mode = WiFi.getMode();
+    if (mode == WIFI_STA || mode == WIFI_AP_STA) {
+        Serial.println("Disconnecting from STA...");
+        WiFi.disconnect(true);
+    }
+    if (mode == WIFI_AP || mode == WIFI_AP_STA) {
+        Serial.println("Stopping AP mode...");
+        WiFi.softAPdisconnect(true);
+    }
+    WiFi.mode(WIFI_OFF);
+    enterState(WiFiState::OFF);
+    Serial.println("WiFi disabled - battery saving mode active");
+}
+
+static void executeRequest(WiFiRequest request) {
+    switch (request) {
+        case WiFiRequest::CONNECT_STA:
+            if (!startStation(STA_CONNECT_TIMEOUT_MS, true)) {
+                startAccessPoint();
+            }
+            break;
+        case WiFiRequest::START_AP:
+            startAccessPoint();
+            break;
+        case WiFiRequest::ENABLE:
+            if (wifiState == WiFiState::OFF) {
+                // Try to restore to STA mode first if we have credentials
+                if (!startStation(STA_CONNECT_TIMEOUT_MS, true)) {
+                    startAccessPoint();
+                }
+                startWebServer(); // Start web server when WiFi is enabled
+            }
+            Serial.println("WiFi enabled");
+            break;
+        case WiFiRequest::DISABLE:
+            if (wifiState != WiFiState::OFF) {
+                turnWiFiOff();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+WiFiState getWiFiState() {
+    return wifiState;
+}
+
+const char* getWiFiStateName() {
+    switch (wifiState) {
+        case WiFiState::OFF: return "off";
+        case WiFiState::STA_CONNECTING: return "connecting";
+        case WiFiState::STA_CONNECTED: return "connected";
+        case WiFiState::STA_RECONNECTING: return "reconnecting";
+        case WiFiState::AP_ACTIVE: return "ap";
+        default: return "unknown";
+    }
+}
+
+void setupWiFi() {
+    // Check if WiFi should be enabled
+    if (!loadWiFiEnabledState()) {
+        Serial.println("WiFi is disabled - skipping WiFi setup for battery saving");
+        WiFi.mode(WIFI_OFF);
+        enterState(WiFiState::OFF);
+        return;
+    }
+    
+    registerWiFiEvents();
+    
+    // Ensure WiFi is completely reset first
+    Serial.println("=== WIFI ANTENNA OPTIMIZATION ===");
+    Serial.println("Resetting WiFi subsystem...");
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    
+    // Apply SuperMini antenna fix for boards with poor antenna design
+    applySuperMiniAntennaFix();
+    
+    // Stored credentials: connect in the background, maintainWiFi() falls back to AP on failure
+    if (!startStation(STA_CONNECT_TIMEOUT_MS, true)) {
+        startAccessPoint();
+    }
 }
 
 void setupmDNS() {
@@ -396,178 +752,321 @@ void printWiFiStatus() {
     Serial.println("==================");
 }
 
+// Modem sleep policy. The performance profile sets the base level; latency
+// demand (streaming or polling clients, a running shot) lifts it to no-sleep,
+// because modem sleep holds every incoming frame until the next DTIM beacon -
+// 100-300ms added to each HTTP response. The boost is released once the
+// demand has been gone for LATENCY_RELEASE_MS.
+//
+// A /ws client is both what raises the demand and what measures the round
+// trip, so the base level would never get samples. Every RTT_PROBE_PERIOD_MS
+// the client demand is set aside for RTT_PROBE_WINDOW_MS (never during a
+// shot) and the pings in that window run at the profile's own level.
+const unsigned long LATENCY_RELEASE_MS = 10000;
+const unsigned long RTT_PROBE_PERIOD_MS = 60000;
+const unsigned long RTT_PROBE_WINDOW_MS = 5000;
+
+static volatile wifi_ps_type_t requestedPowerSave = WIFI_PS_MAX_MODEM;
+static volatile bool latencyBoostAllowed = true;
+static volatile bool latencyDemand = false;
+static volatile bool shotDemand = false;
+static volatile bool powerSavePending = true;
+static bool latencyBoosted = false;
+static unsigned long lastDemandMs = 0;
+static uint32_t latencyBoostCount = 0;
+static bool rttProbing = false;
+static unsigned long rttProbeStartMs = 0;
+static unsigned long lastRttProbeMs = 0;
+static uint32_t rttProbeCount = 0;
+static wifi_ps_type_t appliedPowerSave = WIFI_PS_MIN_MODEM;
+
+// Round trips per level in effect (index = wifi_ps_type_t)
+static const uint32_t RTT_BOUNDS_MS[] = {10, 25, 50, 100, 200, 400};
+static const size_t RTT_BUCKETS = sizeof(RTT_BOUNDS_MS) / sizeof(RTT_BOUNDS_MS[0]) + 1;
+struct PowerSaveStats {
+    unsigned long totalMs;
+    uint32_t rttCount;
+    uint64_t rttTotalMs;
+    uint32_t rttMaxMs;
+    uint32_t rttBuckets[RTT_BUCKETS];
+};
+static PowerSaveStats powerSaveStats[3];
+static unsigned long levelSinceMs = 0;
+
+static const char* powerSaveName(wifi_ps_type_t type) {
+    switch (type) {
+        case WIFI_PS_NONE: return "none";
+        case WIFI_PS_MIN_MODEM: return "min_modem";
+        case WIFI_PS_MAX_MODEM: return "max_modem";
+        default: return "unknown";
+    }
+}
+
+void setWiFiPowerSave(wifi_ps_type_t type, bool latencyBoost) {
+    requestedPowerSave = type;
+    latencyBoostAllowed = latencyBoost;
+    powerSavePending = true;
+}
+
+void setWiFiLatencyDemand(bool clients, bool shot) {
+    latencyDemand = clients;
+    shotDemand = shot;
+}
+
+wifi_ps_type_t getWiFiPowerSave() {
+    return appliedPowerSave;
+}
+
+static void updateLatencyBoost() {
+    unsigned long now = millis();
+
+    // Base-level probe window - ends early when a shot starts or the clients leave
+    if (rttProbing) {
+        if (shotDemand || !latencyDemand || now - rttProbeStartMs >= RTT_PROBE_WINDOW_MS) {
+            rttProbing = false;
+            lastRttProbeMs = now;
+        }
+    } else if (latencyBoosted && latencyDemand && !shotDemand && now - lastRttProbeMs >= RTT_PROBE_PERIOD_MS) {
+        rttProbing = true;
+        rttProbeStartMs = now;
+        rttProbeCount++;
+    }
+    if (rttProbing) {
+        if (latencyBoosted) {
+            latencyBoosted = false;
+            powerSavePending = true;
+        }
+        return;
+    }
+
+    if ((latencyDemand || shotDemand) && latencyBoostAllowed) {
+        lastDemandMs = now;
+        if (!latencyBoosted) {
+            latencyBoosted = true;
+            latencyBoostCount++;
+            powerSavePending = true;
+        }
+    } else if (latencyBoosted && (!latencyBoostAllowed || now - lastDemandMs >= LATENCY_RELEASE_MS)) {
+        latencyBoosted = false;
+        powerSavePending = true;
+    }
+}
+
+static void applyPowerSave() {
+    powerSavePending = false;
+    wifi_ps_type_t type = latencyBoosted ? WIFI_PS_NONE : (wifi_ps_type_t)requestedPowerSave;
+    WiFi.setSleep(type);
+    wifi_ps_type_t actual;
+    if (type == WIFI_PS_NONE && esp_wifi_get_ps(&actual) == ESP_OK && actual != WIFI_PS_NONE) {
+        // WiFi/BLE coexistence requires modem sleep - the closest is waking every DTIM
+        type = WIFI_PS_MIN_MODEM;
+        WiFi.setSleep(type);
+    }
+    if (type != appliedPowerSave) {
+        unsigned long now = millis();
+        powerSaveStats[appliedPowerSave].totalMs += now - levelSinceMs;
+        levelSinceMs = now;
+        Serial.printf("WiFi: modem sleep %s -> %s%s\n", powerSaveName(appliedPowerSave), powerSaveName(type),
+                      latencyBoosted ? " (clients active)" : "");
+        appliedPowerSave = type;
+    }
+}
+
+void recordWiFiRoundTrip(uint32_t rttMs, wifi_ps_type_t sentLevel) {
+    if (sentLevel != appliedPowerSave) {
+        return; // Straddled a level change - belongs to neither
+    }
+    PowerSaveStats& stats = powerSaveStats[appliedPowerSave];
+    size_t bucket = 0;
+    while (bucket < RTT_BUCKETS - 1 && rttMs >= RTT_BOUNDS_MS[bucket]) {
+        bucket++;
+    }
+    stats.rttBuckets[bucket]++;
+    stats.rttCount++;
+    stats.rttTotalMs += rttMs;
+    if (rttMs > stats.rttMaxMs) {
+        stats.rttMaxMs = rttMs;
+    }
+}
+
+void resetWiFiRoundTrips() {
+    for (int i = 0; i < 3; i++) {
+        PowerSaveStats& stats = powerSaveStats[i];
+        stats.rttCount = 0;
+        stats.rttTotalMs = 0;
+        stats.rttMaxMs = 0;
+        memset(stats.rttBuckets, 0, sizeof(stats.rttBuckets));
+    }
+}
+
+// Upper bound of the bucket holding the given fraction of round trips
+static uint32_t rttPercentileMs(const PowerSaveStats& stats, float fraction) {
+    if (stats.rttCount == 0) {
+        return 0;
+    }
+    uint32_t target = (uint32_t)(stats.rttCount * fraction);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < RTT_BUCKETS - 1; i++) {
+        seen += stats.rttBuckets[i];
+        if (seen > target) {
+            return RTT_BOUNDS_MS[i];
+        }
+    }
+    return stats.rttMaxMs;
+}
+
+String getWiFiPowerSaveJson() {
+    unsigned long now = millis();
+    String json = "{\"level\":\"" + String(powerSaveName(appliedPowerSave)) + "\"";
+    json += ",\"base\":\"" + String(powerSaveName(requestedPowerSave)) + "\"";
+    json += ",\"boost_allowed\":" + String(latencyBoostAllowed ? "true" : "false");
+    json += ",\"demand\":" + String(latencyDemand ? "true" : "false");
+    json += ",\"boosted\":" + String(latencyBoosted ? "true" : "false");
+    json += ",\"boosts\":" + String(latencyBoostCount);
+    json += ",\"probing\":" + String(rttProbing ? "true" : "false");
+    json += ",\"probes\":" + String(rttProbeCount);
+    json += ",\"levels\":[";
+    for (int i = 0; i < 3; i++) {
+        const PowerSaveStats& stats = powerSaveStats[i];
+        unsigned long totalMs = stats.totalMs + (i == appliedPowerSave ? now - levelSinceMs : 0);
+        if (i > 0) json += ",";
+        json += "{\"level\":\"" + String(powerSaveName((wifi_ps_type_t)i)) + "\"";
+        json += ",\"time_ms\":" + String(totalMs);
+        json += ",\"rtt\":{\"count\":" + String(stats.rttCount);
+        json += ",\"avg_ms\":" + String(stats.rttCount ? (uint32_t)(stats.rttTotalMs / stats.rttCount) : 0);
+        json += ",\"p50_ms\":" + String(rttPercentileMs(stats, 0.5f));
+        json += ",\"p95_ms\":" + String(rttPercentileMs(stats, 0.95f));
+        json += ",\"max_ms\":" + String(stats.rttMaxMs) + "}}";
+    }
+    json += "]}";
+    return json;
+}
+
 void maintainWiFi() {
+    static unsigned long lastMaintenanceLog = 0;
+    
+    updateLatencyBoost();
+    if (powerSavePending) {
+        applyPowerSave();
+    }
+    
+    // Requests from other tasks run here, on the housekeeping task
+    WiFiRequest request = pendingRequest;
+    if (request != WiFiRequest::NONE && (long)(millis() - requestNotBefore) >= 0) {
+        pendingRequest = WiFiRequest::NONE;
+        executeRequest(request);
+    }
+    
     // Skip maintenance if WiFi is disabled
-    if (!isWiFiEnabled()) {
+    if (wifiState == WiFiState::OFF || !isWiFiEnabled()) {
         return;
     }
     
-    static unsigned long lastMaintenance = 0;
-    const unsigned long maintenanceInterval = 15000; // Every 15 seconds for more responsive switching
-    
-    if (millis() - lastMaintenance >= maintenanceInterval) {
-        lastMaintenance = millis();
-        
-        // Check current WiFi mode and connection health
-        wifi_mode_t currentMode = WiFi.getMode();
-        
-        if (currentMode == WIFI_STA) {
-            // We're in STA mode - check if connection is still healthy
-            if (WiFi.status() != WL_CONNECTED) {
-                Serial.println("WARNING: STA connection lost! Attempting immediate reconnection...");
-                
-                // Try to reconnect to saved credentials
-                char ssid[33] = {0};
-                char password[65] = {0};
-                loadWiFiCredentials(ssid, password, sizeof(ssid));
-                
-                if (strlen(ssid) > 0) {
-                    Serial.println("Attempting to reconnect to: " + String(ssid));
-                    WiFi.begin(ssid, password);
-                    
-                    // Wait briefly for reconnection - reduced timeout for faster fallback
-                    int attempts = 0;
-                    while (WiFi.status() != WL_CONNECTED && attempts < 6) { // 3 second timeout
-                        delay(500);
-                        Serial.print(".");
-                        attempts++;
-                    }
-                    
-                    if (WiFi.status() == WL_CONNECTED) {
-                        Serial.println("\nSTA reconnection successful");
-                        Serial.println("IP: " + WiFi.localIP().toString());
-                    } else {
-                        Serial.println("\nSTA reconnection failed - switching to AP mode immediately");
-                        switchToAPMode();
-                    }
-                } else {
-                    Serial.println("No stored credentials - switching to AP mode");
-                    switchToAPMode();
+    switch (wifiState) {
+        case WiFiState::STA_CONNECTING:
+        case WiFiState::STA_RECONNECTING:
+            if (staGotIP) {
+                staGotIP = false;
+                staDisconnected = false;
+                onStationConnected();
+            } else if (connectDirected && (staDisconnected || deadlinePassed())) {
+                // AP moved channel, was replaced or the lease is gone - forget it and scan
+                staDisconnected = false;
+                Serial.printf("Cached AP failed (reason %u) - falling back to a full scan\n", staDisconnectReason);
+                invalidateWiFiAssociation();
+                WiFi.disconnect();
+                startStation(fallbackTimeoutMs, false);
+            } else if (staDisconnected && isFatalDisconnect(staDisconnectReason)) {
+                staDisconnected = false;
+                Serial.printf("STA CONNECTION FAILED (reason %u) - %s\n", staDisconnectReason,
+                              staDisconnectReason == WIFI_REASON_NO_AP_FOUND ? "network not found"
+                                                                            : "likely incorrect password");
+                Serial.println("Falling back to AP mode for configuration...");
+                startAccessPoint();
+            } else if (deadlinePassed()) {
+                Serial.println("STA connection timed out - switching to AP mode");
+                Serial.println("Status code: " + String(WiFi.status()));
+                startAccessPoint();
+            }
+            break;
+            
+        case WiFiState::STA_CONNECTED:
+            if (usingCachedLease && !staDisconnected && cachedLeaseRemainingS() == 0) {
+                // Cached lease reached its renewal time - hand the address back to DHCP
+                Serial.println("Cached lease expired - switching to DHCP");
+                usingCachedLease = false;
+                WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+            }
+            if (staGotIP) {
+                // DHCP (re)bound on the live connection - store the fresh lease
+                staGotIP = false;
+                rememberAssociation();
+            }
+            if (staDisconnected) {
+                staDisconnected = false;
+                Serial.printf("WARNING: STA connection lost (reason %u)! Attempting immediate reconnection...\n",
+                              staDisconnectReason);
+                if (!startStation(STA_RECONNECT_TIMEOUT_MS, true)) {
+                    startAccessPoint();
                 }
-            } else {
-                Serial.println("STA mode healthy - connection maintained");
-                Serial.println("Connected to: " + WiFi.SSID() + " | IP: " + WiFi.localIP().toString() + " | RSSI: " + String(WiFi.RSSI()) + "dBm");
             }
-        } else if (currentMode == WIFI_AP) {
-            // We're in AP mode - just ensure it's still running properly
+            break;
+            
+        case WiFiState::AP_ACTIVE:
+            // A late event from the abandoned STA attempt is meaningless here
+            staGotIP = false;
+            staDisconnected = false;
+            break;
+            
+        default:
+            break;
+    }
+    
+    if (millis() - lastMaintenanceLog >= MAINTENANCE_LOG_INTERVAL_MS) {
+        lastMaintenanceLog = millis();
+        
+        if (wifiState == WiFiState::STA_CONNECTED) {
+            Serial.println("STA mode healthy - connected to: " + WiFi.SSID() + " | IP: " + WiFi.localIP().toString() + " | RSSI: " + String(WiFi.RSSI()) + "dBm");
+        } else if (wifiState == WiFiState::AP_ACTIVE) {
             if (WiFi.softAPgetStationNum() == 0) {
                 Serial.println("AP mode active - 'WeighMyBru-AP' ready for configuration");
             } else {
                 Serial.println("AP mode active - " + String(WiFi.softAPgetStationNum()) + " clients connected");
             }
-        } else if (currentMode == WIFI_OFF) {
-            Serial.println("CRITICAL: WiFi is OFF! This should not happen - restarting AP mode");
-            switchToAPMode();
         }
         
-        // Ensure WiFi sleep stays enabled for BLE coexistence
-        if (!WiFi.getSleep()) {
-            Serial.println("WARNING: WiFi sleep was disabled! Re-enabling for BLE coexistence...");
-            WiFi.setSleep(true);
+        if (WiFi.getMode() == WIFI_OFF) {
+            Serial.println("CRITICAL: WiFi is OFF! This should not happen - restarting AP mode");
+            startAccessPoint();
         }
         
-        // Print status for debugging
-        Serial.println("WiFi maintenance check completed");
+        // Ensure WiFi sleep stays at the policy's level (mode changes can reset it)
+        if (WiFi.getSleep() != appliedPowerSave) {
+            Serial.println("WARNING: WiFi sleep level changed - restoring the profile's level...");
+            applyPowerSave();
+        }
     }
 }
 
-// Function to attempt STA connection with new credentials and switch from AP mode
+// Request an STA connection with the (already saved) credentials. Returns at once;
+// the connection is made by maintainWiFi(), which falls back to AP mode on failure
 bool attemptSTAConnection(const char* ssid, const char* password) {
-    Serial.println("=== ATTEMPTING STA CONNECTION ===");
-    Serial.println("SSID: " + String(ssid));
-    Serial.println("Switching from AP mode to STA mode...");
-    
-    // Disconnect from AP mode but keep WiFi on
-    WiFi.mode(WIFI_STA);
-    delay(1000); // Allow mode switch to stabilize
-    
-    // ANTENNA FIX: Reapply power settings after mode switch for SuperMini boards
-    if (ENABLE_SUPERMINI_ANTENNA_FIX) {
-        Serial.println("Reapplying SuperMini antenna fix after mode switch...");
-        applySuperMiniAntennaFix();
-    }
-    
-    // Attempt connection with new credentials
-    startAttemptTime = millis();
-    WiFi.begin(ssid, password);
-    
-    // Wait for connection with reasonable timeout
-    int connectionAttempts = 0;
-    const int maxAttempts = 30; // 15 seconds total - more generous for initial connection
-    
-    Serial.print("Connecting");
-    while (WiFi.status() != WL_CONNECTED && connectionAttempts < maxAttempts) {
-        delay(500);
-        Serial.print(".");
-        connectionAttempts++;
-        
-        // Check for immediate connection failures
-        if (WiFi.status() == WL_NO_SSID_AVAIL) {
-            Serial.println("\nSSID not found");
-            return false;
-        }
-        if (WiFi.status() == WL_CONNECT_FAILED) {
-            Serial.println("\nConnection failed - likely wrong password");
-            return false;
-        }
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\nSTA CONNECTION SUCCESSFUL!");
-        Serial.println("Connected to: " + String(ssid));
-        Serial.println("IP Address: " + WiFi.localIP().toString());
-        Serial.println("Gateway: " + WiFi.gatewayIP().toString());
-        Serial.println("RSSI: " + String(WiFi.RSSI()) + " dBm");
-        Serial.println("AP mode disabled - power consumption optimized");
-        
-        // Setup mDNS for the new STA connection
-        setupmDNS();
-        
-        return true;
-    } else {
-        Serial.println("\nSTA connection failed or timed out");
-        Serial.println("Status code: " + String(WiFi.status()));
+    if (!isWiFiEnabled()) {
         return false;
     }
+    Serial.println("STA connection requested for: " + String(ssid));
+    // Cache the credentials in case the caller did not save them
+    if (getStoredSSID() != ssid || getStoredPassword() != password) {
+        saveWiFiCredentials(ssid, password);
+    }
+    postRequest(WiFiRequest::CONNECT_STA, REQUEST_DEFER_MS);
+    return true;
 }
 
-// Function to switch back to AP mode if STA connection fails
+// Request a switch back to AP mode (executed by maintainWiFi())
 void switchToAPMode() {
-    Serial.println("=== SWITCHING TO AP MODE ===");
-    Serial.println("Disconnecting from STA mode...");
-    WiFi.disconnect(true);
-    delay(500);
-    
-    Serial.println("Setting AP mode...");
-    WiFi.mode(WIFI_AP);
-    delay(1000); // Allow mode switch to stabilize
-    
-    // Restart AP with same settings as setupWiFi()
-    Serial.println("Starting AP broadcast...");
-    bool apStarted = WiFi.softAP(ap_ssid, ap_password, 6, false, 4);
-    
-    if (apStarted) {
-        Serial.println("AP MODE RESTORED");
-        Serial.println("==================");
-        Serial.println("SSID: " + String(ap_ssid));
-        Serial.println("IP: " + WiFi.softAPIP().toString());
-        Serial.println("Config URL: http://192.168.4.1");
-        Serial.println("mDNS: http://weighmybru.local");
-        Serial.println("==================");
-        
-        // Setup mDNS for AP mode
-        setupmDNS();
-    } else {
-        Serial.println("CRITICAL: Failed to restart AP mode!");
-        Serial.println("Retrying with minimal settings...");
-        // Try with minimal settings as fallback
-        if (WiFi.softAP(ap_ssid)) {
-            Serial.println("AP started with minimal settings");
-            setupmDNS();
-        } else {
-            Serial.println("FATAL: Cannot start AP mode - WiFi hardware issue?");
-        }
-    }
+    Serial.println("AP mode requested");
+    postRequest(WiFiRequest::START_AP, 0);
 }
 
 // Apply SuperMini antenna fix for boards with poor antenna design
@@ -730,68 +1229,24 @@ void enableWiFi() {
     
     // Save the enabled state
     saveWiFiEnabledState(true);
+    registerWiFiEvents();
     
-    // If WiFi was previously off, restore it
-    if (WiFi.getMode() == WIFI_OFF) {
-        // Try to restore to STA mode first if we have credentials
-        if (loadWiFiCredentialsFromEEPROM() && !cachedSSID.isEmpty()) {
-            Serial.println("Attempting to reconnect to saved network...");
-            if (attemptSTAConnection(cachedSSID.c_str(), cachedPassword.c_str())) {
-                Serial.println("WiFi reconnected to STA mode");
-                startWebServer(); // Start web server when WiFi is enabled
-                return;
-            }
-        }
-        
-        // Fall back to AP mode if STA connection fails
-        Serial.println("Starting WiFi in AP mode...");
-        switchToAPMode();
-        startWebServer(); // Start web server when WiFi is enabled
-    }
-    
-    Serial.println("WiFi enabled");
+    // Radio work happens in maintainWiFi() - STA first, AP if that fails
+    postRequest(WiFiRequest::ENABLE, 0);
 }
 
 void disableWiFi() {
     Serial.println("Disabling WiFi to save battery...");
     
-    // Stop web server first to prevent TCP/IP stack issues
-    stopWebServer();
-    
-    // Save current mode before disabling
-    previousWiFiMode = WiFi.getMode();
-    
     // Save the disabled state
     saveWiFiEnabledState(false);
     
-    // Gracefully close active connections before disabling WiFi
-    Serial.println("Closing active connections...");
-    
-    // Give time for current HTTP responses to complete
-    delay(100);
-    
-    // Properly disconnect based on current mode
-    if (previousWiFiMode == WIFI_STA || previousWiFiMode == WIFI_AP_STA) {
-        Serial.println("Disconnecting from STA...");
-        WiFi.disconnect(true);
-    }
-    
-    if (previousWiFiMode == WIFI_AP || previousWiFiMode == WIFI_AP_STA) {
-        Serial.println("Stopping AP mode...");
-        WiFi.softAPdisconnect(true);
-    }
-    
-    // Additional delay to ensure cleanup
-    delay(200);
-    
-    // Now safely turn off WiFi
-    WiFi.mode(WIFI_OFF);
-    
-    Serial.println("WiFi disabled - battery saving mode active");
+    // Deferred so an HTTP response announcing it still goes out
+    postRequest(WiFiRequest::DISABLE, REQUEST_DEFER_MS);
 }
 
 void toggleWiFi() {
-    if (isWiFiEnabled() && WiFi.getMode() != WIFI_OFF) {
+    if (isWiFiEnabled() && wifiState != WiFiState::OFF) {
         disableWiFi();
     } else {
         enableWiFi();
@@ -14,6 +14,24 @@
 #include "PowerManager.h"
 #include "BatteryMonitor.h"
 #include "BoardConfig.h"
+#include "WeightHistory.h"
+#include "ShotLog.h"
+#include "ShotAnalytics.h"
+#include "AutoTimer.h"
+#include "PourSegmenter.h"
+#include "SampleBus.h"
+#include "BrewControl.h"
+#include "TelemetryFrame.h"
+#include "TaskMonitor.h"
+#include "Profiler.h"
+#include "LatencyTracer.h"
+#include "BootScheduler.h"
+#include "RetainedState.h"
+#include "PowerPolicy.h"
+#include "PerformanceProfile.h"
+#include "CoexPolicy.h"
+#include "InputEngine.h"
+#include "UlpWake.h"
 
 // Board-specific pin configuration
 uint8_t dataPin1 = HX711_DATA_PIN1;   // HX711 Data pin for first loadcell
@@ -34,13 +52,387 @@ float combinedCalibrationFactor = (calibrationFactor1 + calibrationFactor2) / 2.
 Scale scale(dataPin1, dataPin2, clockPin, combinedCalibrationFactor);
 FlowRate flowRate;
 BluetoothScale bluetoothScale;
-TouchSensor touchSensor(touchPin, &scale);
+TouchSensor touchSensor(touchPin);
 Display oledDisplay(sdaPin, sclPin, &scale, &flowRate);
 PowerManager powerManager(sleepTouchPin, &oledDisplay);
 BatteryMonitor batteryMonitor(batteryPin);
+WeightHistory weightHistory;
+ShotLog shotLog;
+ShotAnalytics shotAnalytics;
+AutoTimer autoTimer(&oledDisplay, &flowRate);
+PourSegmenter pourSegmenter(&scale);
+SampleBus sampleBus;
+BrewControl brewControl(&scale, &oledDisplay, &flowRate);
+TaskMonitor taskMonitor;
+
+// Task layout: acquisition owns core 1 at the highest priority so radio work and
+// display refreshes never delay a conversion; the UI shares core 1 below it,
+// comms and housekeeping sit on core 0 next to the WiFi/BLE stacks
+const uint32_t ACQUIRE_PERIOD_MS = 20;          // 50Hz - matches the HX711 read gate
+const uint32_t COMMS_PERIOD_MS = 20;
+const uint32_t HOUSEKEEPING_PERIOD_MS = 100;
+const uint32_t UI_IDLE_PERIOD_MS = 100;         // No power lock held - touch pads wake the task by interrupt
+const unsigned long BREW_ACTIVE_HOLD_MS = 5000; // Full clock for the tail of a shot after STABLE
+
+static EventBus::SubscriberId uiSubscription = -1;
+
+// Hand one filtered sample to every shot consumer
+static void processSample(const TelemetrySample& sample) {
+  weightHistory.record(sample);
+  shotLog.record(sample);
+  shotAnalytics.update(sample);
+}
+
+// One filtered sample through flow rate, the sample bus and the shot consumers
+static void acquireSample() {
+  static unsigned long lastWeightUpdate = 0;
+  static uint32_t lastTracedSequence = 0;
+
+  // Update weight at optimal frequency for brewing accuracy
+  if (millis() - lastWeightUpdate < ACQUIRE_PERIOD_MS) {
+    return; // Woken early by a control event
+  }
+  float weight;
+  {
+    PROFILE_SCOPE(PROFILE_SCALE_READ);
+    weight = scale.getWeight();
+  }
+  // Trace only new conversions - getWeight() repeats the last value between them
+  bool newSample = scale.getSampleSequence() != lastTracedSequence;
+  lastTracedSequence = scale.getSampleSequence();
+  if (newSample) {
+    latencyTracer.mark(LATENCY_FILTER, scale.getSampleTimestampUs());
+  }
+  {
+    PROFILE_SCOPE(PROFILE_FLOW_UPDATE);
+    flowRate.update(weight);
+  }
+  if (newSample) {
+    latencyTracer.mark(LATENCY_FLOW, scale.getSampleTimestampUs());
+  }
+  TelemetrySample sample = TelemetryFrame::capture(scale, &flowRate, &oledDisplay, false);
+  // New filtered sample only - display, BLE and /ws read it at their own rate
+  if (sample.sequence != sampleBus.latestSequence()) {
+    sampleBus.publish(sample);
+  }
+
+  // An auto-started timer is back-dated - replay the samples since the first drip
+  if (autoTimer.update(sample)) {
+    for (size_t i = 0; i < autoTimer.replayCount(); i++) {
+      processSample(autoTimer.replaySample(i));
+    }
+  }
+  processSample(sample);
+  // Uses the unfiltered reading so pour detection is not delayed by the filter it switches
+  pourSegmenter.update(sample, scale.getUnfilteredWeight());
+  lastWeightUpdate = millis();
+}
+
+// Scale, flow rate and shot consumers - also executes tare/timer requests between samples
+static void acquisitionTask(void* param) {
+  int id = (int)(intptr_t)param;
+  for (;;) {
+    uint32_t startUs = micros();
+    acquireSample();
+    uint32_t busyUs = micros() - startUs;
+
+    // Performance profile switches are executed on this task - re-apply on the next cycle
+    static uint32_t appliedProfile = 0;
+    if (profileManager.generation() != appliedProfile) {
+      appliedProfile = profileManager.generation();
+      const PerformanceProfile& profile = profileManager.current();
+      scale.setAcquisitionProfile(profile.pinFullRate, profile.stableAverageSamples);
+      powerPolicy.setActive(POWER_LOCK_PROFILE, profile.holdMaxCpu);
+    }
+
+    // BREWING/TRANSITIONING pins the CPU at full clock, STABLE lets it scale down
+    static unsigned long lastBrewingMs = 0;
+    if (scale.isBrewingActive()) {
+      lastBrewingMs = millis();
+    }
+    powerPolicy.setActive(POWER_LOCK_ACQUIRE,
+                          lastBrewingMs != 0 && millis() - lastBrewingMs < BREW_ACTIVE_HOLD_MS);
+
+    // Sleep out the rest of the period - a control event (tare, timer) ends the wait early.
+    // The governor stretches the period while the scale is idle
+    uint32_t periodMs = max(ACQUIRE_PERIOD_MS, scale.getReadIntervalMs());
+    uint32_t busyMs = busyUs / 1000;
+    uint32_t waitMs = busyMs < periodMs ? periodMs - busyMs : 1;
+    busyUs += brewControl.waitForEvents(waitMs);
+    taskMonitor.addBusy(id, busyUs);
+  }
+}
+
+// BLE notifications and WebSocket fan-out
+static void commsTask(void* param) {
+  int id = (int)(intptr_t)param;
+  unsigned long lastBLEUpdate = 0;
+  uint32_t appliedProfile = 0;
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    uint32_t startUs = micros();
+    if (profileManager.generation() != appliedProfile) {
+      appliedProfile = profileManager.generation();
+      bluetoothScale.applyProfile(profileManager.current());
+    }
+    // Update Bluetooth less frequently to reduce BLE interference
+    if (millis() - lastBLEUpdate >= 50) { // Update every 50ms (20Hz) - sufficient for app responsiveness
+      PROFILE_SCOPE(PROFILE_BLE_UPDATE);
+      bluetoothScale.update();
+      lastBLEUpdate = millis();
+    }
+
+    // Stream telemetry frames to WebSocket clients
+    updateWebTelemetry();
+
+    powerPolicy.setActive(POWER_LOCK_BLE, bluetoothScale.isConnected());
+    powerPolicy.setActive(POWER_LOCK_HTTP, isWebServerActive());
+    taskMonitor.addBusy(id, micros() - startUs);
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(COMMS_PERIOD_MS));
+  }
+}
+
+// Display, touch and power button - the only task that draws on the OLED
+static void uiTask(void* param) {
+  int id = (int)(intptr_t)param;
+  TickType_t nextRefresh = xTaskGetTickCount();
+  for (;;) {
+    uint32_t startUs = micros();
+
+    // Tare feedback for requests executed on the acquisition task
+    ControlEvent event;
+    while (controlEvents.receive(uiSubscription, event, 0)) {
+      if (!oledDisplay.isConnected()) continue;
+      if (event.type == ControlEventType::TARE && event.source != EventSource::TOUCH) {
+        oledDisplay.showTaringMessage(); // Touch already showed it on press
+      } else if (event.type == ControlEventType::TARED) {
+        oledDisplay.showTaredMessage();
+      }
+    }
+
+    {
+      PROFILE_SCOPE(PROFILE_TOUCH_UPDATE);
+      inputEngine.process(); // Pad edges to gestures for both touch pads
+      touchSensor.update();
+    }
+    powerManager.update();
+
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(now - nextRefresh) >= 0) {
+      {
+        PROFILE_SCOPE(PROFILE_DISPLAY_UPDATE);
+        oledDisplay.update();
+      }
+      // OLED refresh follows the profile; an idle scale refreshes less often
+      // so the CPU can stay in light sleep
+      uint32_t periodMs = profileManager.current().uiPeriodMs;
+      if (powerPolicy.isIdle() && periodMs < UI_IDLE_PERIOD_MS) {
+        periodMs = UI_IDLE_PERIOD_MS;
+      }
+      nextRefresh = now + pdMS_TO_TICKS(periodMs);
+    }
+    taskMonitor.addBusy(id, micros() - startUs);
+
+    // Sleep until the next refresh, a pad edge or a gesture timer (debounce
+    // settle, hold threshold) - a tap is handled the moment it lands
+    now = xTaskGetTickCount();
+    TickType_t wait = (int32_t)(nextRefresh - now) > 0 ? nextRefresh - now : 0;
+    TickType_t inputWait = inputEngine.ticksUntilDeadline();
+    if (inputWait < wait) {
+      wait = inputWait;
+    }
+    inputEngine.waitForInput(wait);
+  }
+}
+
+// WiFi upkeep, battery, periodic logs and the task statistics window
+static void housekeepingTask(void* param) {
+  int id = (int)(intptr_t)param;
+  unsigned long lastWiFiCheck = 0;
+  unsigned long lastStatusLog = 0;
+  unsigned long lastTaskSample = millis();
+  uint32_t appliedProfile = 0;
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    uint32_t startUs = micros();
+    if (profileManager.generation() != appliedProfile) {
+      appliedProfile = profileManager.generation();
+      setWiFiPowerSave(profileManager.current().wifiPowerSave, profileManager.current().wifiLatencyBoost);
+    }
+
+    // Check WiFi status every 30 seconds for debugging
+    if (millis() - lastWiFiCheck >= 30000) {
+      printWiFiStatus();
+      lastWiFiCheck = millis();
+    }
+
+    // Log scale status periodically (every 60 seconds)
+    if (millis() - lastStatusLog >= 60000) {
+      if (scale.isHX711Connected()) {
+        Serial.printf("Dual HX711 Status: %s, Weight: %.1fg\n",
+                     scale.getHX711Status().c_str(), scale.getCurrentWeight());
+      }
+      lastStatusLog = millis();
+    }
+
+    // Clients streaming or polling, or a shot running - keep the modem awake
+    bool shotActive = scale.isBrewingActive() || oledDisplay.isTimerRunning();
+    setWiFiLatencyDemand(isWebServerActive(), shotActive);
+
+    // Radio arbitration: BLE while a connected controller follows the shot,
+    // WiFi during bulk transfers, balanced otherwise
+    coexPolicy.update(bluetoothScale.isConnected() && shotActive, isWebHeavy());
+
+    // Maintain WiFi AP stability
+    {
+      PROFILE_SCOPE(PROFILE_WIFI_MAINTAIN);
+      maintainWiFi();
+    }
+
+    // Update battery monitor
+    {
+      PROFILE_SCOPE(PROFILE_BATTERY_UPDATE);
+      batteryMonitor.update();
+    }
+
+    // Close the CPU share window once per second
+    if (millis() - lastTaskSample >= 1000) {
+      // Below 2.5V there is no battery (USB only) - never a reason to save power
+      float voltage = batteryMonitor.getBatteryVoltage();
+      profileManager.updateBattery(voltage > 2.5f && batteryMonitor.isLowBattery());
+      taskMonitor.sample();
+      PROFILER_SAMPLE();
+      lastTaskSample = millis();
+    }
+    taskMonitor.addBusy(id, micros() - startUs);
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(HOUSEKEEPING_PERIOD_MS));
+  }
+}
+
+// Boot steps - run concurrently by the boot scheduler, ordered only by their dependencies
+
+static bool scaleReady = false;
+
+static bool bootBluetooth() {
+  // CRITICAL: BLE comes up before WiFi to prevent radio conflicts - the WiFi step depends on it
+  Serial.println("Initializing BLE FIRST for GaggiMate compatibility...");
+  Serial.printf("Free heap before BLE init: %u bytes\n", ESP.getFreeHeap());
+  Serial.printf("Free PSRAM before BLE init: %u bytes\n", ESP.getFreePsram());
+  
+  try {
+    bluetoothScale.begin();  // Initialize BLE without scale reference
+    Serial.println("BLE initialized successfully - GaggiMate should be able to connect");
+    Serial.printf("Free heap after BLE init: %u bytes\n", ESP.getFreeHeap());
+    Serial.printf("Free PSRAM after BLE init: %u bytes\n", ESP.getFreePsram());
+    return true;
+  } catch (...) {
+    Serial.println("BLE initialization failed - continuing without Bluetooth");
+    Serial.printf("Free heap after BLE fail: %u bytes\n", ESP.getFreeHeap());
+    return false;
+  }
+}
+
+static bool bootDisplay() {
+  // Initialize display with error handling - don't block if display fails
+  Serial.println("Initializing display...");
+  if (!oledDisplay.begin()) {
+    Serial.println("WARNING: Display initialization failed!");
+    Serial.println("System will continue in headless mode without display.");
+    Serial.println("All functionality remains available via web interface.");
+    return false;
+  }
+  Serial.println("Display initialized - ready for visual feedback");
+  
+  // Status indicators and timer state (pointers only - the objects may still be starting)
+  oledDisplay.setBluetoothScale(&bluetoothScale);
+  oledDisplay.setPowerManager(&powerManager);
+  oledDisplay.setBatteryMonitor(&batteryMonitor);
+  
+  // Link display to touch sensor for tare feedback
+  touchSensor.setDisplay(&oledDisplay);
+  
+  // Welcome message - cleared by the UI task, the weight follows without a fixed wait.
+  // Skipped on a fast resume: waking to the weight is the point
+  if (!RetainedState::isValid()) {
+    oledDisplay.showIPAddresses();
+  }
+  return true;
+}
+
+static bool bootScale() {
+  // After a ULP-armed sleep the HX711 pins are still on the RTC mux
+  UlpWake::releasePins();
+
+  // Deep-sleep wake with valid retained state: keep the user's tare and skip the probe
+  if (RetainedState::isValid() && scale.resume(RetainedState::scale())) {
+    bootScheduler.mark("resumed");
+    scaleReady = true;
+    return true;
+  }
+
+  // Initialize DUAL HX711 scale with error handling
+  Serial.println("Initializing DUAL HX711 scale...");
+  if (!scale.begin()) {
+    Serial.println("WARNING: Dual HX711 scale initialization failed!");
+    Serial.println("Web server will continue to run, but scale readings will not be available.");
+    Serial.println("Check HX711 wiring and connections for both load cells.");
+    Serial.printf("  Data Pin 1: GPIO %d\n", dataPin1);
+    Serial.printf("  Data Pin 2: GPIO %d\n", dataPin2);
+    Serial.printf("  Clock Pin:  GPIO %d\n", clockPin);
+    return false;
+  }
+  
+  Serial.println("Dual HX711 scale initialized successfully");
+  Serial.println("  Configuration: " + String(scale.isDualHX711() ? "DUAL" : "SINGLE"));
+  Serial.println("  Status: " + scale.getHX711Status());
+  
+  // Nach der Scale-Initialisierung die individuellen Faktoren setzen:
+  if (scale.isDualHX711()) {
+    scale.setCalibrationFactors(calibrationFactor1, calibrationFactor2);
+    Serial.println("  Individual calibration factors set for dual HX711");
+  }
+  scaleReady = true;
+  return true;
+}
+
+static bool bootStorage() {
+  // Full-rate shot history for the dashboard chart (PSRAM when available)
+  if (weightHistory.begin()) {
+    oledDisplay.setWeightHistory(&weightHistory);
+    setWeightHistory(&weightHistory);
+  }
+
+  // Persist timer-bounded shots to LittleFS (written by a background task)
+  bool mounted = shotLog.begin();
+  if (mounted) {
+    oledDisplay.setShotLog(&shotLog);
+    setShotLog(&shotLog);
+    shotAnalytics.setShotLog(&shotLog);
+  }
+  return mounted;
+}
+
+static bool bootWiFi() {
+  // ALWAYS enable WiFi power management for optimal battery life
+  // This works regardless of WiFi mode (STA/AP/OFF) and should be set early
+  WiFi.setSleep(true);
+  Serial.println("WiFi power management enabled for battery optimization");
+  
+  // Starts the connection and returns - the housekeeping task finishes it
+  setupWiFi();
+  Serial.printf("Version: %s\n", ESP.getSdkVersion());
+  return true;
+}
+
+static bool bootWebServer() {
+  setTaskMonitor(&taskMonitor);
+  setupWebServer(scale, flowRate, bluetoothScale, oledDisplay, batteryMonitor);
+  return true;
+}
 
 void setup() {
   Serial.begin(115200);
+  bootScheduler.mark("setup");
   
   // Board identification 
   Serial.println("=================================");
@@ -59,51 +451,20 @@ void setup() {
   Serial.printf("  Combined Factor: %.6f\n", combinedCalibrationFactor);
   Serial.println("=================================");
   
-  // Link scale and flow rate for tare operation coordination
-  scale.setFlowRatePtr(&flowRate);
-  
   // Check for factory reset request (hold touch pin during boot)
   pinMode(touchPin, INPUT_PULLDOWN);
   if (digitalRead(touchPin) == HIGH) {
     Serial.println("FACTORY RESET: Touch pin held during boot - clearing WiFi credentials");
+    RetainedState::invalidate(); // Don't resume the old association from RTC memory
     clearWiFiCredentials();
     delay(1000);
   }
   
-  // CRITICAL: Initialize BLE FIRST before WiFi to prevent radio conflicts
-  Serial.println("Initializing BLE FIRST for GaggiMate compatibility...");
-  Serial.printf("Free heap before BLE init: %u bytes\n", ESP.getFreeHeap());
-  Serial.printf("Free PSRAM before BLE init: %u bytes\n", ESP.getFreePsram());
-  
-  try {
-    bluetoothScale.begin();  // Initialize BLE without scale reference
-    Serial.println("BLE initialized successfully - GaggiMate should be able to connect");
-    Serial.printf("Free heap after BLE init: %u bytes\n", ESP.getFreeHeap());
-    Serial.printf("Free PSRAM after BLE init: %u bytes\n", ESP.getFreePsram());
-  } catch (...) {
-    Serial.println("BLE initialization failed - continuing without Bluetooth");
-    Serial.printf("Free heap after BLE fail: %u bytes\n", ESP.getFreeHeap());
-  }
-  
-  // Initialize display with error handling - don't block if display fails
-  Serial.println("Initializing display...");
-  bool displayAvailable = oledDisplay.begin();
-  
-  if (!displayAvailable) {
-    Serial.println("WARNING: Display initialization failed!");
-    Serial.println("System will continue in headless mode without display.");
-    Serial.println("All functionality remains available via web interface.");
-  } else {
-    Serial.println("Display initialized - ready for visual feedback");
-  }
-  
-  // Check wake-up reason and show appropriate message
+  // Log the wake-up reason (the splash no longer waits for it)
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
   switch(wakeup_reason) {
     case ESP_SLEEP_WAKEUP_EXT0:
       Serial.println("Wakeup caused by external signal (touch sensor)");
-      // Show the same starting message as normal boot for consistency
-      delay(1500);
       break;
     case ESP_SLEEP_WAKEUP_EXT1:
       Serial.println("Wakeup caused by external signal using RTC_CNTL");
@@ -114,147 +475,99 @@ void setup() {
     case ESP_SLEEP_WAKEUP_TOUCHPAD:
       Serial.println("Wakeup caused by touchpad");
       break;
+    case ESP_SLEEP_WAKEUP_ULP:
+      Serial.println("Wakeup caused by weight change (ULP)");
+      break;
     default:
       Serial.println("Wakeup was not caused by deep sleep: " + String(wakeup_reason));
-      // For normal startup, the begin() method already shows a startup message
-      delay(1000);
       break;
   }
-  //Wait for BLE to finish intitalizing before starting WiFi
-  delay(1500); 
   
-  // ALWAYS enable WiFi power management for optimal battery life
-  // This works regardless of WiFi mode (STA/AP/OFF) and should be set early
-  WiFi.setSleep(true);
-  Serial.println("WiFi power management enabled for battery optimization");
-  
-  setupWiFi();
-
-  // Wait for WiFi to fully stabilize after BLE is already running
-  delay(1500);
-  Serial.printf("Version: %s\n", ESP.getSdkVersion());
-  
-  // Initialize DUAL HX711 scale with error handling
-  Serial.println("Initializing DUAL HX711 scale...");
-  if (!scale.begin()) {
-    Serial.println("WARNING: Dual HX711 scale initialization failed!");
-    Serial.println("Web server will continue to run, but scale readings will not be available.");
-    Serial.println("Check HX711 wiring and connections for both load cells.");
-    Serial.printf("  Data Pin 1: GPIO %d\n", dataPin1);
-    Serial.printf("  Data Pin 2: GPIO %d\n", dataPin2);
-    Serial.printf("  Clock Pin:  GPIO %d\n", clockPin);
-  } else {
-    Serial.println("Dual HX711 scale initialized successfully");
-    Serial.println("  Configuration: " + String(scale.isDualHX711() ? "DUAL" : "SINGLE"));
-    Serial.println("  Status: " + scale.getHX711Status());
-    
-    // Nach der Scale-Initialisierung die individuellen Faktoren setzen:
-    if (scale.isDualHX711()) {
-        scale.setCalibrationFactors(calibrationFactor1, calibrationFactor2);
-        Serial.println("  Individual calibration factors set for dual HX711");
-    }
-    
-    // Now that scale is ready, set the reference in BluetoothScale
-    bluetoothScale.setScale(&scale);
-  }
-  
-  // BLE was initialized earlier - no need to initialize again
-  // bluetoothScale.begin(&scale);
-  
-  // Set bluetooth reference in display for status indicator (if display available)
-  if (oledDisplay.isConnected()) {
-    oledDisplay.setBluetoothScale(&bluetoothScale);
-  }
+  // Hardware-free wiring and settings, before any boot step runs. Control bus
+  // subscriptions happen here too - subscribe() must not run concurrently
   
   // Set display reference in bluetooth for timer control
   bluetoothScale.setDisplay(&oledDisplay);
   
-  // Set power manager reference in display for timer state synchronization (if display available)
-  if (oledDisplay.isConnected()) {
-    oledDisplay.setPowerManager(&powerManager);
-  }
-  
-  // Set battery monitor reference in display for battery status (if display available)
-  if (oledDisplay.isConnected()) {
-    oledDisplay.setBatteryMonitor(&batteryMonitor);
-  }
+  // Set flow rate reference in bluetooth for telemetry frames
+  bluetoothScale.setFlowRate(&flowRate);
+
+  // HX711 pins for the ULP weight-change wake (-DWMB_ULP_WAKE builds)
+  UlpWake::setPins(dataPin1, dataPin2, clockPin);
 
   // Initialize touch sensor
   touchSensor.begin();
 
+  // CPU frequency scaling and automatic light sleep - subsystems take locks when active
+  powerPolicy.begin();
+
   // Initialize power manager
   powerManager.begin();
+  powerManager.setScale(&scale);
 
   // Initialize battery monitor
   batteryMonitor.begin();
 
-  // Show IP addresses and welcome message if display is available
-  delay(100); // Small delay to ensure WiFi is fully initialized
-  if (oledDisplay.isConnected()) {
-    oledDisplay.showIPAddresses();
-  }
+  // Real-time shot analytics (first drop, peak/mean flow, yield) for BLE, web and shot log
+  oledDisplay.setShotAnalytics(&shotAnalytics);
+  bluetoothScale.setShotAnalytics(&shotAnalytics);
+  setShotAnalytics(&shotAnalytics);
 
-  // Link display to touch sensor for tare feedback (if display available)
-  if (oledDisplay.isConnected()) {
-    touchSensor.setDisplay(&oledDisplay);
-  }
-  
-  // Link flow rate to touch sensor for averaging reset on tare
-  touchSensor.setFlowRate(&flowRate);
+  // Flow-triggered timer start/stop (enabled from the settings page)
+  autoTimer.begin();
+  setAutoTimer(&autoTimer);
 
-  setupWebServer(scale, flowRate, bluetoothScale, oledDisplay, batteryMonitor);
+  // Pour-over mode: pours/pauses with per-pour figures, events go out with the shot events
+  pourSegmenter.begin();
+  pourSegmenter.setShotAnalytics(&shotAnalytics);
+  setPourSegmenter(&pourSegmenter);
+
+  // Tare and timer requests from touch, BLE and web are executed on the acquisition task
+  brewControl.begin();
+  brewControl.setPourSegmenter(&pourSegmenter);
+  uiSubscription = controlEvents.subscribe(
+      EVENT_MASK(ControlEventType::TARE) | EVENT_MASK(ControlEventType::TARED), "ui");
+
+  // Broadcast ring of filtered samples - each reader has its own cursor and rate
+  oledDisplay.setSampleBus(&sampleBus);
+  bluetoothScale.setSampleBus(&sampleBus);
+  setSampleBus(&sampleBus);
+
+  // Saved performance profile - every task applies it on its first cycle
+  profileManager.begin();
+
+  PROFILER_BEGIN(); // No-op unless built with -DWMB_PROFILING
+
+  // Bring the hardware up concurrently - BLE before WiFi, the web server once
+  // WiFi and the filesystem are up; display, HX711 and storage start at once
+  uint32_t bleStep = bootScheduler.add("ble", bootBluetooth, 0, 8192);
+  uint32_t displayStep = bootScheduler.add("display", bootDisplay, 0, 4096);
+  uint32_t scaleStep = bootScheduler.add("scale", bootScale, 0, 4096);
+  uint32_t storageStep = bootScheduler.add("storage", bootStorage, 0, 6144);
+  uint32_t wifiStep = bootScheduler.add("wifi", bootWiFi, bleStep, 6144);
+  uint32_t webStep = bootScheduler.add("web", bootWebServer, wifiStep | storageStep, 8192);
+  bootScheduler.start();
+
+  // Weight on the OLED as soon as the scale, display and shot storage are ready -
+  // the radios keep starting in the background
+  bootScheduler.waitFor(scaleStep | displayStep | storageStep);
+  taskMonitor.start(acquisitionTask, "acquire", 8192, 5, 1);
+  taskMonitor.start(uiTask, "ui", 6144, 2, 1);
+  bootScheduler.mark("acquire");
+
+  bootScheduler.waitFor(bleStep | webStep);
+  if (scaleReady) {
+    // Now that scale is ready, set the reference in BluetoothScale
+    bluetoothScale.setScale(&scale);
+  }
+  taskMonitor.start(commsTask, "comms", 6144, 3, 0);
+  taskMonitor.start(housekeepingTask, "housekeeping", 6144, 1, 0);
+  bootScheduler.mark("comms");
+  bootScheduler.printTimeline();
 }
 
 void loop() {
-  static unsigned long lastWeightUpdate = 0;
-  static unsigned long lastWiFiCheck = 0;
-  static unsigned long lastStatusLog = 0;
-  
-  // Update weight at optimal frequency for brewing accuracy
-  if (millis() - lastWeightUpdate >= 20) { // Update every 20ms (50Hz) - still very responsive
-    float weight = scale.getWeight();
-    flowRate.update(weight);
-    lastWeightUpdate = millis();
-  }
-  
-  static unsigned long lastBLEUpdate = 0;
-  
-  // Check WiFi status every 30 seconds for debugging
-  if (millis() - lastWiFiCheck >= 30000) {
-    printWiFiStatus();
-    lastWiFiCheck = millis();
-  }
-  
-  // Log scale status periodically (every 60 seconds)
-  if (millis() - lastStatusLog >= 60000) {
-    if (scale.isHX711Connected()) {
-      Serial.printf("Dual HX711 Status: %s, Weight: %.1fg\n", 
-                   scale.getHX711Status().c_str(), scale.getCurrentWeight());
-    }
-    lastStatusLog = millis();
-  }
-  
-  // Maintain WiFi AP stability
-  maintainWiFi();
-  
-  // Update Bluetooth less frequently to reduce BLE interference
-  if (millis() - lastBLEUpdate >= 50) { // Update every 50ms (20Hz) - sufficient for app responsiveness
-    bluetoothScale.update();
-    lastBLEUpdate = millis();
-  }
-  
-  // Update touch sensor
-  touchSensor.update();
-  
-  // Update power manager
-  powerManager.update();
-  
-  // Update battery monitor
-  batteryMonitor.update();
-  
-  // Update display
-  oledDisplay.update();
-  
-  // Balanced delay for responsive readings without system overload
-  delay(25); // Increased from 5ms to 25ms to reduce BLE interference and system load
+  // All work runs in the tasks started by setup() - free the Arduino loop task
+  vTaskDelete(NULL);
 }
+
@@ -0,0 +1,191 @@
+/*
+ * Host tests for the ULP weight-change wake (include/UlpWakeLogic.h), run
+ * with "pio test -e native". The HX711s are simulated behind UlpHx711Io:
+ * time advances only through delayUs, clock high for more than 60us powers
+ * the chip down, and DOUT goes low once the settle time after power-up
+ * has passed.
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "UlpWakeLogic.h"
+
+typedef struct {
+    uint32_t nowUs;
+    int clock;
+    uint32_t clockHighSinceUs;
+    int poweredDown;
+    uint32_t powerUpUs;
+    uint32_t settleUs;  // Power-up to first conversion
+    int bit;            // Rising clock edges since the conversion was ready
+    int32_t value[2];   // Next reading per data line
+    uint32_t powerDowns;
+} SimHx711;
+
+static SimHx711 sim;
+
+static int simReady(void) {
+    return !sim.poweredDown && sim.nowUs - sim.powerUpUs >= sim.settleUs;
+}
+
+static void simSetClock(void* ctx, int level) {
+    (void)ctx;
+    if (level && !sim.clock) {
+        sim.clockHighSinceUs = sim.nowUs;
+        if (simReady()) {
+            sim.bit++;
+        }
+    } else if (!level && sim.clock && sim.poweredDown) {
+        // Clock low wakes the chip - a new conversion starts
+        sim.poweredDown = 0;
+        sim.powerUpUs = sim.nowUs;
+        sim.bit = 0;
+    }
+    sim.clock = level;
+}
+
+static int simReadData(void* ctx, int channel) {
+    (void)ctx;
+    if (!simReady() || sim.bit > 24) {
+        return 1;
+    }
+    if (sim.bit == 0) {
+        return 0; // Conversion ready
+    }
+    uint32_t raw = (uint32_t)sim.value[channel] & 0xFFFFFF;
+    return (raw >> (24 - sim.bit)) & 1;
+}
+
+static void simDelayUs(void* ctx, uint32_t us) {
+    (void)ctx;
+    sim.nowUs += us;
+    if (sim.clock && !sim.poweredDown && sim.nowUs - sim.clockHighSinceUs > 60) {
+        sim.poweredDown = 1;
+        sim.powerDowns++;
+    }
+}
+
+static const UlpHx711Io io = { simSetClock, simReadData, simDelayUs, 0 };
+static UlpWakeConfig config;
+static UlpWakeState state;
+
+void setUp(void) {
+    memset(&sim, 0, sizeof(sim));
+    sim.clock = 1;       // Asleep, as the main CPU leaves it
+    sim.poweredDown = 1;
+    sim.settleUs = 400000;
+    config.thresholdCounts = 20000;
+    config.confirmReads = 2;
+    config.driftShift = 4;
+    config.readyTimeoutMs = 600;
+    config.dual = 0;
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown(void) {
+}
+
+static void test_sample_reads_and_powers_down(void) {
+    int32_t reading = 0;
+    sim.value[0] = 123456;
+    TEST_ASSERT_EQUAL_INT(0, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(123456, reading);
+    TEST_ASSERT_TRUE(sim.poweredDown);
+    TEST_ASSERT_EQUAL_UINT32(1, sim.powerDowns);
+    TEST_ASSERT_EQUAL_INT(26, sim.bit); // 24 data bits, channel A gain 128, then the power-down edge
+}
+
+static void test_sample_sign_extension(void) {
+    int32_t reading = 0;
+    sim.value[0] = -1234;
+    TEST_ASSERT_EQUAL_INT(0, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(-1234, reading);
+
+    sim.value[0] = -8388608; // 0x800000
+    TEST_ASSERT_EQUAL_INT(0, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(-8388608, reading);
+
+    sim.value[0] = 8388607; // 0x7FFFFF
+    TEST_ASSERT_EQUAL_INT(0, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(8388607, reading);
+}
+
+static void test_sample_dual_sums_both_cells(void) {
+    int32_t reading = 0;
+    config.dual = 1;
+    sim.value[0] = -1234;
+    sim.value[1] = 500000;
+    TEST_ASSERT_EQUAL_INT(0, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(-1234 + 500000, reading);
+}
+
+static void test_sample_timeout(void) {
+    int32_t reading = 42;
+    sim.settleUs = 800000; // Longer than readyTimeoutMs
+    TEST_ASSERT_EQUAL_INT(-1, ulp_hx711_sample(&io, &config, &reading));
+    TEST_ASSERT_EQUAL_INT32(42, reading); // Untouched
+    TEST_ASSERT_TRUE(sim.poweredDown);    // Not left drawing current
+    TEST_ASSERT_UINT32_WITHIN(2000, 601000, sim.nowUs);
+}
+
+static void test_first_check_captures_baseline(void) {
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 150000));
+    TEST_ASSERT_TRUE(state.haveBaseline);
+    TEST_ASSERT_EQUAL_INT32(150000, state.baseline);
+    TEST_ASSERT_EQUAL_UINT32(1, state.checks);
+    TEST_ASSERT_EQUAL_INT32(150000, state.lastReading);
+}
+
+static void test_wake_needs_two_reads(void) {
+    ulp_wake_check(&state, &config, 0);
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 40000));
+    TEST_ASSERT_EQUAL_UINT32(1, state.confirmCount);
+    TEST_ASSERT_EQUAL_INT(1, ulp_wake_check(&state, &config, 40000));
+    TEST_ASSERT_EQUAL_UINT32(0, state.confirmCount);
+}
+
+static void test_knock_does_not_wake(void) {
+    ulp_wake_check(&state, &config, 0);
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 40000));
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 100)); // Back - confirm starts over
+    TEST_ASSERT_EQUAL_UINT32(0, state.confirmCount);
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 40000));
+}
+
+static void test_removal_wakes(void) {
+    ulp_wake_check(&state, &config, 300000);
+    ulp_wake_check(&state, &config, 250000);
+    TEST_ASSERT_EQUAL_INT(1, ulp_wake_check(&state, &config, 250000));
+}
+
+static void test_drift_is_folded_into_baseline(void) {
+    ulp_wake_check(&state, &config, 0);
+    TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, 1600));
+    TEST_ASSERT_EQUAL_INT32(100, state.baseline); // 1/16 of the difference
+
+    // A slow ramp far past the threshold in total never wakes
+    int32_t reading = 0;
+    for (int i = 0; i < 200; i++) {
+        reading += 1000;
+        TEST_ASSERT_EQUAL_INT(0, ulp_wake_check(&state, &config, reading));
+    }
+    TEST_ASSERT_INT32_WITHIN(config.thresholdCounts, reading, state.baseline);
+
+    // A real change on top of the drifted baseline still does
+    ulp_wake_check(&state, &config, reading + 40000);
+    TEST_ASSERT_EQUAL_INT(1, ulp_wake_check(&state, &config, reading + 40000));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sample_reads_and_powers_down);
+    RUN_TEST(test_sample_sign_extension);
+    RUN_TEST(test_sample_dual_sums_both_cells);
+    RUN_TEST(test_sample_timeout);
+    RUN_TEST(test_first_check_captures_baseline);
+    RUN_TEST(test_wake_needs_two_reads);
+    RUN_TEST(test_knock_does_not_wake);
+    RUN_TEST(test_removal_wakes);
+    RUN_TEST(test_drift_is_folded_into_baseline);
+    return UNITY_END();
+}
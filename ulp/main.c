@@ -0,0 +1,67 @@
+/*
+ * ULP RISC-V weight-change wake program (built only with -DWMB_ULP_WAKE, see
+ * include/UlpWake.h). The ULP timer runs main() once per wake period while
+ * the main cores are in deep sleep: power the HX711s up, clock out one
+ * reading, power them down again and wake the main CPU only when the
+ * weight moved past the threshold. Variables below are exported to the main
+ * firmware as ulp_<name> through the generated ulp_main.h.
+ */
+
+#include <stdint.h>
+#include "ulp_riscv_utils.h"
+#include "ulp_riscv_gpio.h"
+#include "../include/UlpWakeLogic.h"
+
+// Set by the main CPU before sleep
+uint32_t hx711_data_pin1;
+uint32_t hx711_data_pin2;
+uint32_t hx711_clock_pin;
+UlpWakeConfig wake_config;
+
+// Kept across runs - reset by the main CPU on every arm
+UlpWakeState wake_state;
+uint32_t pins_ready;
+int32_t wake_reading; // Reading that triggered the wake
+
+static void set_clock(void* ctx, int level) {
+    ulp_riscv_gpio_output_level((gpio_num_t)hx711_clock_pin, level);
+}
+
+static int read_data(void* ctx, int channel) {
+    return ulp_riscv_gpio_get_level((gpio_num_t)(channel == 0 ? hx711_data_pin1 : hx711_data_pin2));
+}
+
+static void delay_us(void* ctx, uint32_t us) {
+    ulp_riscv_delay_cycles(us * ULP_RISCV_CYCLES_PER_US);
+}
+
+static void init_pins(void) {
+    ulp_riscv_gpio_init((gpio_num_t)hx711_clock_pin);
+    ulp_riscv_gpio_output_enable((gpio_num_t)hx711_clock_pin);
+    ulp_riscv_gpio_init((gpio_num_t)hx711_data_pin1);
+    ulp_riscv_gpio_input_enable((gpio_num_t)hx711_data_pin1);
+    if (wake_config.dual) {
+        ulp_riscv_gpio_init((gpio_num_t)hx711_data_pin2);
+        ulp_riscv_gpio_input_enable((gpio_num_t)hx711_data_pin2);
+    }
+}
+
+int main(void) {
+    if (!pins_ready) {
+        init_pins();
+        pins_ready = 1;
+    }
+
+    UlpHx711Io io = { set_clock, read_data, delay_us, 0 };
+    int32_t reading;
+    if (ulp_hx711_sample(&io, &wake_config, &reading) != 0) {
+        wake_state.timeouts++; // No HX711 answer - try again next period
+        return 0;
+    }
+
+    if (ulp_wake_check(&wake_state, &wake_config, reading)) {
+        wake_reading = reading;
+        ulp_riscv_wakeup_main_processor();
+    }
+    return 0; // Halts until the ULP timer fires again
+}